@@ -0,0 +1,398 @@
+#include <QFile>
+#include <QList>
+#include <QMap>
+#include <QMenu>
+#include <QPair>
+#include <QTest>
+#include <QTextStream>
+#include <algorithm>
+#include "fakes.h"
+#include "translationbinder.h"
+#include "translator.h"
+#include "traywindowmenu.h"
+#include "windowdiff.h"
+#include "windowsnapshot.h"
+
+#ifdef _WIN32
+#include <QTemporaryDir>
+#include "hiddenwindowjournal.h"
+#endif
+
+namespace {
+
+// count 个合成窗口，进程数远少于窗口数，和真实桌面相近
+QList<QPair<HWND, WindowInfo>> syntheticWindows(int count)
+{
+    QList<QPair<HWND, WindowInfo>> windows;
+    windows.reserve(count);
+    for (int i = 1; i <= count; ++i) {
+        WindowInfo info;
+        info.hwnd = fakeWindow(quintptr(i));
+        info.title = QString("Document %1 - Editor").arg(i);
+        info.processName = QString("process%1.exe").arg(i % 40);
+        info.className = "SyntheticWindow";
+        info.processId = DWORD(i % 40 + 1);
+        info.isVisible = true;
+        windows.append(qMakePair(info.hwnd, info));
+    }
+    return windows;
+}
+
+// 旧的刷新方式：每次刷新都构造新的 QList<QPair<HWND, WindowInfo>>，
+// 三个字符串都是从 Win32 缓冲区新建的副本。返回这次刷新分配的字节数
+// （列表存储加字符串数据，不含分配器自身的头部开销）
+qint64 legacyRefresh(const QList<QPair<HWND, WindowInfo>>& source, QList<QPair<HWND, WindowInfo>>& last)
+{
+    QList<QPair<HWND, WindowInfo>> current;
+    current.reserve(source.size());
+    qint64 bytes = qint64(source.size()) * sizeof(QPair<HWND, WindowInfo>);
+    for (const auto& window : source) {
+        WindowInfo info = window.second;
+        info.title = QString(window.second.title.constData(), window.second.title.size());
+        info.processName = QString(window.second.processName.constData(), window.second.processName.size());
+        info.className = QString(window.second.className.constData(), window.second.className.size());
+        bytes += qint64(info.title.capacity() + info.processName.capacity() + info.className.capacity()) * sizeof(QChar);
+        current.append(qMakePair(window.first, info));
+    }
+    last = current;
+    return bytes;
+}
+
+// setupUI 中常见的界面字符串，都在 MainWindow 上下文中
+const char* const UiSources[] = {
+    "Main", "Settings", "About", "Version", "Window Title", "Process", "Status", "Hidden"
+};
+
+// 改用扁平表之前的翻译方式：QMap<"上下文|原文", 译文>，每次查找都从 const char* 构造并拼接键
+QMap<QString, QString> loadLegacyTranslations(const QString& langFile)
+{
+    QMap<QString, QString> translations;
+    QFile file(langFile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return translations;
+    }
+    QTextStream in(&file);
+    QString section;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith(';')) {
+            continue;
+        }
+        if (line.startsWith('[') && line.endsWith(']')) {
+            section = line.mid(1, line.length() - 2);
+        }
+        else if (line.contains('=')) {
+            const int eq = line.indexOf('=');
+            translations[section + '|' + line.left(eq).trimmed()] = line.mid(eq + 1).trimmed();
+        }
+    }
+    return translations;
+}
+
+QString legacyTranslate(const QMap<QString, QString>& translations, const char* context, const char* source)
+{
+    const QString sourceText(source);
+    auto it = translations.find(QString(context) + '|' + sourceText);
+    return it != translations.end() ? *it : sourceText;
+}
+
+// 托盘菜单中的合成窗口，40 个进程
+TrayWindowMenu::Item trayItem(quintptr id, const QString& title = QString())
+{
+    TrayWindowMenu::Item item;
+    item.hwnd = fakeWindow(id * 16);
+    item.title = title.isEmpty() ? QString("Document %1 - Editor").arg(id) : title;
+    item.processId = DWORD(id % 40 + 1);
+    return item;
+}
+
+} // namespace
+
+class BenchTraynex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // 指纹差异：不变、一个标题变化、整体倒序三种情况，1k 和 10k 个窗口
+    void windowDiff_data()
+    {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<QString>("change");
+        for (int count : { 1000, 10000 }) {
+            for (const char* change : { "none", "title", "reverse" }) {
+                QTest::addRow("%d/%s", count, change) << count << QString(change);
+            }
+        }
+    }
+
+    void windowDiff()
+    {
+        QFETCH(int, count);
+        QFETCH(QString, change);
+
+        const QList<QPair<HWND, WindowInfo>> base = syntheticWindows(count);
+        QList<QPair<HWND, WindowInfo>> next = base;
+        if (change == "title") {
+            next[count / 2].second.title += " *";
+        }
+        else if (change == "reverse") {
+            std::reverse(next.begin(), next.end());
+        }
+
+        // 每轮先回到基准再求一次差异，计时包含两次 update
+        WindowDiff diff;
+        WindowDelta delta;
+        QBENCHMARK {
+            diff.update(base);
+            delta = diff.update(next);
+        }
+        QCOMPARE(delta.changed.size(), change == "title" ? 1 : 0);
+        QCOMPARE(delta.reordered, change == "reverse");
+    }
+
+    // 每次刷新分配的字节数：旧的 QList 复制方式对比复用缓冲区的列式快照。
+    // 快照一侧取生产者的真实统计：列重新分配新增的字节加新建缓冲区，
+    // 不含每次发布的 shared_ptr 控制块
+    void bytesPerRefresh_data()
+    {
+        QTest::addColumn<int>("windows");
+        QTest::addColumn<bool>("snapshot");
+        for (int windows : { 200, 1000 }) {
+            QTest::addRow("%d/list", windows) << windows << false;
+            QTest::addRow("%d/snapshot", windows) << windows << true;
+        }
+    }
+
+    void bytesPerRefresh()
+    {
+        constexpr int Refreshes = 100;
+        QFETCH(int, windows);
+        QFETCH(bool, snapshot);
+
+        if (!snapshot) {
+            const QList<QPair<HWND, WindowInfo>> source = syntheticWindows(windows);
+            QList<QPair<HWND, WindowInfo>> last;
+            qint64 bytes = 0;
+            for (int i = 0; i < Refreshes; ++i) {
+                bytes += legacyRefresh(source, last);
+            }
+            QTest::setBenchmarkResult(qreal(bytes) / Refreshes, QTest::BytesAllocated);
+            return;
+        }
+
+        WindowSnapshotProducer producer(std::make_unique<ChurningBackend>(windows, 40), nullptr);
+        int published = 0;
+        connect(&producer, &WindowSnapshotProducer::snapshotPublished, this, [&published](quint64) {
+            ++published;
+            });
+        producer.start();
+        QTRY_COMPARE(published, 1);
+
+        // 第一次构建的分配不计入，只看稳定状态
+        const QString before = producer.statsString();
+        for (int i = 0; i < Refreshes; ++i) {
+            producer.requestReconcile();
+        }
+        QTRY_VERIFY_WITH_TIMEOUT(published >= Refreshes + 1, 10000);
+        const QString after = producer.statsString();
+
+        const qint64 built = statValue(after, "built") - statValue(before, "built");
+        const qint64 bytes = statValue(after, "grownBytes") - statValue(before, "grownBytes")
+            + (statValue(after, "buffers") - statValue(before, "buffers")) * qint64(sizeof(WindowSnapshot));
+        QVERIFY(built > 0);
+        QTest::setBenchmarkResult(qreal(bytes) / built, QTest::BytesAllocated);
+    }
+
+    // 启动时重放 10k 条日志记录：读文件、逐条校验解码并应用到隐藏状态
+    void journalReplay()
+    {
+#ifdef _WIN32
+        constexpr int Records = 10000;
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const std::wstring snapshotPath = dir.filePath("hidden.snapshot").toStdWString();
+        const std::wstring journalPath = dir.filePath("hidden.journal").toStdWString();
+
+        // 2500 个窗口反复隐藏和恢复，大约三分之一是恢复记录
+        std::vector<HiddenWindowRecord> records;
+        records.reserve(Records);
+        for (int i = 0; i < Records; ++i) {
+            HiddenWindowRecord record;
+            record.kind = i % 3 == 2 ? HiddenWindowRecord::Restore : HiddenWindowRecord::Hide;
+            record.store = i % 2 ? HiddenWindowRecord::AppTray : HiddenWindowRecord::SystemTray;
+            record.hwnd = uint64_t(i % 2500 + 1) * 16;
+            record.processId = uint32_t(i % 40 + 1000);
+            record.processStartTime = 133000000000000000ull + uint64_t(i % 40);
+            record.exePath = QString("C:\\Program Files\\Vendor\\app%1.exe").arg(i % 40).toStdWString();
+            record.title = QString("Document %1 - Editor").arg(i % 2500).toStdWString();
+            records.push_back(std::move(record));
+        }
+        {
+            HiddenWindowJournal writer(snapshotPath, journalPath);
+            writer.setCompactThreshold(Records * 2);
+            QVERIFY(writer.append(records));
+        }
+
+        std::vector<HiddenWindowRecord> hidden;
+        QBENCHMARK {
+            HiddenWindowJournal journal(snapshotPath, journalPath);
+            hidden = journal.replay();
+            QCOMPARE(journal.stats().replayed, uint64_t(Records));
+        }
+        QVERIFY(!hidden.empty());
+#else
+        QSKIP("The journal is implemented on Win32 file APIs");
+#endif
+    }
+
+    // 一轮查找 setupUI 中常见的 8 个字符串：旧的 QMap 查找、运行时哈希的字符串接口、编译期哈希的键
+    void translate_data()
+    {
+        QTest::addColumn<QString>("path");
+        QTest::newRow("legacy") << QString("legacy");
+        QTest::newRow("string") << QString("string");
+        QTest::newRow("hashed") << QString("hashed");
+    }
+
+    void translate()
+    {
+        QFETCH(QString, path);
+        const QString langFile = QStringLiteral(TRAYNEX_SOURCE_DIR "/language/zh.lang");
+        QVERIFY(Translator::instance().loadLanguage(langFile));
+        const QMap<QString, QString> legacy = loadLegacyTranslations(langFile);
+        QVERIFY(!legacy.isEmpty());
+
+        QString result;
+        if (path == "legacy") {
+            QBENCHMARK {
+                for (const char* source : UiSources) {
+                    result = legacyTranslate(legacy, "MainWindow", source);
+                }
+            }
+        }
+        else if (path == "string") {
+            const Translator& translator = Translator::instance();
+            QBENCHMARK {
+                for (const char* source : UiSources) {
+                    result = translator.translate(QString("MainWindow"), QString(source));
+                }
+            }
+        }
+        else {
+#define BENCH_TRC(source) translator.translate(TRANSLATION_KEY("MainWindow", source), source)
+            const Translator& translator = Translator::instance();
+            QBENCHMARK {
+                result = BENCH_TRC("Main");
+                result = BENCH_TRC("Settings");
+                result = BENCH_TRC("About");
+                result = BENCH_TRC("Version");
+                result = BENCH_TRC("Window Title");
+                result = BENCH_TRC("Process");
+                result = BENCH_TRC("Status");
+                result = BENCH_TRC("Hidden");
+            }
+#undef BENCH_TRC
+        }
+        QCOMPARE(result, legacy.value("MainWindow|Hidden"));
+    }
+
+    // 切换语言：发布另一种语言的表，再按登记的绑定逐项重新赋值。
+    // 绑定目标用普通 QObject 代替控件，计时只包含查表和赋值，不含控件重新布局
+    void languageSwitch_data()
+    {
+        QTest::addColumn<int>("bindings");
+        for (int bindings : { 100, 1000, 10000 }) {
+            QTest::addRow("%d", bindings) << bindings;
+        }
+    }
+
+    void languageSwitch()
+    {
+        QFETCH(int, bindings);
+        const QString languages[] = {
+            QStringLiteral(TRAYNEX_SOURCE_DIR "/language/en.lang"),
+            QStringLiteral(TRAYNEX_SOURCE_DIR "/language/zh.lang")
+        };
+        QVERIFY(Translator::instance().loadLanguage(languages[0]));
+
+        QObject ui;
+        TranslationBinder binder;
+        const int sourceCount = int(sizeof(UiSources) / sizeof(UiSources[0]));
+        for (int i = 0; i < bindings; ++i) {
+            QObject* target = new QObject(&ui);
+            const char* source = UiSources[i % sourceCount];
+            binder.bind(target, [target](const QString& text) { target->setObjectName(text); },
+                Translator::hashKey("MainWindow", source), source);
+        }
+        QCOMPARE(binder.size(), bindings);
+
+        int switches = 0;
+        QBENCHMARK {
+            QVERIFY(Translator::instance().loadLanguage(languages[++switches % 2]));
+            binder.retranslate();
+        }
+        const QString expected = Translator::instance().translate(TRANSLATION_KEY("MainWindow", "Main"), "Main");
+        QCOMPARE(ui.children().first()->objectName(), expected);
+    }
+
+    // 1,000 个隐藏窗口时的单项更新：改标题、恢复一个窗口再重新隐藏，然后打开菜单。
+    // 每次变化只增删或修改对应的动作，打开菜单时不重建
+    void trayMenuUpdate()
+    {
+        constexpr int Entries = 1000;
+        QMenu menu;
+        QAction* anchor = menu.addSeparator();
+        TrayWindowMenu windows(&menu, anchor, std::make_unique<FakeTrayMenuPlatform>());
+        for (int i = 1; i <= Entries; ++i) {
+            windows.insert(trayItem(quintptr(i)));
+        }
+        emit menu.aboutToShow();
+
+        int i = 0;
+        QBENCHMARK {
+            const quintptr id = quintptr(i % Entries + 1);
+            windows.setTitle(fakeWindow(id * 16), QString("Document %1 - Editor (%2)").arg(id).arg(i));
+            QVERIFY(windows.remove(fakeWindow(id * 16)));
+            windows.insert(trayItem(id));
+            emit menu.aboutToShow();
+            // 被替换的动作延迟删除，和事件循环中一样计入开销
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            ++i;
+        }
+        QCOMPARE(windows.count(), Entries);
+    }
+
+    // 打开托盘菜单的延迟应与隐藏窗口数无关：每轮先重新隐藏一个窗口，再真正弹出并关闭菜单，
+    // 计时包含 QMenu 计算尺寸和布局。在没有桌面的环境中用 QT_QPA_PLATFORM=offscreen 运行
+    void trayMenuOpen_data()
+    {
+        QTest::addColumn<int>("entries");
+        for (int entries : { 10, 100, 1000, 5000 }) {
+            QTest::addRow("%d", entries) << entries;
+        }
+    }
+
+    void trayMenuOpen()
+    {
+        QFETCH(int, entries);
+        QMenu menu;
+        QAction* anchor = menu.addSeparator();
+        TrayWindowMenu windows(&menu, anchor, std::make_unique<FakeTrayMenuPlatform>());
+        for (int i = 1; i <= entries; ++i) {
+            windows.insert(trayItem(quintptr(i)));
+        }
+
+        int i = 0;
+        QBENCHMARK {
+            windows.insert(trayItem(quintptr(i % entries + 1)));
+            menu.popup(QPoint(0, 0));
+            menu.hide();
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            ++i;
+        }
+        QVERIFY(menu.actions().size() <= windows.topLevelCap() + 40 + 1);
+    }
+};
+
+QTEST_MAIN(BenchTraynex)
+#include "bench_traynex.moc"
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "diagnostics.h"
+#include <QMutexLocker>
+
+Diagnostics& Diagnostics::instance()
+{
+    static Diagnostics inst;
+    return inst;
+}
+
+quint64 Diagnostics::registerSource(const QString& name, std::function<QString()> provider)
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 token = ++m_nextToken;
+    m_sources.append(Source{ token, name, std::move(provider) });
+    return token;
+}
+
+void Diagnostics::unregisterSource(quint64 token)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_sources.size(); ++i) {
+        if (m_sources.at(i).token == token) {
+            m_sources.removeAt(i);
+            return;
+        }
+    }
+}
+
+QString Diagnostics::report() const
+{
+    QMutexLocker locker(&m_mutex);
+    QString text;
+    for (const Source& source : m_sources) {
+        text += QString("[%1]\n%2\n\n").arg(source.name, source.provider());
+    }
+    return text.trimmed();
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <functional>
+
+// 运行时诊断信息汇总
+// 各组件注册一个回调，返回自身的计数器文本。
+// 非单例的组件在析构时用注册返回的编号注销，之后 report() 不会再调用它的回调
+class Diagnostics
+{
+public:
+    static Diagnostics& instance();
+
+    // 返回注销用的编号（从 1 开始）
+    quint64 registerSource(const QString& name, std::function<QString()> provider);
+    // 返回后保证不再有线程在调用该回调
+    void unregisterSource(quint64 token);
+
+    // 生成完整的诊断报告
+    QString report() const;
+
+private:
+    Diagnostics() = default;
+
+    struct Source {
+        quint64 token;
+        QString name;
+        std::function<QString()> provider;
+    };
+
+    // 生成报告时持有锁调用回调，注销因此会等待正在进行的报告结束
+    mutable QMutex m_mutex;
+    QList<Source> m_sources;
+    quint64 m_nextToken = 0;
+};
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include "hiddenwindowjournal.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// 文件头：魔数 + 版本
+constexpr uint32_t SnapshotMagic = 0x53584E54;   // "TNXS"
+constexpr uint32_t JournalMagic = 0x4A584E54;    // "TNXJ"
+constexpr uint32_t FormatVersion = 1;
+constexpr size_t HeaderSize = 8;
+
+// 记录：负载长度(u32) + CRC32(u32) + 负载
+constexpr size_t RecordHeaderSize = 8;
+constexpr uint32_t MaxPayloadSize = 1 << 20;
+
+template <typename T>
+void put(std::string& out, T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void putString(std::string& out, const std::wstring& text)
+{
+    uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), 0xFFFF));
+    put(out, length);
+    for (uint16_t i = 0; i < length; ++i) {
+        put(out, static_cast<uint16_t>(text[i]));
+    }
+}
+
+template <typename T>
+bool get(const char*& p, const char* end, T& value)
+{
+    if (static_cast<size_t>(end - p) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+bool getString(const char*& p, const char* end, std::wstring& text)
+{
+    uint16_t length = 0;
+    if (!get(p, end, length) || static_cast<size_t>(end - p) < length * sizeof(uint16_t)) {
+        return false;
+    }
+    text.resize(length);
+    for (uint16_t i = 0; i < length; ++i) {
+        uint16_t ch;
+        std::memcpy(&ch, p, sizeof(ch));
+        p += sizeof(ch);
+        text[i] = static_cast<wchar_t>(ch);
+    }
+    return true;
+}
+
+std::string fileHeader(uint32_t magic)
+{
+    std::string header;
+    put(header, magic);
+    put(header, FormatVersion);
+    return header;
+}
+
+bool writeAll(HANDLE file, const std::string& data)
+{
+    DWORD written = 0;
+    return WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written, NULL)
+        && written == data.size();
+}
+
+} // namespace
+
+void HiddenWindowJournal::State::apply(const HiddenWindowRecord& record)
+{
+    if (record.kind == HiddenWindowRecord::Restore) {
+        m_entries.erase(record.hwnd);
+        return;
+    }
+
+    // 重复隐藏视为最近一次隐藏，顺序与 MRU 一致
+    Entry& entry = m_entries[record.hwnd];
+    entry.sequence = m_nextSequence++;
+    entry.record = record;
+}
+
+void HiddenWindowJournal::State::clear()
+{
+    m_entries.clear();
+    m_nextSequence = 0;
+}
+
+std::vector<HiddenWindowRecord> HiddenWindowJournal::State::records() const
+{
+    std::vector<const Entry*> entries;
+    entries.reserve(m_entries.size());
+    for (const auto& item : m_entries) {
+        entries.push_back(&item.second);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->sequence < b->sequence;
+        });
+
+    std::vector<HiddenWindowRecord> result;
+    result.reserve(entries.size());
+    for (const Entry* entry : entries) {
+        result.push_back(entry->record);
+    }
+    return result;
+}
+
+HiddenWindowJournal::HiddenWindowJournal(std::wstring snapshotPath, std::wstring journalPath)
+    : m_snapshotPath(std::move(snapshotPath))
+    , m_journalPath(std::move(journalPath))
+{
+}
+
+HiddenWindowJournal::~HiddenWindowJournal()
+{
+    closeJournal();
+}
+
+uint32_t HiddenWindowJournal::crc32(const char* data, size_t size)
+{
+    static const auto table = []() {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void HiddenWindowJournal::encode(const HiddenWindowRecord& record, std::string& out)
+{
+    size_t start = out.size();
+    out.append(RecordHeaderSize, '\0');
+
+    put(out, static_cast<uint8_t>(record.kind));
+    put(out, static_cast<uint8_t>(record.store));
+    put(out, record.hwnd);
+    put(out, record.processId);
+    put(out, record.processStartTime);
+    putString(out, record.exePath);
+    putString(out, record.title);
+
+    uint32_t payloadSize = static_cast<uint32_t>(out.size() - start - RecordHeaderSize);
+    uint32_t checksum = crc32(out.data() + start + RecordHeaderSize, payloadSize);
+    std::memcpy(&out[start], &payloadSize, sizeof(payloadSize));
+    std::memcpy(&out[start + 4], &checksum, sizeof(checksum));
+}
+
+bool HiddenWindowJournal::decode(const std::string& data, size_t& offset, HiddenWindowRecord& record)
+{
+    if (data.size() < offset || data.size() - offset < RecordHeaderSize) {
+        return false;
+    }
+
+    uint32_t payloadSize;
+    uint32_t checksum;
+    std::memcpy(&payloadSize, data.data() + offset, sizeof(payloadSize));
+    std::memcpy(&checksum, data.data() + offset + 4, sizeof(checksum));
+    if (payloadSize > MaxPayloadSize || data.size() - offset - RecordHeaderSize < payloadSize) {
+        return false;
+    }
+
+    const char* p = data.data() + offset + RecordHeaderSize;
+    const char* end = p + payloadSize;
+    if (crc32(p, payloadSize) != checksum) {
+        return false;
+    }
+
+    uint8_t kind;
+    uint8_t store;
+    if (!get(p, end, kind) || !get(p, end, store)
+        || !get(p, end, record.hwnd)
+        || !get(p, end, record.processId)
+        || !get(p, end, record.processStartTime)
+        || !getString(p, end, record.exePath)
+        || !getString(p, end, record.title)) {
+        return false;
+    }
+    if (kind != HiddenWindowRecord::Hide && kind != HiddenWindowRecord::Restore) {
+        return false;
+    }
+    record.kind = static_cast<HiddenWindowRecord::Kind>(kind);
+    record.store = store == HiddenWindowRecord::AppTray ? HiddenWindowRecord::AppTray : HiddenWindowRecord::SystemTray;
+
+    offset += RecordHeaderSize + payloadSize;
+    return true;
+}
+
+size_t HiddenWindowJournal::replayBuffer(const std::string& data, State& state, uint64_t& records)
+{
+    if (data.size() < HeaderSize) {
+        return 0;
+    }
+    uint32_t magic;
+    uint32_t version;
+    std::memcpy(&magic, data.data(), sizeof(magic));
+    std::memcpy(&version, data.data() + 4, sizeof(version));
+    if ((magic != SnapshotMagic && magic != JournalMagic) || version != FormatVersion) {
+        return 0;
+    }
+
+    size_t offset = HeaderSize;
+    HiddenWindowRecord record;
+    while (decode(data, offset, record)) {
+        state.apply(record);
+        ++records;
+    }
+    return offset;
+}
+
+std::vector<HiddenWindowRecord> HiddenWindowJournal::replay()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    m_state.clear();
+    uint64_t records = 0;
+    std::string data;
+    if (readFile(m_snapshotPath, data)) {
+        replayBuffer(data, m_state, records);
+    }
+
+    bool tornTail = false;
+    if (readFile(m_journalPath, data)) {
+        uint64_t journalRecords = 0;
+        size_t valid = replayBuffer(data, m_state, journalRecords);
+        tornTail = valid < data.size();
+        records += journalRecords;
+        m_journalRecords = static_cast<int>(journalRecords);
+    }
+
+    m_stats.replayed = records;
+    m_stats.replayMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // 丢弃损坏的尾部，之后的记录才能追加在有效数据之后
+    if (tornTail) {
+        ++m_stats.discarded;
+        compact();
+    }
+
+    return m_state.records();
+}
+
+bool HiddenWindowJournal::append(const std::vector<HiddenWindowRecord>& records)
+{
+    if (records.empty()) {
+        return true;
+    }
+    if (!openJournal()) {
+        return false;
+    }
+
+    std::string data;
+    for (const HiddenWindowRecord& record : records) {
+        encode(record, data);
+        m_state.apply(record);
+    }
+
+    LARGE_INTEGER zero = {};
+    bool ok = SetFilePointerEx(m_journal, zero, NULL, FILE_END)
+        && writeAll(m_journal, data)
+        && FlushFileBuffers(m_journal);
+
+    m_stats.appended += records.size();
+    m_journalRecords += static_cast<int>(records.size());
+    if (!ok || m_journalRecords >= m_compactThreshold) {
+        // 写入失败时用快照兜底
+        return compact() && ok;
+    }
+    return ok;
+}
+
+bool HiddenWindowJournal::compact()
+{
+    return rewrite(m_state.records());
+}
+
+bool HiddenWindowJournal::rewrite(const std::vector<HiddenWindowRecord>& hidden)
+{
+    m_state.clear();
+    std::string data = fileHeader(SnapshotMagic);
+    for (HiddenWindowRecord record : hidden) {
+        record.kind = HiddenWindowRecord::Hide;
+        encode(record, data);
+        m_state.apply(record);
+    }
+
+    // 快照替换成功后才清空日志；两步之间崩溃时重放结果相同
+    if (!writeFileAtomic(m_snapshotPath, data)) {
+        return false;
+    }
+    ++m_stats.compactions;
+    return resetJournal();
+}
+
+HiddenWindowJournal::Stats HiddenWindowJournal::stats() const
+{
+    Stats s = m_stats;
+    s.journalRecords = m_journalRecords;
+    s.hidden = m_state.size();
+    return s;
+}
+
+bool HiddenWindowJournal::readFile(const std::wstring& path, std::string& data)
+{
+    data.clear();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    bool ok = GetFileSizeEx(file, &size) && size.QuadPart < MAXDWORD;
+    if (ok) {
+        data.resize(static_cast<size_t>(size.QuadPart));
+        DWORD read = 0;
+        ok = data.empty() || (ReadFile(file, &data[0], static_cast<DWORD>(data.size()), &read, NULL)
+            && read == data.size());
+    }
+    CloseHandle(file);
+    return ok;
+}
+
+bool HiddenWindowJournal::writeFileAtomic(const std::wstring& path, const std::string& data)
+{
+    std::wstring tempPath = path + L".tmp";
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    bool ok = writeAll(file, data) && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!ok) {
+        DeleteFileW(tempPath.c_str());
+        return false;
+    }
+    return MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool HiddenWindowJournal::openJournal()
+{
+    if (m_journal != INVALID_HANDLE_VALUE) {
+        return true;
+    }
+
+    m_journal = CreateFileW(m_journalPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_journal == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // 新文件先写入文件头
+    LARGE_INTEGER size = {};
+    if (GetFileSizeEx(m_journal, &size) && size.QuadPart == 0) {
+        return resetJournal();
+    }
+    return true;
+}
+
+void HiddenWindowJournal::closeJournal()
+{
+    if (m_journal != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_journal);
+        m_journal = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool HiddenWindowJournal::resetJournal()
+{
+    if (m_journal == INVALID_HANDLE_VALUE && !openJournal()) {
+        return false;
+    }
+
+    LARGE_INTEGER zero = {};
+    m_journalRecords = 0;
+    return SetFilePointerEx(m_journal, zero, NULL, FILE_BEGIN)
+        && SetEndOfFile(m_journal)
+        && writeAll(m_journal, fileHeader(JournalMagic))
+        && FlushFileBuffers(m_journal);
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Windows.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 隐藏/恢复记录
+// 除窗口句柄外还保存进程ID、进程启动时间和可执行文件路径，
+// 重启后据此确认句柄仍属于同一个窗口（句柄和进程ID都可能被复用）
+struct HiddenWindowRecord
+{
+    enum Kind : uint8_t { Hide = 1, Restore = 2 };
+    enum Store : uint8_t { SystemTray = 0, AppTray = 1 };
+
+    Kind kind = Hide;
+    Store store = SystemTray;
+    uint64_t hwnd = 0;
+    uint32_t processId = 0;
+    uint64_t processStartTime = 0;   // FILETIME 100ns，未知时为 0
+    std::wstring exePath;
+    std::wstring title;
+};
+
+// 隐藏窗口状态日志
+// 每次提交向日志文件追加带 CRC32 校验的二进制记录；记录数超过阈值时
+// 把当前状态写入快照文件（先写临时文件，再原子替换），然后清空日志。
+// 启动时读取快照并重放日志，遇到截断或校验失败的记录即停止，
+// 崩溃时写了一半的尾部记录被丢弃，之前的状态不受影响。
+class HiddenWindowJournal
+{
+public:
+    HiddenWindowJournal(std::wstring snapshotPath, std::wstring journalPath);
+    ~HiddenWindowJournal();
+
+    HiddenWindowJournal(const HiddenWindowJournal&) = delete;
+    HiddenWindowJournal& operator=(const HiddenWindowJournal&) = delete;
+
+    // 读取快照并重放日志，返回仍处于隐藏状态的记录（按隐藏顺序）
+    std::vector<HiddenWindowRecord> replay();
+
+    // 追加记录，一次写入、一次刷盘
+    bool append(const std::vector<HiddenWindowRecord>& records);
+
+    // 以给定状态替换快照并清空日志
+    bool rewrite(const std::vector<HiddenWindowRecord>& hidden);
+
+    // 把当前状态压缩为快照
+    bool compact();
+
+    // 日志记录数达到该值时自动压缩
+    void setCompactThreshold(int records) { m_compactThreshold = records > 0 ? records : 1; }
+
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t compactions = 0;
+        uint64_t replayed = 0;
+        uint64_t discarded = 0;      // 校验失败或截断的尾部记录
+        uint64_t replayMicros = 0;
+        int journalRecords = 0;
+        int hidden = 0;
+    };
+    Stats stats() const;
+
+    // 编解码，与文件无关
+    static void encode(const HiddenWindowRecord& record, std::string& out);
+    // 从 data[offset] 解码一条记录并前移 offset；数据不完整或校验失败返回 false
+    static bool decode(const std::string& data, size_t& offset, HiddenWindowRecord& record);
+    static uint32_t crc32(const char* data, size_t size);
+
+    // 隐藏窗口状态：按句柄去重，按最近一次隐藏的先后排序
+    class State
+    {
+    public:
+        void apply(const HiddenWindowRecord& record);
+        void clear();
+        int size() const { return static_cast<int>(m_entries.size()); }
+        std::vector<HiddenWindowRecord> records() const;
+
+    private:
+        struct Entry {
+            uint64_t sequence = 0;
+            HiddenWindowRecord record;
+        };
+        std::unordered_map<uint64_t, Entry> m_entries;
+        uint64_t m_nextSequence = 0;
+    };
+
+    // 解析整个文件内容，返回最后一条完整记录之后的偏移
+    static size_t replayBuffer(const std::string& data, State& state, uint64_t& records);
+
+private:
+    static bool readFile(const std::wstring& path, std::string& data);
+    static bool writeFileAtomic(const std::wstring& path, const std::string& data);
+
+    bool openJournal();
+    void closeJournal();
+    bool resetJournal();
+
+    std::wstring m_snapshotPath;
+    std::wstring m_journalPath;
+    HANDLE m_journal = INVALID_HANDLE_VALUE;
+    State m_state;
+    int m_journalRecords = 0;
+    int m_compactThreshold = DefaultCompactThreshold;
+    Stats m_stats;
+
+    static constexpr int DefaultCompactThreshold = 256;
+};
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "hiddenwindowmru.h"
+#include <algorithm>
+
+void HiddenWindowMru::touch(HWND hwnd)
+{
+    if (!hwnd) {
+        return;
+    }
+
+    auto result = m_nodes.emplace(hwnd, Node());
+    Node* node = &result.first->second;
+    if (result.second) {
+        node->hwnd = hwnd;
+    }
+    else if (node == m_head) {
+        return;
+    }
+    else {
+        unlink(node);
+    }
+    pushFront(node);
+}
+
+bool HiddenWindowMru::remove(HWND hwnd)
+{
+    auto it = m_nodes.find(hwnd);
+    if (it == m_nodes.end()) {
+        return false;
+    }
+    unlink(&it->second);
+    m_nodes.erase(it);
+    return true;
+}
+
+void HiddenWindowMru::clear()
+{
+    m_nodes.clear();
+    m_head = nullptr;
+    m_tail = nullptr;
+}
+
+std::vector<HWND> HiddenWindowMru::first(int count) const
+{
+    std::vector<HWND> result;
+    size_t limit = count < 0 ? m_nodes.size() : std::min(m_nodes.size(), static_cast<size_t>(count));
+    result.reserve(limit);
+    for (const Node* node = m_head; node && result.size() < limit; node = node->next) {
+        result.push_back(node->hwnd);
+    }
+    return result;
+}
+
+void HiddenWindowMru::unlink(Node* node)
+{
+    if (node->prev) {
+        node->prev->next = node->next;
+    }
+    else {
+        m_head = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    else {
+        m_tail = node->prev;
+    }
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void HiddenWindowMru::pushFront(Node* node)
+{
+    node->prev = nullptr;
+    node->next = m_head;
+    if (m_head) {
+        m_head->prev = node;
+    }
+    m_head = node;
+    if (!m_tail) {
+        m_tail = node;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Windows.h>
+#include <unordered_map>
+#include <vector>
+
+// 最近隐藏顺序（MRU），两种隐藏方式共用
+// 哈希表中的节点通过指针串成双向链表（unordered_map 的节点地址在扩容时不变），
+// touch/remove/front 都是 O(1)
+class HiddenWindowMru
+{
+public:
+    HiddenWindowMru() = default;
+    HiddenWindowMru(const HiddenWindowMru&) = delete;
+    HiddenWindowMru& operator=(const HiddenWindowMru&) = delete;
+
+    // 移到最前（不存在时插入）
+    void touch(HWND hwnd);
+    bool remove(HWND hwnd);
+    void clear();
+
+    HWND front() const { return m_head ? m_head->hwnd : nullptr; }
+    bool contains(HWND hwnd) const { return m_nodes.count(hwnd) != 0; }
+    int size() const { return static_cast<int>(m_nodes.size()); }
+    bool empty() const { return m_nodes.empty(); }
+
+    // 最近的 count 个窗口，count < 0 时返回全部
+    std::vector<HWND> first(int count = -1) const;
+
+    // 从最近到最早遍历
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (const Node* node = m_head; node; node = node->next) {
+            fn(node->hwnd);
+        }
+    }
+
+private:
+    struct Node {
+        HWND hwnd = nullptr;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+
+    void unlink(Node* node);
+    void pushFront(Node* node);
+
+    std::unordered_map<HWND, Node> m_nodes;
+    Node* m_head = nullptr;
+    Node* m_tail = nullptr;
+};
\ No newline at end of file
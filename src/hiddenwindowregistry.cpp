@@ -0,0 +1,121 @@
+#include "hiddenwindowregistry.h"
+
+UINT HiddenWindowRegistry::makeId(int slot, uint16_t generation)
+{
+    return (static_cast<UINT>(generation) << SlotBits) | static_cast<UINT>(slot);
+}
+
+HiddenWindowRegistry::Entry* HiddenWindowRegistry::insert(HWND hwnd)
+{
+    if (!hwnd || contains(hwnd)) {
+        return nullptr;
+    }
+
+    int slot;
+    if (!m_free.empty()) {
+        slot = m_free.back();
+        m_free.pop_back();
+    }
+    else if (static_cast<int>(m_slots.size()) < MaxSlots) {
+        slot = static_cast<int>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    else {
+        return nullptr;
+    }
+
+    Slot& s = m_slots[slot];
+    s.used = true;
+    s.entry = Entry();
+    s.entry.hwnd = hwnd;
+    s.entry.iconData.uID = makeId(slot, s.generation);
+
+    // 追加到隐藏顺序末尾
+    s.prev = m_tail;
+    s.next = NoSlot;
+    if (m_tail != NoSlot) {
+        m_slots[m_tail].next = slot;
+    }
+    else {
+        m_head = slot;
+    }
+    m_tail = slot;
+
+    m_byHwnd[hwnd] = slot;
+    ++m_count;
+    return &s.entry;
+}
+
+HiddenWindowRegistry::Entry* HiddenWindowRegistry::findByHwnd(HWND hwnd)
+{
+    auto it = m_byHwnd.find(hwnd);
+    return it == m_byHwnd.end() ? nullptr : &m_slots[it->second].entry;
+}
+
+HiddenWindowRegistry::Entry* HiddenWindowRegistry::findById(UINT iconId)
+{
+    int slot = static_cast<int>(iconId & (MaxSlots - 1));
+    uint16_t generation = static_cast<uint16_t>(iconId >> SlotBits);
+    if (slot >= static_cast<int>(m_slots.size())) {
+        return nullptr;
+    }
+
+    // 代数不符说明是已释放图标的旧 ID
+    Slot& s = m_slots[slot];
+    if (!s.used || s.generation != generation) {
+        return nullptr;
+    }
+    return &s.entry;
+}
+
+bool HiddenWindowRegistry::remove(HWND hwnd)
+{
+    auto it = m_byHwnd.find(hwnd);
+    if (it == m_byHwnd.end()) {
+        return false;
+    }
+
+    int slot = it->second;
+    m_byHwnd.erase(it);
+    unlink(slot);
+
+    Slot& s = m_slots[slot];
+    s.used = false;
+    s.entry = Entry();
+
+    // 代数在 [1, GenerationMask] 内循环
+    s.generation = (s.generation % GenerationMask) + 1;
+
+    m_free.push_back(slot);
+    --m_count;
+    return true;
+}
+
+void HiddenWindowRegistry::clear()
+{
+    // 保留各槽位的代数，清空后分配的 ID 仍与旧 ID 不同
+    for (int slot = m_head; slot != NoSlot; ) {
+        int next = m_slots[slot].next;
+        remove(m_slots[slot].entry.hwnd);
+        slot = next;
+    }
+}
+
+void HiddenWindowRegistry::unlink(int slot)
+{
+    Slot& s = m_slots[slot];
+    if (s.prev != NoSlot) {
+        m_slots[s.prev].next = s.next;
+    }
+    else {
+        m_head = s.next;
+    }
+    if (s.next != NoSlot) {
+        m_slots[s.next].prev = s.prev;
+    }
+    else {
+        m_tail = s.prev;
+    }
+    s.prev = NoSlot;
+    s.next = NoSlot;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Windows.h>
+#include <shellapi.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 隐藏窗口登记表（slot map）
+// 按窗口句柄和托盘图标 ID 都是 O(1) 查找，遍历保持隐藏顺序。
+// 托盘图标 ID = 代数 << SlotBits | 槽位：槽位释放后代数递增，
+// 旧图标迟到的点击消息不会落到新窗口上，也不会分配出仍在使用的 ID。
+// NOTIFYICON_VERSION_4 的回调只带 16 位图标 ID，因此 ID 限制在 16 位内。
+class HiddenWindowRegistry
+{
+public:
+    static constexpr int SlotBits = 10;
+    static constexpr int MaxSlots = 1 << SlotBits;
+
+    struct Entry {
+        HWND hwnd = nullptr;
+        NOTIFYICONDATA iconData = {};
+    };
+
+    // 登记窗口并分配托盘图标 ID；已满或已登记时返回 nullptr
+    Entry* insert(HWND hwnd);
+
+    Entry* findByHwnd(HWND hwnd);
+    Entry* findById(UINT iconId);
+
+    bool remove(HWND hwnd);
+    void clear();
+
+    int size() const { return m_count; }
+    bool contains(HWND hwnd) const { return m_byHwnd.count(hwnd) != 0; }
+
+    // 按隐藏顺序遍历
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (int slot = m_head; slot != NoSlot; slot = m_slots[slot].next) {
+            fn(m_slots[slot].entry);
+        }
+    }
+
+private:
+    static constexpr int NoSlot = -1;
+    static constexpr uint16_t GenerationMask = (1u << (16 - SlotBits)) - 1;
+
+    struct Slot {
+        Entry entry;
+        uint16_t generation = 1;   // 从 1 开始，ID 不会为 0
+        bool used = false;
+        int prev = NoSlot;         // 隐藏顺序链表
+        int next = NoSlot;
+    };
+
+    static UINT makeId(int slot, uint16_t generation);
+    void unlink(int slot);
+
+    std::vector<Slot> m_slots;
+    std::vector<int> m_free;
+    std::unordered_map<HWND, int> m_byHwnd;
+    int m_head = NoSlot;
+    int m_tail = NoSlot;
+    int m_count = 0;
+};
\ No newline at end of file
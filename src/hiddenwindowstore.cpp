@@ -0,0 +1,82 @@
+#include "hiddenwindowstore.h"
+#include "processinfocache.h"
+#include "iconcache.h"
+
+WindowInfo HiddenWindowStore::capture(HWND hwnd)
+{
+    WindowInfo info;
+    info.hwnd = hwnd;
+    info.isHidden = true;
+    info.processName = "Unknown";
+    info.className = "Unknown";
+
+    wchar_t title[256];
+    if (GetWindowText(hwnd, title, 256) > 0) {
+        info.title = QString::fromWCharArray(title);
+    }
+
+    wchar_t className[256];
+    if (GetClassName(hwnd, className, 256)) {
+        info.className = QString::fromWCharArray(className);
+    }
+
+    GetWindowThreadProcessId(hwnd, &info.processId);
+    QString processName = ProcessInfoCache::instance().processName(info.processId);
+    if (!processName.isEmpty()) {
+        info.processName = processName;
+    }
+
+    info.iconKey = IconCache::instance().resolve(hwnd, info.processId);
+    return info;
+}
+
+void HiddenWindowStore::insert(HWND hwnd, HiddenWindowRecord::Store store, const WindowInfo& info)
+{
+    if (!hwnd) {
+        return;
+    }
+
+    auto result = m_windows.emplace(hwnd, HiddenWindow());
+    HiddenWindow& window = result.first->second;
+    if (!result.second) {
+        --m_counts[window.store];
+    }
+    window.store = store;
+    window.info = info;
+    ++m_counts[store];
+
+    m_order.touch(hwnd);
+}
+
+bool HiddenWindowStore::remove(HWND hwnd)
+{
+    auto it = m_windows.find(hwnd);
+    if (it == m_windows.end()) {
+        return false;
+    }
+
+    --m_counts[it->second.store];
+    m_windows.erase(it);
+    m_order.remove(hwnd);
+    return true;
+}
+
+void HiddenWindowStore::clear()
+{
+    m_windows.clear();
+    m_order.clear();
+    m_counts[HiddenWindowRecord::SystemTray] = 0;
+    m_counts[HiddenWindowRecord::AppTray] = 0;
+}
+
+const HiddenWindow* HiddenWindowStore::find(HWND hwnd) const
+{
+    auto it = m_windows.find(hwnd);
+    return it != m_windows.end() ? &it->second : nullptr;
+}
+
+bool HiddenWindowStore::contains(HWND hwnd, HiddenWindowRecord::Store store) const
+{
+    const HiddenWindow* window = find(hwnd);
+    return window && window->store == store;
+}
\ No newline at end of file
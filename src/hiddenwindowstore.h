@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Windows.h>
+#include <unordered_map>
+#include <vector>
+#include "windowinfo.h"
+#include "hiddenwindowjournal.h"
+#include "hiddenwindowmru.h"
+
+// 隐藏窗口（两种隐藏方式共用）
+struct HiddenWindow
+{
+    HiddenWindowRecord::Store store = HiddenWindowRecord::SystemTray;
+    WindowInfo info;         // 隐藏时采集，之后只读
+};
+
+// 隐藏窗口总表
+// 托盘图标和托盘菜单两种方式隐藏的窗口都登记在这里，隐藏时采集一次标题、进程名、
+// 类名和图标键，隐藏表格、右键菜单和托盘菜单只读这里的数据，不再查询系统。
+// 按句柄 O(1) 查找，遍历按最近隐藏在前的顺序。
+class HiddenWindowStore
+{
+public:
+    HiddenWindowStore() = default;
+    HiddenWindowStore(const HiddenWindowStore&) = delete;
+    HiddenWindowStore& operator=(const HiddenWindowStore&) = delete;
+
+    // 采集窗口的展示信息
+    static WindowInfo capture(HWND hwnd);
+
+    // 登记窗口并移到最近位置；已登记时覆盖
+    void insert(HWND hwnd, HiddenWindowRecord::Store store, const WindowInfo& info);
+    bool remove(HWND hwnd);
+    void clear();
+
+    const HiddenWindow* find(HWND hwnd) const;
+    bool contains(HWND hwnd) const { return m_windows.count(hwnd) != 0; }
+    bool contains(HWND hwnd, HiddenWindowRecord::Store store) const;
+
+    int size() const { return static_cast<int>(m_windows.size()); }
+    int count(HiddenWindowRecord::Store store) const { return m_counts[store]; }
+
+    // 最近隐藏的窗口
+    HWND front() const { return m_order.front(); }
+    std::vector<HWND> recent(int count = -1) const { return m_order.first(count); }
+
+    // 从最近到最早遍历
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        m_order.forEach([this, &fn](HWND hwnd) {
+            fn(hwnd, m_windows.at(hwnd));
+            });
+    }
+
+private:
+    std::unordered_map<HWND, HiddenWindow> m_windows;
+    HiddenWindowMru m_order;
+    int m_counts[2] = {};
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "hotkeymanager.h"
+#include "diagnostics.h"
 #include <QDebug>
+#include <QStringList>
 #include <QApplication>
 #include <objbase.h>
 
@@ -17,7 +19,19 @@ HotkeyManager::HotkeyManager(QObject* parent)
     : QObject(parent)
 {
     CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+
+    // 热键窗口建在原生消息线程上，GUI 线程繁忙时 WM_HOTKEY 也不会积压
+    NativeMessageThread& thread = NativeMessageThread::instance();
+    thread.startThread();
+    thread.setHandler(NativeMessageThread::Event::Hotkey, [this](const NativeMessageThread::Event& event) {
+        dispatch(event);
+        });
+
     createHotkeyWindow();
+
+    Diagnostics::instance().registerSource("Hotkeys", [this]() {
+        return statsString();
+        });
 }
 
 HotkeyManager::~HotkeyManager()
@@ -34,6 +48,15 @@ HotkeyManager::~HotkeyManager()
 }
 
 bool HotkeyManager::createHotkeyWindow()
+{
+    bool created = false;
+    NativeMessageThread::instance().invoke([this, &created]() {
+        created = createHotkeyWindowOnThread();
+        });
+    return created;
+}
+
+bool HotkeyManager::createHotkeyWindowOnThread()
 {
     // 注册窗口类
     WNDCLASS wc = {};
@@ -70,7 +93,10 @@ bool HotkeyManager::createHotkeyWindow()
 void HotkeyManager::destroyHotkeyWindow()
 {
     if (m_hotkeyWindow) {
-        DestroyWindow(m_hotkeyWindow);
+        HWND window = m_hotkeyWindow;
+        NativeMessageThread::instance().invoke([window]() {
+            DestroyWindow(window);
+            });
         m_hotkeyWindow = nullptr;
     }
 }
@@ -88,11 +114,20 @@ LRESULT CALLBACK HotkeyManager::hotkeyWndProc(HWND hwnd, UINT uMsg, WPARAM wPara
         manager = reinterpret_cast<HotkeyManager*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
     }
 
+    // 运行在原生消息线程：先记下前台窗口、执行立即动作，再通知 GUI 线程
     if (manager && uMsg == WM_HOTKEY) {
-        QString hotkeyId = manager->m_idToHotkey.value(wParam);
-        if (!hotkeyId.isEmpty()) {
-            emit manager->hotkeyTriggered(hotkeyId);
+        NativeMessageThread::Event event;
+        event.type = NativeMessageThread::Event::Hotkey;
+        event.code = static_cast<UINT>(wParam);
+        event.foreground = GetForegroundWindow();
+        event.timestampNs = NativeMessageThread::nowNs();
+
+        const size_t index = static_cast<size_t>(wParam) - BASE_HOTKEY_ID;
+        if (wParam >= BASE_HOTKEY_ID && index < manager->m_nativeActions.size() && manager->m_nativeActions[index]) {
+            manager->m_nativeActions[index](event.foreground);
         }
+
+        NativeMessageThread::instance().post(event);
         return 0;
     }
 
@@ -218,15 +253,32 @@ bool HotkeyManager::registerHotkey(const QString& id, const QKeySequence& keySeq
         return false;
     }
 
-    int hotkeyId = m_nextHotkeyId++;
-    if (RegisterHotKey(m_hotkeyWindow, hotkeyId, modifiers | MOD_NOREPEAT, key)) {
+    // RegisterHotKey 只接受调用线程创建的窗口
+    const int slot = allocateSlot();
+    const int hotkeyId = BASE_HOTKEY_ID + slot;
+    bool registered = false;
+    Action immediate = m_immediateActions.value(id);
+    NativeMessageThread::instance().invoke([&]() {
+        registered = RegisterHotKey(m_hotkeyWindow, hotkeyId, modifiers | MOD_NOREPEAT, key) != FALSE;
+        if (registered) {
+            if (m_nativeActions.size() <= static_cast<size_t>(slot)) {
+                m_nativeActions.resize(slot + 1);
+            }
+            m_nativeActions[slot] = immediate;
+        }
+        });
+
+    if (registered) {
+        Slot& entry = m_slots[slot];
+        entry.id = id;
+        entry.sequence = keySequence;
+        entry.action = m_actions.value(id);
         m_hotkeyIds[id] = hotkeyId;
-        m_idToHotkey[hotkeyId] = id;
-        m_hotkeys[id] = keySequence;
         qDebug() << "Hotkey registered:" << id << "=" << keySequence.toString();
         return true;
     }
     else {
+        m_freeSlots.push_back(slot);
         qWarning() << "Failed to register hotkey:" << id << "=" << keySequence.toString();
         return false;
     }
@@ -238,11 +290,20 @@ bool HotkeyManager::unregisterHotkey(const QString& id)
         return false;
     }
 
-    int hotkeyId = m_hotkeyIds[id];
-    if (UnregisterHotKey(m_hotkeyWindow, hotkeyId)) {
+    const int hotkeyId = m_hotkeyIds[id];
+    const int slot = hotkeyId - BASE_HOTKEY_ID;
+    bool unregistered = false;
+    NativeMessageThread::instance().invoke([&]() {
+        unregistered = UnregisterHotKey(m_hotkeyWindow, hotkeyId) != FALSE;
+        if (unregistered) {
+            m_nativeActions[slot] = nullptr;
+        }
+        });
+
+    if (unregistered) {
         m_hotkeyIds.remove(id);
-        m_idToHotkey.remove(hotkeyId);
-        m_hotkeys.remove(id);
+        m_slots[slot] = Slot();
+        m_freeSlots.push_back(slot);
         qDebug() << "Hotkey unregistered:" << id;
         return true;
     }
@@ -252,6 +313,39 @@ bool HotkeyManager::unregisterHotkey(const QString& id)
     }
 }
 
+int HotkeyManager::allocateSlot()
+{
+    if (!m_freeSlots.empty()) {
+        int slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    m_slots.emplace_back();
+    return static_cast<int>(m_slots.size()) - 1;
+}
+
+void HotkeyManager::dispatch(const NativeMessageThread::Event& event)
+{
+    const size_t index = static_cast<size_t>(event.code) - BASE_HOTKEY_ID;
+    if (event.code < BASE_HOTKEY_ID || index >= m_slots.size() || m_slots[index].id.isEmpty()) {
+        return;
+    }
+
+    // m_slots 是 deque，动作里注册新热键也不会使 slot 失效
+    Slot& slot = m_slots[index];
+    if (slot.action) {
+        slot.action(event.foreground);
+    }
+    else {
+        emit hotkeyTriggered(slot.id, event.foreground);
+    }
+
+    // 延迟从消息线程收到 WM_HOTKEY 算起，到动作完成为止
+    slot.lastLatencyNs = NativeMessageThread::nowNs() - event.timestampNs;
+    slot.maxLatencyNs = qMax(slot.maxLatencyNs, slot.lastLatencyNs);
+    ++slot.triggered;
+}
+
 void HotkeyManager::unregisterAll()
 {
     for (const QString& id : m_hotkeyIds.keys()) {
@@ -266,8 +360,9 @@ bool HotkeyManager::isHotkeyRegistered(const QString& id) const
 
 void HotkeyManager::saveHotkeys(QSettings& settings)
 {
+    QHash<QString, QKeySequence> hotkeys = getAllHotkeys();
     settings.beginGroup("Hotkeys");
-    for (auto it = m_hotkeys.begin(); it != m_hotkeys.end(); ++it) {
+    for (auto it = hotkeys.begin(); it != hotkeys.end(); ++it) {
         settings.setValue(it.key(), it.value().toString());
     }
     settings.endGroup();
@@ -288,5 +383,60 @@ void HotkeyManager::loadHotkeys(QSettings& settings)
 
 QHash<QString, QKeySequence> HotkeyManager::getAllHotkeys() const
 {
-    return m_hotkeys;
+    QHash<QString, QKeySequence> hotkeys;
+    for (const Slot& slot : m_slots) {
+        if (!slot.id.isEmpty()) {
+            hotkeys.insert(slot.id, slot.sequence);
+        }
+    }
+    return hotkeys;
+}
+
+void HotkeyManager::setAction(const QString& id, Action action)
+{
+    if (action) {
+        m_actions[id] = action;
+    }
+    else {
+        m_actions.remove(id);
+    }
+
+    // 已注册的热键立即生效，否则在注册时生效
+    if (m_hotkeyIds.contains(id)) {
+        m_slots[m_hotkeyIds[id] - BASE_HOTKEY_ID].action = action;
+    }
+}
+
+void HotkeyManager::setImmediateAction(const QString& id, Action action)
+{
+    if (action) {
+        m_immediateActions[id] = action;
+    }
+    else {
+        m_immediateActions.remove(id);
+    }
+
+    // 已注册的热键立即生效，否则在注册时生效
+    if (!m_hotkeyIds.contains(id)) {
+        return;
+    }
+    const int slot = m_hotkeyIds[id] - BASE_HOTKEY_ID;
+    NativeMessageThread::instance().invoke([this, slot, action]() {
+        m_nativeActions[slot] = action;
+        });
+}
+
+QString HotkeyManager::statsString() const
+{
+    QStringList lines;
+    lines << QString("registered=%1 slots=%2").arg(m_hotkeyIds.size()).arg(m_slots.size());
+    for (const Slot& slot : m_slots) {
+        if (slot.id.isEmpty()) {
+            continue;
+        }
+        lines << QString("%1 (%2): triggered=%3 latency=%4us max=%5us")
+            .arg(slot.id, slot.sequence.toString())
+            .arg(slot.triggered).arg(slot.lastLatencyNs / 1000).arg(slot.maxLatencyNs / 1000);
+    }
+    return lines.join('\n');
 }
\ No newline at end of file
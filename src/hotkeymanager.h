@@ -5,6 +5,10 @@
 #include <QKeySequence>
 #include <QSettings>
 #include <windows.h>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "nativemessagethread.h"
 
 class HotkeyManager : public QObject
 {
@@ -13,6 +17,9 @@ class HotkeyManager : public QObject
 public:
     static HotkeyManager& instance();
 
+    // 热键动作，参数为按下热键时的前台窗口
+    using Action = std::function<void(HWND foreground)>;
+
     // 注册热键
     bool registerHotkey(const QString& id, const QKeySequence& keySequence);
 
@@ -35,8 +42,20 @@ public:
     // 获取所有已注册的热键
     QHash<QString, QKeySequence> getAllHotkeys() const;
 
+    // 为热键绑定在 GUI 线程执行的动作；已注册的热键立即生效，否则在注册时生效。
+    // 触发时按热键 ID 直接下标取出动作调用，没有绑定动作的热键发出 hotkeyTriggered。
+    // 动作里不要注销或重新注册触发它的热键
+    void setAction(const QString& id, Action action);
+
+    // 热键按下时直接在原生消息线程上执行的动作，先于 setAction 绑定的动作。
+    // 只做不依赖 GUI 状态的系统调用，必须线程安全
+    void setImmediateAction(const QString& id, Action action);
+
+    QString statsString() const;
+
 signals:
-    void hotkeyTriggered(const QString& id);
+    // foreground 为热键按下时的前台窗口，不受 GUI 线程处理延迟影响
+    void hotkeyTriggered(const QString& id, HWND foreground);
 
 private:
     HotkeyManager(QObject* parent = nullptr);
@@ -45,15 +64,34 @@ private:
     static LRESULT CALLBACK hotkeyWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
     bool createHotkeyWindow();
+    bool createHotkeyWindowOnThread();
     void destroyHotkeyWindow();
 
+    // 已注册热键的槽位，下标 = 热键 ID - BASE_HOTKEY_ID
+    struct Slot {
+        QString id;                 // 为空表示空闲
+        QKeySequence sequence;
+        Action action;
+        quint64 triggered = 0;
+        qint64 lastLatencyNs = 0;   // 从收到 WM_HOTKEY 到动作完成
+        qint64 maxLatencyNs = 0;
+    };
+
+    int allocateSlot();
+    void dispatch(const NativeMessageThread::Event& event);
+
 private:
     HWND m_hotkeyWindow = nullptr;
-    QHash<QString, int> m_hotkeyIds;  // id -> hotkey id
-    QHash<int, QString> m_idToHotkey; // hotkey id -> id
-    QHash<QString, QKeySequence> m_hotkeys; // id -> key sequence
+    // 释放的槽位优先复用，保持紧凑；触发路径只做下标访问，不查表也不分配内存
+    std::deque<Slot> m_slots;
+    std::vector<int> m_freeSlots;
+    QHash<QString, int> m_hotkeyIds;            // id -> hotkey id
+    QHash<QString, Action> m_actions;           // id -> GUI 线程动作
+    QHash<QString, Action> m_immediateActions;  // id -> 消息线程动作
+
+    // 只在原生消息线程上访问，下标与 m_slots 相同
+    std::vector<Action> m_nativeActions;
 
     static HotkeyManager* s_instance;
     static const int BASE_HOTKEY_ID = 1000;
-    int m_nextHotkeyId = BASE_HOTKEY_ID;
 };
\ No newline at end of file
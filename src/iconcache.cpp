@@ -0,0 +1,310 @@
+#include "iconcache.h"
+#include "processinfocache.h"
+#include "diagnostics.h"
+#include "windowquery.h"
+#include <QImage>
+#include <QPixmap>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVector>
+#include <algorithm>
+
+IconCache& IconCache::instance()
+{
+    static IconCache inst;
+    return inst;
+}
+
+IconCache::IconCache()
+{
+    m_icons.setMaxCost(DefaultCapacityKB);
+    m_byContent.setMaxCost(DefaultCapacityKB);
+
+    Diagnostics::instance().registerSource("Icon cache", [this]() {
+        return statsString();
+        });
+}
+
+void IconCache::setCapacity(int kilobytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_icons.setMaxCost(kilobytes);
+    m_byContent.setMaxCost(kilobytes);
+}
+
+quint64 IconCache::resolve(HWND hwnd, DWORD processId)
+{
+    if (!hwnd) {
+        return 0;
+    }
+
+    // 窗口/窗口类提供的图标由系统持有，按 (句柄, 所属进程) 分配键
+    // WM_GETICON 带超时发送，无响应的窗口会跳到类图标和可执行文件图标
+    HICON hIcon = WindowQuery::instance().windowIcon(hwnd, ICON_SMALL);
+    if (!hIcon) {
+        hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
+    }
+    if (!hIcon) {
+        hIcon = WindowQuery::instance().windowIcon(hwnd, ICON_BIG);
+    }
+    if (!hIcon) {
+        hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICON);
+    }
+    if (hIcon) {
+        return handleKey(hIcon, processId);
+    }
+
+    // 否则使用进程可执行文件的图标
+    if (processId) {
+        QString exePath = ProcessInfoCache::instance().processPath(processId);
+        if (!exePath.isEmpty()) {
+            return pathKey(exePath);
+        }
+    }
+
+    return 0;
+}
+
+quint64 IconCache::handleKey(HICON handle, DWORD processId)
+{
+    // 同一句柄值在别的进程（或同一进程ID的新进程）中是另一个图标
+    const quint64 startTime = processId ? ProcessInfoCache::instance().lookup(processId).startTime : 0;
+    const HandleIdentity identity{ handle, processId, startTime };
+
+    quint64 key;
+    bool prune;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_handleKeys.find(identity);
+        if (it != m_handleKeys.end()) {
+            touchLocked(it->second);
+            return it->second;
+        }
+
+        IconSource source;
+        source.handle = handle;
+        source.processId = processId;
+        source.startTime = startTime;
+        key = addSourceLocked(source);
+        m_handleKeys.emplace(identity, key);
+        prune = m_sources.size() > MaxSources;
+    }
+
+    if (prune) {
+        pruneSources();
+    }
+    return key;
+}
+
+quint64 IconCache::pathKey(const QString& exePath)
+{
+    quint64 key;
+    bool prune;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pathKeys.constFind(exePath);
+        if (it != m_pathKeys.constEnd()) {
+            touchLocked(*it);
+            return *it;
+        }
+
+        IconSource source;
+        source.exePath = exePath;
+        key = addSourceLocked(source);
+        m_pathKeys.insert(exePath, key);
+        prune = m_sources.size() > MaxSources;
+    }
+
+    if (prune) {
+        pruneSources();
+    }
+    return key;
+}
+
+quint64 IconCache::addSourceLocked(const IconSource& source)
+{
+    const quint64 key = ++m_lastKey;
+    m_sources.insert(key, SourceEntry{ source, ++m_useClock });
+    return key;
+}
+
+void IconCache::touchLocked(quint64 key)
+{
+    auto it = m_sources.find(key);
+    if (it != m_sources.end()) {
+        it->lastUsed = ++m_useClock;
+    }
+}
+
+void IconCache::removeSourceLocked(quint64 key)
+{
+    auto it = m_sources.find(key);
+    if (it == m_sources.end()) {
+        return;
+    }
+    const IconSource& source = it->source;
+    if (source.handle) {
+        m_handleKeys.erase(HandleIdentity{ source.handle, source.processId, source.startTime });
+    }
+    else {
+        m_pathKeys.remove(source.exePath);
+    }
+    m_icons.remove(key);
+    m_sources.erase(it);
+    ++m_stats.prunedSources;
+}
+
+void IconCache::pruneSources()
+{
+    // 所属进程已退出（或进程ID已被复用）的句柄来源再也不会被读取
+    QVector<QPair<quint64, IconSource>> handles;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_sources.constBegin(); it != m_sources.constEnd(); ++it) {
+            if (it->source.handle && it->source.processId) {
+                handles.append(qMakePair(it.key(), it->source));
+            }
+        }
+    }
+
+    QVector<quint64> dead;
+    for (const auto& handle : handles) {
+        if (ProcessInfoCache::instance().lookup(handle.second.processId).startTime != handle.second.startTime) {
+            dead.append(handle.first);
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (quint64 key : dead) {
+        removeSourceLocked(key);
+    }
+
+    // 仍然过多（例如进程不断更换角标图标）时淘汰最久未用的，留出四分之一的余量
+    const int target = MaxSources * 3 / 4;
+    if (m_sources.size() <= target) {
+        return;
+    }
+    QVector<QPair<quint64, quint64>> byUse;   // 最近使用 -> 键
+    byUse.reserve(m_sources.size());
+    for (auto it = m_sources.constBegin(); it != m_sources.constEnd(); ++it) {
+        byUse.append(qMakePair(it->lastUsed, it.key()));
+    }
+    const int excess = int(byUse.size()) - target;
+    std::nth_element(byUse.begin(), byUse.begin() + excess, byUse.end());
+    for (int i = 0; i < excess; ++i) {
+        removeSourceLocked(byUse[i].second);
+    }
+}
+
+QImage IconCache::loadImage(quint64 key)
+{
+    IconSource source;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_sources.constFind(key);
+        if (it == m_sources.constEnd()) {
+            return QImage();
+        }
+        source = it->source;
+    }
+
+    if (source.handle) {
+        // 键可能在很久之后才被转换（例如隐藏窗口），所属进程已退出时句柄可能已被回收
+        if (source.processId
+            && ProcessInfoCache::instance().lookup(source.processId).startTime != source.startTime) {
+            return QImage();
+        }
+        return QImage::fromHICON(source.handle);
+    }
+
+    const QString& exePath = source.exePath;
+    if (exePath.isEmpty()) {
+        return QImage();
+    }
+
+    // 自行提取的图标需要销毁
+    QImage image;
+    HICON hIcon = ExtractIcon(GetModuleHandle(NULL), exePath.toStdWString().c_str(), 0);
+    if (hIcon && hIcon != reinterpret_cast<HICON>(1)) {
+        image = QImage::fromHICON(hIcon);
+        DestroyIcon(hIcon);
+    }
+    return image;
+}
+
+template <typename Key>
+void IconCache::insertCounted(QCache<Key, QIcon>& cache, const Key& key, const QIcon& icon, int cost)
+{
+    // 替换已有的键不算淘汰
+    int before = cache.size() - (cache.contains(key) ? 1 : 0);
+    cache.insert(key, new QIcon(icon), cost);
+    int evicted = before + 1 - cache.size();
+    if (evicted > 0) {
+        m_stats.evictions += evicted;
+    }
+}
+
+QIcon IconCache::icon(quint64 key)
+{
+    if (!key) {
+        return QIcon();
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        touchLocked(key);
+        if (QIcon* cached = m_icons.object(key)) {
+            ++m_stats.hits;
+            return *cached;
+        }
+        ++m_stats.misses;
+    }
+
+    QImage image = loadImage(key);
+    if (image.isNull()) {
+        return QIcon();
+    }
+
+    int cost = qMax(1, int(image.sizeInBytes() / 1024));
+    quint64 contentHash = qHashBits(image.constBits(), size_t(image.sizeInBytes()),
+        size_t(image.width()) << 16 | size_t(image.height()));
+
+    QMutexLocker locker(&m_mutex);
+
+    // 内容相同的图标共享同一个像素图
+    QIcon result;
+    if (QIcon* shared = m_byContent.object(contentHash)) {
+        result = *shared;
+        ++m_stats.shared;
+    }
+    else {
+        result = QIcon(QPixmap::fromImage(image));
+        insertCounted(m_byContent, contentHash, result, cost);
+    }
+
+    insertCounted(m_icons, key, result, cost);
+    return result;
+}
+
+QIcon IconCache::iconForWindow(HWND hwnd, DWORD processId)
+{
+    return icon(resolve(hwnd, processId));
+}
+
+IconCache::Stats IconCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats result = m_stats;
+    result.entries = m_icons.size();
+    result.costKB = m_icons.totalCost();
+    result.sources = m_sources.size();
+    return result;
+}
+
+QString IconCache::statsString() const
+{
+    Stats s = stats();
+    return QString("entries=%1 size=%2KB hits=%3 misses=%4 shared=%5 evictions=%6 sources=%7 pruned sources=%8")
+        .arg(s.entries).arg(s.costKB).arg(s.hits).arg(s.misses).arg(s.shared).arg(s.evictions)
+        .arg(s.sources).arg(s.prunedSources);
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QIcon>
+#include <QMutex>
+#include <QString>
+#include <unordered_map>
+#include <windows.h>
+
+// 窗口图标缓存
+// 每个不同的图标（按图标句柄或可执行文件路径区分）只转换一次，
+// 内容相同的图标共享同一个 QIcon，按 LRU 淘汰。
+// 图标句柄会被系统回收复用，因此句柄图标的键同时包含所属进程的 (进程ID, 启动时间)：
+// 进程退出后句柄可能已属于别的图标，此时不再读取该句柄。
+// 图标键是缓存分配的编号，不是句柄值本身。
+// 来源表也有上限：超过 MaxSources 时先清理所属进程已退出的句柄来源，仍然过多则按最近使用淘汰，
+// 被清理的键之后取不到图标（调用方显示默认图标），窗口下次 resolve 时分配新键
+class IconCache
+{
+public:
+    static IconCache& instance();
+
+    // 查找窗口使用的图标键，不做任何转换；没有图标时返回 0
+    quint64 resolve(HWND hwnd, DWORD processId);
+
+    // 根据图标键获取 QIcon，必须在 GUI 线程调用
+    QIcon icon(quint64 key);
+
+    // 便捷接口：resolve + icon
+    QIcon iconForWindow(HWND hwnd, DWORD processId);
+
+    // 缓存容量（KB）
+    void setCapacity(int kilobytes);
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 shared = 0;       // 转换后与已有图标内容相同
+        quint64 evictions = 0;
+        quint64 prunedSources = 0;
+        int entries = 0;
+        int costKB = 0;
+        int sources = 0;
+    };
+    Stats stats() const;
+    QString statsString() const;
+
+private:
+    IconCache();
+
+    static constexpr int DefaultCapacityKB = 4096;
+    static constexpr int MaxSources = 2048;
+
+    // 图标来源：句柄 + 所属进程，或可执行文件路径（handle 为空）
+    struct IconSource {
+        HICON handle = nullptr;
+        DWORD processId = 0;
+        quint64 startTime = 0;
+        QString exePath;
+    };
+
+    struct SourceEntry {
+        IconSource source;
+        quint64 lastUsed = 0;
+    };
+
+    struct HandleIdentity {
+        HICON handle;
+        DWORD processId;
+        quint64 startTime;
+        bool operator==(const HandleIdentity& other) const
+        {
+            return handle == other.handle && processId == other.processId && startTime == other.startTime;
+        }
+    };
+    struct HandleIdentityHash {
+        size_t operator()(const HandleIdentity& id) const
+        {
+            quint64 h = quint64(reinterpret_cast<quintptr>(id.handle)) * 0x9E3779B97F4A7C15ull;
+            h ^= (quint64(id.processId) << 32 | (id.startTime & 0xFFFFFFFFull)) + (h << 6) + (h >> 2);
+            h ^= (id.startTime >> 32) * 0xC2B2AE3D27D4EB4Full;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    quint64 handleKey(HICON handle, DWORD processId);
+    quint64 pathKey(const QString& exePath);
+    QImage loadImage(quint64 key);
+
+    // 调用方需持有锁
+    quint64 addSourceLocked(const IconSource& source);
+    void touchLocked(quint64 key);
+    void removeSourceLocked(quint64 key);
+
+    // 来源表超过上限时调用，不能持有锁（需要查询进程信息）
+    void pruneSources();
+
+    template <typename Key>
+    void insertCounted(QCache<Key, QIcon>& cache, const Key& key, const QIcon& icon, int cost);
+
+    mutable QMutex m_mutex;
+    QCache<quint64, QIcon> m_icons;      // 图标键 -> 图标
+    QCache<quint64, QIcon> m_byContent;  // 图像内容哈希 -> 图标
+    // 图标键 -> 来源，键从 1 开始递增、不复用
+    QHash<quint64, SourceEntry> m_sources;
+    std::unordered_map<HandleIdentity, quint64, HandleIdentityHash> m_handleKeys;
+    QHash<QString, quint64> m_pathKeys;
+    quint64 m_lastKey = 0;
+    quint64 m_useClock = 0;
+    Stats m_stats;
+};
\ No newline at end of file
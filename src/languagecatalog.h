@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// 二进制语言目录（.langc）格式，构建工具 langc 与 Translator 共用
+// 文件布局：文件头 | 槽位表 | 字符串表（UTF-16LE）
+// 槽位表就是开放寻址（线性探测）的哈希索引，负载因子不超过 1/2（entryCount * 2 <= slotCount），
+// 与运行时翻译表的布局一致。加载时映射文件，槽位按原位置复制、译文按 UTF-16 原样复制，
+// 不需要解析文本或重新插入；复制后立即卸载，查找在复制出的表上进行。整数按小端存储。
+namespace LanguageCatalog {
+
+constexpr uint32_t Magic = 0x4C584E54;   // "TNXL"
+constexpr uint32_t Version = 1;
+constexpr const char* FileSuffix = ".langc";
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;       // 2 的幂
+    uint32_t stringsOffset;   // 字符串表相对文件开头的字节偏移，按 8 字节对齐
+    uint32_t stringsSize;     // 字符串表字节数
+};
+
+struct Slot {
+    uint64_t key;             // 0 表示空槽位
+    uint32_t offset;          // 字符串表内的 UTF-16 码元偏移
+    uint32_t length;          // UTF-16 码元数
+};
+
+static_assert(sizeof(Header) == 24, "unexpected catalog header size");
+static_assert(sizeof(Slot) == 16, "unexpected catalog slot size");
+
+// "上下文|原文"（UTF-8）的 64 位 FNV-1a 哈希，0 保留给空槽位
+constexpr uint64_t hashKey(const char* context, const char* source)
+{
+    constexpr uint64_t FnvOffset = 14695981039346656037ull;
+    constexpr uint64_t FnvPrime = 1099511628211ull;
+
+    uint64_t hash = FnvOffset;
+    for (const char* p = context; *p; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * FnvPrime;
+    }
+    hash = (hash ^ static_cast<unsigned char>('|')) * FnvPrime;
+    for (const char* p = source; *p; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * FnvPrime;
+    }
+    return hash ? hash : 1;
+}
+
+} // namespace LanguageCatalog
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <QDir>
 #include "mainwindow.h"
 #include "windowstraymanager.h"
+#include "nativemessagethread.h"
 
 int main(int argc, char* argv[])
 {
@@ -37,8 +38,18 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    // 创建主窗口
-    MainWindow w;
+    int result;
+    {
+        // 创建主窗口
+        MainWindow w;
 
-    return app.exec();
+        result = app.exec();
+
+        // 主窗口在这里析构：不经过 closeApp 的退出（例如会话结束）也由它调用
+        // WindowsTrayManager::shutdown()，此时消息线程仍在运行，托盘窗口在其所属线程中销毁
+    }
+
+    // 托盘和热键窗口都已销毁，最后停止消息线程
+    NativeMessageThread::instance().stopThread();
+    return result;
 }
\ No newline at end of file
@@ -4,6 +4,19 @@
 #include "translator.h"
 #include "hotkeymanager.h"
 #include "volumecontrol.h"
+#include "windowsnapshot.h"
+#include "windowbackend.h"
+#include "windoweventsource.h"
+#include "processinfocache.h"
+#include "diagnostics.h"
+#include "windowtablemodel.h"
+#include "windowfilter.h"
+#include "refreshscheduler.h"
+#include "sessionmonitor.h"
+#include "uiinvalidator.h"
+#include "traywindowmenu.h"
+#include "translationbinder.h"
+#include "settingsstore.h"
 
 #include <QApplication>
 #include <QStyle>
@@ -29,10 +42,54 @@
 #include <QWidgetAction>
 #include <QProcess>
 #include <QFileInfo>
+#include <QPointer>
+#include <QSortFilterProxyModel>
 
 #include <psapi.h>
 #include <shellapi.h>
 
+// trc("上下文", "原文") 展开为按编译期哈希查找，调用处写法不变
+#define trc(context, source) trc(TRANSLATION_KEY(context, source), source)
+// trBind(对象, 设置函数或 lambda, "上下文", "原文") 登记可翻译属性，切换语言时自动更新
+#define trBind(target, apply, context, source) m_translations->bind(target, apply, TRANSLATION_KEY(context, source), source)
+
+namespace {
+
+// 可绑定热键的动作，配置键为 Hotkeys/<id>，默认值为空的动作不注册
+struct HotkeyActionDef {
+    const char* id;
+    const char* defaultSequence;
+};
+
+const HotkeyActionDef HotkeyActions[] = {
+    { "minimize_active", "Win+Shift+Z" },
+    { "restore_last", "" },
+    { "restore_recent", "" },
+    { "restore_all", "" },
+    { "show_window", "" },
+    { "toggle_main_window", "" },
+    { "toggle_mute", "" },
+    { "toggle_on_top", "" },
+    { "opacity_up", "" },
+    { "opacity_down", "" },
+};
+
+// 透明度热键每次调整的百分比
+const int OpacityStepPercent = 10;
+
+// 配置项（config.ini）
+const Setting<bool> HotkeyEnabledSetting{ "hotkey/enabled", true };
+const Setting<int> MaxHiddenSetting{ "window/max_hidden", 50 };
+const Setting<int> MenuEntriesSetting{ "window/menu_entries", TrayWindowMenu::DefaultTopLevelCap };
+const Setting<int> RestoreCountSetting{ "window/restore_count", 3 };
+const Setting<bool> AlwaysOnTopSetting{ "window/always_on_top", false };
+const Setting<bool> StartWithSystemSetting{ "general/start_with_system", false };
+const Setting<QString> LanguageSetting{ "general/language", "zh" };
+const Setting<bool> AutoRefreshSetting{ "refresh/auto_refresh", true };
+const Setting<int> RefreshIntervalSetting{ "refresh/interval", 500 };
+
+} // namespace
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , trayIcon(nullptr)
@@ -40,29 +97,58 @@ MainWindow::MainWindow(QWidget* parent)
     , showAction(nullptr)
     , restoreAllAction(nullptr)
     , quitAction(nullptr)
-    , refreshTimer(nullptr)
+    , m_refreshScheduler(nullptr)
+    , m_invalidator(nullptr)
+    , m_trayWindowMenu(nullptr)
     , hiddenTableContextMenu(nullptr)
     , restoreHiddenAction(nullptr)
     , restoreLastHiddenAction(nullptr)
     , restoreAllHiddenAction(nullptr)
     , hideToAppTrayAction(nullptr)
     , restoreLastAction(nullptr)
+    , restoreRecentAction(nullptr)
 {
+    // 各区域只标记失效，每轮事件循环最多刷新一次
+    m_invalidator = new UiInvalidator(this);
+    m_invalidator->setHandler(UiInvalidator::WindowTable, [this]() { refreshWindowsTable(); });
+    m_invalidator->setHandler(UiInvalidator::HiddenTable, [this]() { refreshHiddenWindowsTable(); });
+    m_invalidator->setHandler(UiInvalidator::TrayMenu, [this]() { updateTrayMenuState(); });
+
+    // 设置只在内存中读写，安静一段时间后由后台线程合并写盘
+    m_settings = new SettingsStore(getConfigPath(), this);
+
+    // 可翻译文本在创建控件时登记，切换语言时统一更新
+    m_translations = new TranslationBinder(this);
+
     // 创建 UI
     setupUI();
     setupConnections();
 
     setupHotkeys();
 
+    // 每次（批量）隐藏/恢复只收到一次通知
     connect(&WindowsTrayManager::instance(), &WindowsTrayManager::trayWindowsChanged,
-        this, &MainWindow::updateTrayMenu);
-    connect(&WindowsTrayManager::instance(), &WindowsTrayManager::trayWindowsChanged,
-        this, &MainWindow::refreshAllLists);
+        this, &MainWindow::onTrayWindowsChanged);
 
-    // 创建定时器
-    refreshTimer = new QTimer(this);
-    connect(refreshTimer, &QTimer::timeout, this, &MainWindow::refreshWindowsTable);
-    refreshTimer->start(500);
+    // 创建后台窗口快照生产者，由窗口事件增量更新
+    m_snapshotProducer = new WindowSnapshotProducer(std::make_unique<Win32WindowBackend>(), new WinEventHookSource(), this);
+    connect(m_snapshotProducer, &WindowSnapshotProducer::snapshotPublished, this, [this]() {
+        m_invalidator->invalidate(UiInvalidator::WindowTable);
+        });
+
+    // 创建自适应对账调度器，兜底事件遗漏
+    // 对账发现钩子遗漏的变化后保持短间隔，否则逐步退避；锁屏或主窗口隐藏时停止
+    // 钩子已报告的变化不算：那说明事件通道工作正常，不需要频繁对账
+    m_refreshScheduler = new RefreshScheduler(this);
+    connect(m_refreshScheduler, &RefreshScheduler::tick, m_snapshotProducer, &WindowSnapshotProducer::requestReconcile);
+    connect(m_refreshScheduler, &RefreshScheduler::intervalChanged, this, &MainWindow::updateRefreshStatus);
+    connect(m_snapshotProducer, &WindowSnapshotProducer::driftDetected, m_refreshScheduler, &RefreshScheduler::noteChange);
+    connect(&WindowsTrayManager::instance(), &WindowsTrayManager::trayWindowsChanged,
+        m_refreshScheduler, &RefreshScheduler::wake);
+    connect(&SessionMonitor::instance(), &SessionMonitor::lockChanged, this, [this](bool locked) {
+        m_refreshScheduler->setPaused(RefreshScheduler::SessionLocked, locked);
+        });
+    m_refreshScheduler->setPaused(RefreshScheduler::NoConsumers, true);
 
     // 加载设置
     loadSettings();
@@ -70,7 +156,10 @@ MainWindow::MainWindow(QWidget* parent)
     QString language = languageCombo->currentData().toString();
     loadLanguage(language);
 
-    setWindowTitle("Traynex");
+    // 语言文件被修改后在后台重新加载，发布后刷新界面文本
+    connect(&Translator::instance(), &Translator::languageReloaded, this, &MainWindow::retranslateUI);
+
+    trBind(this, &QWidget::setWindowTitle, "MainWindow", "Traynex");
     resize(800, 600);
 
     // 初始化 Windows 原生托盘管理器
@@ -82,6 +171,14 @@ MainWindow::MainWindow(QWidget* parent)
     // 创建 Qt 托盘
     createTrayIcon();
 
+    // 恢复上次隐藏到应用托盘菜单的窗口
+    {
+        WindowsTrayManager::Batch batch;
+        for (HWND hwnd : WindowsTrayManager::instance().savedAppTrayWindows()) {
+            addWindowToTrayMenu(hwnd);
+        }
+    }
+
     // 初始隐藏主窗口
     hide();
 
@@ -90,8 +187,14 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow()
 {
+    // 退出前写入尚未保存的设置
+    m_settings->flush();
     WindowsTrayManager::instance().shutdown();
-    setupHotkeys();
+
+    // 热键管理器是单例，比主窗口活得久，解除绑定到本窗口的动作
+    for (const HotkeyActionDef& action : HotkeyActions) {
+        HotkeyManager::instance().setAction(action.id, nullptr);
+    }
 }
 
 void MainWindow::setupUI()
@@ -109,8 +212,14 @@ void MainWindow::setupUI()
     QHBoxLayout* headerLayout = new QHBoxLayout();
     headerLayout->addStretch();
 
-    // 创建表格
-    windowsTable = new QTableWidget();
+    // 创建表格（模型按窗口句柄增量更新，代理模型负责排序）
+    windowsModel = new WindowTableModel(this);
+    QSortFilterProxyModel* windowsProxy = new QSortFilterProxyModel(this);
+    windowsProxy->setSourceModel(windowsModel);
+    windowsProxy->setSortRole(WindowTableModel::SortRole);
+
+    windowsTable = new QTableView();
+    windowsTable->setModel(windowsProxy);
 
     // 移除边框、网格线和行号
     windowsTable->setFrameShape(QFrame::NoFrame);
@@ -122,15 +231,7 @@ void MainWindow::setupUI()
     windowsTable->setProperty("wordWrap", false);
 
     // 表头设置
-    windowsTable->setColumnCount(6);
-    windowsTable->setHorizontalHeaderLabels({
-        "",
-        trc("MainWindow", "Window Title"),
-        trc("MainWindow", "Handle"),
-        trc("MainWindow", "Class"),
-        trc("MainWindow", "Process ID"),
-        trc("MainWindow", "Process")
-        });
+    m_translations->bindComputed(windowsModel, [this]() { windowsModel->setHeaderLabels(tableHeaderLabels()); });
     windowsTable->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft | Qt::AlignVCenter); // 标题左对齐
 
     // 表格属性
@@ -142,10 +243,10 @@ void MainWindow::setupUI()
 
     // QSS 样式
     windowsTable->setStyleSheet(
-        "QTableWidget {"
+        "QTableView {"
         "    border: none;"
         "}"
-        "QTableWidget::item:selected {"
+        "QTableView::item:selected {"
         "    font-weight: normal;"
         "}"
     );
@@ -172,7 +273,7 @@ void MainWindow::setupUI()
     createContextMenu();
 
     // 连接信号
-    connect(windowsTable, &QTableWidget::customContextMenuRequested,
+    connect(windowsTable, &QTableView::customContextMenuRequested,
         this, &MainWindow::onTableContextMenu);
 
     // === 隐藏窗口页面 ===
@@ -180,7 +281,13 @@ void MainWindow::setupUI()
     QVBoxLayout* hiddenLayout = new QVBoxLayout(hiddenTab);
 
     // 创建隐藏窗口表格
-    hiddenWindowsTable = new QTableWidget();
+    hiddenWindowsModel = new WindowTableModel(this);
+    QSortFilterProxyModel* hiddenWindowsProxy = new QSortFilterProxyModel(this);
+    hiddenWindowsProxy->setSourceModel(hiddenWindowsModel);
+    hiddenWindowsProxy->setSortRole(WindowTableModel::SortRole);
+
+    hiddenWindowsTable = new QTableView();
+    hiddenWindowsTable->setModel(hiddenWindowsProxy);
 
     // 移除边框、网格线和行号
     hiddenWindowsTable->setFrameShape(QFrame::NoFrame);
@@ -191,15 +298,9 @@ void MainWindow::setupUI()
     hiddenWindowsTable->setTextElideMode(Qt::ElideRight);
 
     // 表头设置
-    hiddenWindowsTable->setColumnCount(6);
-    hiddenWindowsTable->setHorizontalHeaderLabels({
-        "",
-        trc("MainWindow", "Window Title"),
-        trc("MainWindow", "Handle"),
-        trc("MainWindow", "Class"),
-        trc("MainWindow", "Process ID"),
-        trc("MainWindow", "Process")
-        });
+    m_translations->bindComputed(hiddenWindowsModel, [this]() { hiddenWindowsModel->setHeaderLabels(tableHeaderLabels()); });
+    // 没有标题的行在刷新时填入译文，切换语言后重新生成这张表
+    m_translations->bindComputed(hiddenWindowsModel, [this]() { m_invalidator->invalidate(UiInvalidator::HiddenTable); });
     hiddenWindowsTable->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft | Qt::AlignVCenter); // 标题左对齐
 
     // 表格属性
@@ -211,10 +312,10 @@ void MainWindow::setupUI()
 
     // QSS 样式
     hiddenWindowsTable->setStyleSheet(
-        "QTableWidget {"
+        "QTableView {"
         "    border: none;"
         "}"
-        "QTableWidget::item:selected {"
+        "QTableView::item:selected {"
         "    font-weight: normal;"
         "}"
     );
@@ -236,7 +337,7 @@ void MainWindow::setupUI()
     hiddenLayout->addWidget(hiddenWindowsTable);
 
     // 连接信号
-    connect(hiddenWindowsTable, &QTableWidget::customContextMenuRequested,
+    connect(hiddenWindowsTable, &QTableView::customContextMenuRequested,
         this, &MainWindow::onHiddenTableContextMenu);
 
     // === 设置页面 ===
@@ -244,76 +345,98 @@ void MainWindow::setupUI()
     QVBoxLayout* settingsLayout = new QVBoxLayout(settingsTab);
 
     // 常规设置
-    QGroupBox* generalGroup = new QGroupBox(trc("MainWindow", "General Settings"));
-    generalGroup->setObjectName("generalGroup");
+    QGroupBox* generalGroup = new QGroupBox();
+    trBind(generalGroup, &QGroupBox::setTitle, "MainWindow", "General Settings");
     QVBoxLayout* generalLayout = new QVBoxLayout(generalGroup);
 
-    startWithSystemCheck = new QCheckBox(trc("MainWindow", "Start with Windows"));
-    enableHotkeyCheck = new QCheckBox(trc("MainWindow", "Enable Hotkey"));
+    startWithSystemCheck = new QCheckBox();
+    trBind(startWithSystemCheck, &QCheckBox::setText, "MainWindow", "Start with Windows");
+    enableHotkeyCheck = new QCheckBox();
+    trBind(enableHotkeyCheck, &QCheckBox::setText, "MainWindow", "Enable Hotkey");
     enableHotkeyCheck->setChecked(true);
 
-    alwaysOnTopCheck = new QCheckBox(trc("MainWindow", "Always on Top"));
-    alwaysOnTopCheck->setToolTip(trc("MainWindow", "Keep the main window always on top of other windows"));
+    alwaysOnTopCheck = new QCheckBox();
+    trBind(alwaysOnTopCheck, &QCheckBox::setText, "MainWindow", "Always on Top");
+    trBind(alwaysOnTopCheck, &QWidget::setToolTip, "MainWindow", "Keep the main window always on top of other windows");
 
     generalLayout->addWidget(startWithSystemCheck);
     generalLayout->addWidget(enableHotkeyCheck);
     generalLayout->addWidget(alwaysOnTopCheck);
 
     // 自动刷新设置
-    QGroupBox* refreshGroup = new QGroupBox(trc("MainWindow", "Auto Refresh Settings"));
-    refreshGroup->setObjectName("refreshGroup");
+    QGroupBox* refreshGroup = new QGroupBox();
+    trBind(refreshGroup, &QGroupBox::setTitle, "MainWindow", "Auto Refresh Settings");
     QFormLayout* refreshLayout = new QFormLayout(refreshGroup);
 
     refreshIntervalSpin = new QSpinBox();
     refreshIntervalSpin->setRange(100, 1000);
     refreshIntervalSpin->setValue(500);
-    refreshIntervalSpin->setSuffix(trc("MainWindow", "ms"));
+    trBind(refreshIntervalSpin, &QSpinBox::setSuffix, "MainWindow", "ms");
 
-    autoRefreshCheck = new QCheckBox(trc("MainWindow", "Enable auto refresh"));
+    autoRefreshCheck = new QCheckBox();
+    trBind(autoRefreshCheck, &QCheckBox::setText, "MainWindow", "Enable auto refresh");
     autoRefreshCheck->setChecked(true);
 
-    // 创建刷新间隔标签并设置对象名称
-    QLabel* refreshIntervalLabel = new QLabel(trc("MainWindow", "Refresh interval:"));
-    refreshIntervalLabel->setObjectName("refreshIntervalLabel");
+    QLabel* refreshIntervalLabel = new QLabel();
+    trBind(refreshIntervalLabel, &QLabel::setText, "MainWindow", "Refresh interval:");
+
+    // 当前实际使用的刷新间隔
+    QLabel* currentIntervalLabel = new QLabel();
+    trBind(currentIntervalLabel, &QLabel::setText, "MainWindow", "Current interval:");
+    refreshStatusLabel = new QLabel();
 
     refreshLayout->addRow(autoRefreshCheck);
     refreshLayout->addRow(refreshIntervalLabel, refreshIntervalSpin);
+    refreshLayout->addRow(currentIntervalLabel, refreshStatusLabel);
 
     // 窗口设置
-    QGroupBox* windowGroup = new QGroupBox(trc("MainWindow", "Window Settings"));
-    windowGroup->setObjectName("windowGroup"); // 设置对象名称
+    QGroupBox* windowGroup = new QGroupBox();
+    trBind(windowGroup, &QGroupBox::setTitle, "MainWindow", "Window Settings");
     QFormLayout* windowLayout = new QFormLayout(windowGroup);
 
     maxWindowsSpin = new QSpinBox();
-    maxWindowsSpin->setRange(1, 100);
+    maxWindowsSpin->setRange(1, HiddenWindowRegistry::MaxSlots);
     maxWindowsSpin->setValue(50);
-    maxWindowsSpin->setSuffix(trc("MainWindow", " windows"));
+    trBind(maxWindowsSpin, &QSpinBox::setSuffix, "MainWindow", " windows");
+
+    // 托盘菜单顶层显示的最近隐藏窗口数，其余按进程分组
+    menuEntriesSpin = new QSpinBox();
+    menuEntriesSpin->setRange(1, 100);
+    menuEntriesSpin->setValue(TrayWindowMenu::DefaultTopLevelCap);
+    trBind(menuEntriesSpin, &QSpinBox::setSuffix, "MainWindow", " windows");
+
+    // "恢复最近 N 个窗口"一次恢复的数量
+    restoreCountSpin = new QSpinBox();
+    restoreCountSpin->setRange(1, 50);
+    restoreCountSpin->setValue(3);
+    trBind(restoreCountSpin, &QSpinBox::setSuffix, "MainWindow", " windows");
 
     languageCombo = new QComboBox();
     languageCombo->addItem("English", "en");
     languageCombo->addItem("中文", "zh");
 
     // 热键设置组
-    QGroupBox* hotkeyGroup = new QGroupBox(trc("MainWindow", "Hotkey Settings"));
-    hotkeyGroup->setObjectName("hotkeyGroup");
+    QGroupBox* hotkeyGroup = new QGroupBox();
+    trBind(hotkeyGroup, &QGroupBox::setTitle, "MainWindow", "Hotkey Settings");
     QFormLayout* hotkeyLayout = new QFormLayout(hotkeyGroup);
 
     // 最小化热键设置
     minimizeHotkeyEdit = new QLineEdit();
-    minimizeHotkeyEdit->setPlaceholderText(trc("MainWindow", "Click to set hotkey"));
+    trBind(minimizeHotkeyEdit, &QLineEdit::setPlaceholderText, "MainWindow", "Click to set hotkey");
     minimizeHotkeyEdit->setReadOnly(true);
 
-    setMinimizeHotkeyButton = new QPushButton(trc("MainWindow", "Set Hotkey"));
-    QPushButton* clearMinimizeHotkeyButton = new QPushButton(trc("MainWindow", "Clear"));
-    clearMinimizeHotkeyButton->setObjectName("clearMinimizeHotkeyButton");
+    setMinimizeHotkeyButton = new QPushButton();
+    trBind(setMinimizeHotkeyButton, &QPushButton::setText, "MainWindow", "Set Hotkey");
+    QPushButton* clearMinimizeHotkeyButton = new QPushButton();
+    trBind(clearMinimizeHotkeyButton, &QPushButton::setText, "MainWindow", "Clear");
 
     QHBoxLayout* minimizeHotkeyLayout = new QHBoxLayout();
     minimizeHotkeyLayout->addWidget(minimizeHotkeyEdit);
     minimizeHotkeyLayout->addWidget(setMinimizeHotkeyButton);
     minimizeHotkeyLayout->addWidget(clearMinimizeHotkeyButton);
 
-    QLabel* minimizeHotkeyLabel = new QLabel(trc("MainWindow", "Minimize to Tray Icon:"));
-    minimizeHotkeyLabel->setObjectName("minimizeHotkeyLabel");
+    QLabel* minimizeHotkeyLabel = new QLabel();
+    trBind(minimizeHotkeyLabel, &QLabel::setText, "MainWindow", "Minimize to Tray Icon:");
 
     hotkeyLayout->addRow(minimizeHotkeyLabel, minimizeHotkeyLayout);
 
@@ -321,14 +444,22 @@ void MainWindow::setupUI()
     connect(setMinimizeHotkeyButton, &QPushButton::clicked, this, &MainWindow::startSetMinimizeHotkey);
     connect(clearMinimizeHotkeyButton, &QPushButton::clicked, this, &MainWindow::clearMinimizeHotkey);
 
-    // 创建表单标签并设置对象名称
-    QLabel* maxWindowsLabel = new QLabel(trc("MainWindow", "Maximum hidden windows:"));
-    maxWindowsLabel->setObjectName("maxWindowsLabel");
+    // 表单标签
+    QLabel* maxWindowsLabel = new QLabel();
+    trBind(maxWindowsLabel, &QLabel::setText, "MainWindow", "Maximum hidden windows:");
+
+    QLabel* menuEntriesLabel = new QLabel();
+    trBind(menuEntriesLabel, &QLabel::setText, "MainWindow", "Tray menu entries:");
+
+    QLabel* restoreCountLabel = new QLabel();
+    trBind(restoreCountLabel, &QLabel::setText, "MainWindow", "Restore last N windows:");
 
-    QLabel* languageLabel = new QLabel(trc("MainWindow", "Language:"));
-    languageLabel->setObjectName("languageLabel");
+    QLabel* languageLabel = new QLabel();
+    trBind(languageLabel, &QLabel::setText, "MainWindow", "Language:");
 
     windowLayout->addRow(maxWindowsLabel, maxWindowsSpin);
+    windowLayout->addRow(menuEntriesLabel, menuEntriesSpin);
+    windowLayout->addRow(restoreCountLabel, restoreCountSpin);
     windowLayout->addRow(languageLabel, languageCombo);
 
     settingsLayout->addWidget(generalGroup);
@@ -345,41 +476,38 @@ void MainWindow::setupUI()
     aboutLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
     aboutLabel->setWordWrap(true);
 
-    QString aboutText = QString(
-        "<h3>%1</h3>"
-        "<p><b>%2:</b> 1.0.0</p>"
-        "<p><b>%3:</b> A powerful window management tool that allows you to minimize windows to system tray.</p>"
-        "<p><b>%4:</b> Win + Shift + Z - Minimize active window to tray</p>"
-        "<p><b>%5:</b> Double-click tray icon to restore window</p>"
-        "<hr>"
-        "<p>%6</p>"
-    ).arg(
-        trc("MainWindow", "Traynex"),
-        trc("MainWindow", "Version"),
-        trc("MainWindow", "Description"),
-        trc("MainWindow", "Hotkey"),
-        trc("MainWindow", "Usage"),
-        trc("MainWindow", "Thank you for using Traynex!")
-    );
+    // 关于文本由多条译文拼成，整体重新生成
+    m_translations->bindComputed(aboutLabel, [this]() { showAbout(); });
+
+    QPushButton* githubButton = new QPushButton();
+    trBind(githubButton, &QPushButton::setText, "MainWindow", "Visit GitHub Repository");
 
-    aboutLabel->setText(aboutText);
+    QPushButton* checkUpdateButton = new QPushButton();
+    trBind(checkUpdateButton, &QPushButton::setText, "MainWindow", "Check for Updates");
 
-    QPushButton* githubButton = new QPushButton(trc("MainWindow", "Visit GitHub Repository"));
-    githubButton->setObjectName("githubButton");
+    // 诊断信息
+    QGroupBox* diagnosticsGroup = new QGroupBox();
+    trBind(diagnosticsGroup, &QGroupBox::setTitle, "MainWindow", "Diagnostics");
+    QVBoxLayout* diagnosticsLayout = new QVBoxLayout(diagnosticsGroup);
 
-    QPushButton* checkUpdateButton = new QPushButton(trc("MainWindow", "Check for Updates"));
-    checkUpdateButton->setObjectName("checkUpdateButton");
+    diagnosticsView = new QPlainTextEdit();
+    diagnosticsView->setReadOnly(true);
+    diagnosticsLayout->addWidget(diagnosticsView);
 
     aboutLayout->addWidget(aboutLabel);
     aboutLayout->addWidget(githubButton);
     aboutLayout->addWidget(checkUpdateButton);
-    aboutLayout->addStretch();
+    aboutLayout->addWidget(diagnosticsGroup);
 
     // 添加标签页
-    tabWidget->addTab(mainTab, trc("MainWindow", "Main"));
-    tabWidget->addTab(hiddenTab, trc("MainWindow", "Hidden Windows"));
-    tabWidget->addTab(settingsTab, trc("MainWindow", "Settings"));
-    tabWidget->addTab(aboutTab, trc("MainWindow", "About"));
+    tabWidget->addTab(mainTab, QString());
+    tabWidget->addTab(hiddenTab, QString());
+    tabWidget->addTab(settingsTab, QString());
+    tabWidget->addTab(aboutTab, QString());
+    trBind(tabWidget, [this](const QString& text) { tabWidget->setTabText(0, text); }, "MainWindow", "Main");
+    trBind(tabWidget, [this](const QString& text) { tabWidget->setTabText(1, text); }, "MainWindow", "Hidden Windows");
+    trBind(tabWidget, [this](const QString& text) { tabWidget->setTabText(2, text); }, "MainWindow", "Settings");
+    trBind(tabWidget, [this](const QString& text) { tabWidget->setTabText(3, text); }, "MainWindow", "About");
 
     // 设置中心布局
     QVBoxLayout* centralLayout = new QVBoxLayout(centralWidget);
@@ -390,6 +518,18 @@ void MainWindow::setupUI()
         QDesktopServices::openUrl(QUrl("https://github.com/new5Fpointer/Traynex"));
         });
     connect(checkUpdateButton, &QPushButton::clicked, this, &MainWindow::showAbout);
+
+    // 切换到关于页面时更新诊断信息
+    connect(tabWidget, &QTabWidget::currentChanged, this, [this, aboutTab](int index) {
+        if (tabWidget->widget(index) == aboutTab) {
+            updateDiagnostics();
+        }
+        });
+}
+
+void MainWindow::updateDiagnostics()
+{
+    diagnosticsView->setPlainText(Diagnostics::instance().report());
 }
 
 void MainWindow::setupConnections()
@@ -399,7 +539,38 @@ void MainWindow::setupConnections()
     connect(languageCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onLanguageChanged);
     connect(startWithSystemCheck, &QCheckBox::stateChanged, this, &MainWindow::onStartWithSystemChanged);
     connect(maxWindowsSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onMaxWindowsChanged);
+    connect(menuEntriesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onMenuEntriesChanged);
+    connect(restoreCountSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onRestoreCountChanged);
     connect(alwaysOnTopCheck, &QCheckBox::stateChanged, this, &MainWindow::onAlwaysOnTopChanged);
+
+    // 每个控件只写自己的配置项：加载设置时逐个设置控件，不会用其他控件的旧值覆盖已保存的值
+    connect(enableHotkeyCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        m_settings->set(HotkeyEnabledSetting, checked);
+        });
+    connect(autoRefreshCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        m_settings->set(AutoRefreshSetting, checked);
+        });
+    connect(refreshIntervalSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_settings->set(RefreshIntervalSetting, value);
+        });
+    connect(languageCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_settings->set(LanguageSetting, languageCombo->itemData(index).toString());
+        });
+    connect(startWithSystemCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        m_settings->set(StartWithSystemSetting, checked);
+        });
+    connect(maxWindowsSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_settings->set(MaxHiddenSetting, value);
+        });
+    connect(menuEntriesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_settings->set(MenuEntriesSetting, value);
+        });
+    connect(restoreCountSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_settings->set(RestoreCountSetting, value);
+        });
+    connect(alwaysOnTopCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        m_settings->set(AlwaysOnTopSetting, checked);
+        });
 }
 
 void MainWindow::restoreSelectedWindow()
@@ -418,11 +589,8 @@ void MainWindow::restoreSelectedWindow()
         return;
     }
 
-    if (WindowsTrayManager::instance().restoreWindow(hwnd)) {
-        refreshAllLists();
-        updateTrayMenu();
-    }
-    else {
+    // 成功时由 trayWindowsChanged 刷新列表和菜单
+    if (!WindowsTrayManager::instance().restoreWindow(hwnd)) {
         QMessageBox::warning(this, trc("MainWindow", "Error"),
             trc("MainWindow", "Failed to restore the window"));
     }
@@ -430,23 +598,28 @@ void MainWindow::restoreSelectedWindow()
 
 void MainWindow::restoreAllWindows()
 {
-    // 恢复系统托盘隐藏的窗口
-    WindowsTrayManager::instance().restoreAllWindows();
+    // 两种托盘的恢复合并为一次日志提交
+    WindowsTrayManager::Batch batch;
 
-    // 恢复应用托盘菜单隐藏的窗口
-    QList<HWND> appTrayWindows = m_appTrayWindows.keys();
+    // 恢复应用托盘菜单隐藏的窗口，只激活最后一个
+    HWND lastAppTrayWindow = nullptr;
+    QList<HWND> appTrayWindows = m_trayWindowMenu->windows();
     for (HWND hwnd : appTrayWindows) {
         if (hwnd && IsWindow(hwnd)) {
             ShowWindow(hwnd, SW_SHOW);
-            SetForegroundWindow(hwnd);
+            lastAppTrayWindow = hwnd;
         }
         removeWindowFromTrayMenu(hwnd);
     }
 
-    m_hiddenWindowOrder.clear();
-
-    refreshAllLists();
-    updateTrayMenu();
+    // 恢复系统托盘隐藏的窗口：一次保存、一次通知
+    if (WindowsTrayManager::instance().restoreAllWindows() == 0) {
+        if (lastAppTrayWindow) {
+            SetForegroundWindow(lastAppTrayWindow);
+        }
+        refreshAllLists();
+        updateTrayMenu();
+    }
 }
 
 void MainWindow::showAbout()
@@ -472,22 +645,22 @@ void MainWindow::showAbout()
     }
 }
 
-QString MainWindow::trc(const char* context, const char* source) const
+void MainWindow::minimizeActiveToTray()
 {
-    return Translator::instance().translate(QString::fromUtf8(context), QString::fromUtf8(source));
+    minimizeToTray(GetForegroundWindow());
 }
 
-void MainWindow::minimizeActiveToTray()
+void MainWindow::minimizeToTray(HWND hwnd)
 {
-    HWND foregroundWindow = GetForegroundWindow();
-    if (foregroundWindow && foregroundWindow != (HWND)winId()) {
-        if (WindowsTrayManager::instance().minimizeWindowToTray(foregroundWindow)) {
-            m_hiddenWindowOrder.removeAll(foregroundWindow);
-            m_hiddenWindowOrder.prepend(foregroundWindow);
+    if (!hwnd || hwnd == (HWND)winId()) {
+        return;
+    }
 
-            refreshAllLists();
-            updateTrayMenu();
-        }
+    // 隐藏顺序和刷新由 trayWindowsChanged 处理
+    WindowsTrayManager& manager = WindowsTrayManager::instance();
+    if (!manager.minimizeWindowToTray(hwnd) && !manager.isHidden(hwnd) && IsWindow(hwnd)) {
+        // 热键已在消息线程上先隐藏了窗口，登记失败（例如数量已满）时重新显示
+        ShowWindow(hwnd, SW_SHOW);
     }
 }
 
@@ -499,10 +672,6 @@ void MainWindow::showWindow()
     raise();
     activateWindow();
     refreshAllLists();
-
-    if (autoRefreshCheck->isChecked() && refreshTimer && !refreshTimer->isActive()) {
-        refreshTimer->start(refreshIntervalSpin->value());
-    }
 }
 
 void MainWindow::closeApp()
@@ -513,6 +682,8 @@ void MainWindow::closeApp()
 
 void MainWindow::onTrayActivated(QSystemTrayIcon::ActivationReason reason)
 {
+    m_refreshScheduler->wake();
+
     switch (reason) {
     case QSystemTrayIcon::Trigger:
     case QSystemTrayIcon::DoubleClick:
@@ -530,45 +701,82 @@ void MainWindow::closeEvent(QCloseEvent* event)
     if (trayIcon && trayIcon->isVisible()) {
         hide();
         event->ignore();
-        // 隐藏时停止定时器以节省资源
-        if (refreshTimer && refreshTimer->isActive()) {
-            refreshTimer->stop();
-        }
     }
     else {
         WindowsTrayManager::instance().shutdown();
-        if (refreshTimer) {
-            refreshTimer->stop();
-        }
+        m_refreshScheduler->setPaused(RefreshScheduler::Disabled, true);
         QMainWindow::closeEvent(event);
     }
 }
 
+void MainWindow::showEvent(QShowEvent* event)
+{
+    QMainWindow::showEvent(event);
+    if (m_refreshScheduler) {
+        m_refreshScheduler->setPaused(RefreshScheduler::NoConsumers, false);
+    }
+}
+
+void MainWindow::hideEvent(QHideEvent* event)
+{
+    QMainWindow::hideEvent(event);
+
+    // 主窗口隐藏后没有人查看窗口列表，停止对账以节省资源
+    if (m_refreshScheduler) {
+        m_refreshScheduler->setPaused(RefreshScheduler::NoConsumers, true);
+    }
+}
+
 void MainWindow::createTrayIcon()
 {
     // 创建菜单
     trayMenu = new QMenu(this);
 
-    showAction = new QAction(trc("MainWindow", "Open Main Window"), this);
+    showAction = new QAction(this);
+    trBind(showAction, &QAction::setText, "MainWindow", "Open Main Window");
     connect(showAction, &QAction::triggered, this, &MainWindow::showWindow);
 
-    restoreLastAction = new QAction(trc("MainWindow", "Restore Last Window"), this);
+    restoreLastAction = new QAction(this);
+    trBind(restoreLastAction, &QAction::setText, "MainWindow", "Restore Last Window");
     connect(restoreLastAction, &QAction::triggered, this, &MainWindow::restoreLastWindow);
 
-    restoreAllAction = new QAction(trc("MainWindow", "Restore All Windows"), this);
+    restoreRecentAction = new QAction(this);
+    trBind(restoreRecentAction, [this](const QString& text) { restoreRecentAction->setText(text.arg(restoreCountSpin->value())); },
+        "MainWindow", "Restore Last %1 Windows");
+    connect(restoreRecentAction, &QAction::triggered, this, &MainWindow::restoreLastWindows);
+
+    restoreAllAction = new QAction(this);
+    trBind(restoreAllAction, &QAction::setText, "MainWindow", "Restore All Windows");
     connect(restoreAllAction, &QAction::triggered, this, &MainWindow::restoreAllWindows);
 
-    quitAction = new QAction(trc("MainWindow", "Exit"), this);
+    quitAction = new QAction(this);
+    trBind(quitAction, &QAction::setText, "MainWindow", "Exit");
     connect(quitAction, &QAction::triggered, this, &MainWindow::closeApp);
 
     trayMenu->addAction(showAction);
     trayMenu->addSeparator();
-    trayMenu->addSeparator();
+    // 应用托盘隐藏的窗口插在这个分隔符之前
+    QAction* windowsAnchor = trayMenu->addSeparator();
     trayMenu->addAction(restoreLastAction);
+    trayMenu->addAction(restoreRecentAction);
     trayMenu->addAction(restoreAllAction);
     trayMenu->addSeparator();
     trayMenu->addAction(quitAction);
 
+    m_trayWindowMenu = new TrayWindowMenu(trayMenu, windowsAnchor, std::make_unique<Win32TrayMenuPlatform>(), this);
+    trBind(m_trayWindowMenu, &TrayWindowMenu::setUnknownTitle, "MainWindow", "Unknown Window");
+    m_trayWindowMenu->setTopLevelCap(menuEntriesSpin->value());
+    connect(m_trayWindowMenu, &TrayWindowMenu::restoreRequested, this, &MainWindow::restoreWindowFromAppTray);
+
+    // 定时检查时清理掉的已销毁窗口
+    connect(m_trayWindowMenu, &TrayWindowMenu::windowsPruned, this, [this](const QList<HWND>& removed) {
+        WindowsTrayManager::Batch batch;
+        for (HWND hwnd : removed) {
+            WindowsTrayManager::instance().recordAppTrayChange(hwnd, false);
+        }
+        m_invalidator->invalidate(UiInvalidator::HiddenTable | UiInvalidator::TrayMenu);
+        });
+
     // 创建托盘图标
     trayIcon = new QSystemTrayIcon(this);
 
@@ -581,7 +789,7 @@ void MainWindow::createTrayIcon()
     trayIcon->setIcon(icon);
 
     trayIcon->setContextMenu(trayMenu);
-    trayIcon->setToolTip(tr("Traynex"));
+    trBind(trayIcon, &QSystemTrayIcon::setToolTip, "MainWindow", "Traynex - Right click for menu");
 
     // 连接信号
     connect(trayIcon, &QSystemTrayIcon::activated, this, &MainWindow::onTrayActivated);
@@ -600,65 +808,40 @@ QString MainWindow::getConfigPath() const
 
 void MainWindow::loadSettings()
 {
-    QSettings settings(getConfigPath(), QSettings::IniFormat);
-
     // 热键设置
-    bool hotkeyEnabled = settings.value("hotkey/enabled", true).toBool();
-    enableHotkeyCheck->setChecked(hotkeyEnabled);
+    enableHotkeyCheck->setChecked(m_settings->get(HotkeyEnabledSetting));
 
     // 窗口设置
-    int maxWindows = settings.value("window/max_hidden", 50).toInt();
-    maxWindowsSpin->setValue(maxWindows);
+    maxWindowsSpin->setValue(m_settings->get(MaxHiddenSetting));
+    WindowsTrayManager::instance().setMaxWindows(maxWindowsSpin->value());
+    menuEntriesSpin->setValue(m_settings->get(MenuEntriesSetting));
+    restoreCountSpin->setValue(m_settings->get(RestoreCountSetting));
 
     // 常规设置
-    bool startWithSystem = settings.value("general/start_with_system", false).toBool();
-    startWithSystemCheck->setChecked(startWithSystem);
+    startWithSystemCheck->setChecked(m_settings->get(StartWithSystemSetting));
 
     // 加载窗口置顶设置
-    bool alwaysOnTop = settings.value("window/always_on_top", false).toBool();
-    alwaysOnTopCheck->setChecked(alwaysOnTop);
+    alwaysOnTopCheck->setChecked(m_settings->get(AlwaysOnTopSetting));
 
-    QString language = settings.value("general/language", "zh").toString();
-    int index = languageCombo->findData(language);
+    int index = languageCombo->findData(m_settings->get(LanguageSetting));
     if (index >= 0) {
         languageCombo->setCurrentIndex(index);
     }
 
     // 刷新设置
-    bool autoRefresh = settings.value("refresh/auto_refresh", true).toBool();
-    autoRefreshCheck->setChecked(autoRefresh);
-    int refreshInterval = settings.value("refresh/interval", 500).toInt();
-    refreshIntervalSpin->setValue(refreshInterval);
+    autoRefreshCheck->setChecked(m_settings->get(AutoRefreshSetting));
+    refreshIntervalSpin->setValue(m_settings->get(RefreshIntervalSetting));
+
+    // 窗口过滤设置（只能在配置文件中修改）
+    QStringList excludedClasses = m_settings->value("filter/excluded_classes",
+        WindowFilter::defaultExcludedClasses()).toStringList();
+    WindowFilter::instance().setExcludedClasses(excludedClasses);
 
     // 应用加载的设置
     onRefreshSettingChanged();    // 应用刷新设置
     onAlwaysOnTopChanged();       // 应用置顶设置
 
-    qDebug() << "Settings loaded and applied from:" << getConfigPath();
-}
-
-void MainWindow::saveSettings()
-{
-    QSettings settings(getConfigPath(), QSettings::IniFormat);
-
-    // 热键设置
-    settings.setValue("hotkey/enabled", enableHotkeyCheck->isChecked());
-
-    // 窗口设置
-    settings.setValue("window/max_hidden", maxWindowsSpin->value());
-    settings.setValue("window/always_on_top", alwaysOnTopCheck->isChecked());
-
-    // 常规设置
-    settings.setValue("general/start_with_system", startWithSystemCheck->isChecked());
-    settings.setValue("general/language", languageCombo->currentData().toString());
-
-    // 刷新设置
-    settings.setValue("refresh/auto_refresh", autoRefreshCheck->isChecked());
-    settings.setValue("refresh/interval", refreshIntervalSpin->value());
-
-    settings.sync(); // 立即写入磁盘
-
-    qDebug() << "Settings saved to:" << getConfigPath();
+    qDebug() << "Settings loaded and applied from:" << m_settings->path();
 }
 
 void MainWindow::hideSelectedToTray()
@@ -670,14 +853,8 @@ void MainWindow::hideSelectedToTray()
         return;
     }
 
+    // 成功时由 trayWindowsChanged 记录隐藏顺序并刷新显示
     if (WindowsTrayManager::instance().minimizeWindowToTray(hwnd)) {
-        // 记录隐藏顺序
-        m_hiddenWindowOrder.removeAll(hwnd);  // 先移除（如果已存在）
-        m_hiddenWindowOrder.prepend(hwnd);    // 添加到开头（最近隐藏的）
-
-        // 成功隐藏，刷新显示
-        refreshAllLists();
-        updateTrayMenu();
         QMessageBox::information(this, trc("MainWindow", "Success"),
             trc("MainWindow", "Window hidden to tray successfully"));
     }
@@ -691,18 +868,28 @@ void MainWindow::createContextMenu()
 {
     contextMenu = new QMenu(this);
 
-    hideToTrayAction = new QAction(trc("MainWindow", "Hide to Tray Icon"), this);
-    hideToAppTrayAction = new QAction(trc("MainWindow", "Hide to Tray Menu"), this);
-    bringToFrontAction = new QAction(trc("MainWindow", "Bring to Front"), this);
-    highlightAction = new QAction(trc("MainWindow", "Highlight Window"), this);
-    toggleOnTopAction = new QAction(trc("MainWindow", "Always on Top"), this);
-    muteAction = new QAction(trc("MainWindow", "Mute Process"), this);
-    opacityMenu = new QMenu(trc("MainWindow", "Opacity"), contextMenu);
+    hideToTrayAction = new QAction(this);
+    trBind(hideToTrayAction, &QAction::setText, "MainWindow", "Hide to Tray Icon");
+    hideToAppTrayAction = new QAction(this);
+    trBind(hideToAppTrayAction, &QAction::setText, "MainWindow", "Hide to Tray Menu");
+    bringToFrontAction = new QAction(this);
+    trBind(bringToFrontAction, &QAction::setText, "MainWindow", "Bring to Front");
+    highlightAction = new QAction(this);
+    trBind(highlightAction, &QAction::setText, "MainWindow", "Highlight Window");
+    toggleOnTopAction = new QAction(this);
+    trBind(toggleOnTopAction, &QAction::setText, "MainWindow", "Always on Top");
+    muteAction = new QAction(this);
+    trBind(muteAction, &QAction::setText, "MainWindow", "Mute Process");
+    opacityMenu = new QMenu(contextMenu);
+    trBind(opacityMenu, &QMenu::setTitle, "MainWindow", "Opacity");
     opacitySlider = new QSlider(Qt::Horizontal);
     opacityLabel = new QLabel;
-    openFolderAction = new QAction(trc("MainWindow", "Open File Location"), this);
-    filePropsAction = new QAction(trc("MainWindow", "File Properties"), this);
-    endTaskAction = new QAction(trc("MainWindow", "End Task"), this);
+    openFolderAction = new QAction(this);
+    trBind(openFolderAction, &QAction::setText, "MainWindow", "Open File Location");
+    filePropsAction = new QAction(this);
+    trBind(filePropsAction, &QAction::setText, "MainWindow", "File Properties");
+    endTaskAction = new QAction(this);
+    trBind(endTaskAction, &QAction::setText, "MainWindow", "End Task");
 
     toggleOnTopAction->setCheckable(true);
     muteAction->setCheckable(true);
@@ -749,39 +936,24 @@ void MainWindow::createContextMenu()
 void MainWindow::onTableContextMenu(const QPoint& pos)
 {
     // 临时停止自动刷新
-    if (refreshTimer && refreshTimer->isActive()) {
-        refreshTimer->stop();
-    }
+    m_refreshScheduler->setPaused(RefreshScheduler::MenuOpen, true);
 
     // 获取点击位置对应的行
     int row = windowsTable->rowAt(pos.y());
-    if (row < 0 || row >= windowsTable->rowCount()) {
-        // 恢复计时器
-        if (refreshTimer && autoRefreshCheck->isChecked()) {
-            refreshTimer->start(refreshIntervalSpin->value());
-        }
+    if (row < 0 || row >= windowsTable->model()->rowCount()) {
+        // 恢复自动刷新
+        m_refreshScheduler->setPaused(RefreshScheduler::MenuOpen, false);
         return;
     }
 
     // 确保选中这一行
-    windowsTable->setCurrentCell(row, 0);
+    windowsTable->selectRow(row);
 
     // 获取 HWND 数据
-    QTableWidgetItem* hwndItem = windowsTable->item(row, 0);
-    if (!hwndItem) {
-        // 恢复计时器
-        if (refreshTimer && autoRefreshCheck->isChecked()) {
-            refreshTimer->start(refreshIntervalSpin->value());
-        }
-        return;
-    }
-
-    HWND hwnd = reinterpret_cast<HWND>(hwndItem->data(Qt::UserRole).toULongLong());
+    HWND hwnd = windowAtRow(windowsTable, row);
     if (!hwnd || !IsWindow(hwnd)) {
-        // 恢复计时器
-        if (refreshTimer && autoRefreshCheck->isChecked()) {
-            refreshTimer->start(refreshIntervalSpin->value());
-        }
+        // 恢复自动刷新
+        m_refreshScheduler->setPaused(RefreshScheduler::MenuOpen, false);
         return;
     }
 
@@ -791,14 +963,7 @@ void MainWindow::onTableContextMenu(const QPoint& pos)
     muteAction->setChecked(isMuted);
 
     // 根据窗口状态更新菜单项
-    bool isHidden = false;
-    auto hiddenWindows = WindowsTrayManager::instance().getHiddenWindows();
-    for (const auto& hidden : hiddenWindows) {
-        if (hidden.first == hwnd) {
-            isHidden = true;
-            break;
-        }
-    }
+    bool isHidden = WindowsTrayManager::instance().isHidden(hwnd);
     bool isOnTop = isWindowOnTop(hwnd);
 
     hideToTrayAction->setEnabled(!isHidden);
@@ -809,281 +974,58 @@ void MainWindow::onTableContextMenu(const QPoint& pos)
 
     toggleOnTopAction->setChecked(isOnTop);
 
-    if (row >= 0) {
-        HWND hwnd = reinterpret_cast<HWND>(windowsTable->item(row, 0)->data(Qt::UserRole).toULongLong());
-        BYTE curAlpha = 255;
-        if (hwnd && IsWindow(hwnd))
-            GetLayeredWindowAttributes(hwnd, nullptr, &curAlpha, nullptr);
-        opacitySlider->setValue(curAlpha * 0.390625 + 1);
-    }
+    BYTE curAlpha = 255;
+    GetLayeredWindowAttributes(hwnd, nullptr, &curAlpha, nullptr);
+    opacitySlider->setValue(curAlpha * 0.390625 + 1);
 
     // 显示菜单
     contextMenu->exec(windowsTable->viewport()->mapToGlobal(pos));
 
     // 恢复自动刷新
-    if (refreshTimer && autoRefreshCheck->isChecked()) {
-        refreshTimer->start(refreshIntervalSpin->value());
-    }
+    m_refreshScheduler->setPaused(RefreshScheduler::MenuOpen, false);
 }
 
 void MainWindow::refreshWindowsTable()
 {
-    auto currentWindowsInfo = getAllWindowsInfo();
-
-    // 检查窗口列表是否发生变化
-    bool needsRefresh = false;
-
-    if (currentWindowsInfo.size() != m_lastWindowsInfo.size()) {
-        needsRefresh = true;
-    }
-    else {
-        // 检查窗口状态是否有变化
-        for (int i = 0; i < currentWindowsInfo.size(); ++i) {
-            if (currentWindowsInfo[i].first != m_lastWindowsInfo[i].first ||
-                currentWindowsInfo[i].second.isHidden != m_lastWindowsInfo[i].second.isHidden ||
-                currentWindowsInfo[i].second.title != m_lastWindowsInfo[i].second.title ||
-                currentWindowsInfo[i].second.processName != m_lastWindowsInfo[i].second.processName ||
-                currentWindowsInfo[i].second.className != m_lastWindowsInfo[i].second.className ||
-                currentWindowsInfo[i].second.processId != m_lastWindowsInfo[i].second.processId) {
-                needsRefresh = true;
-                break;
-            }
-        }
+    // 只读取最新发布的快照，枚举工作全部在后台线程
+    WindowSnapshotPtr snapshot = m_snapshotProducer->latest();
+    if (!snapshot) {
+        return;
     }
 
-    if (!needsRefresh) {
-        return; // 没有变化，不刷新
-    }
+    // 标记隐藏窗口
+    QSet<HWND> hiddenSet;
+    WindowsTrayManager::instance().hiddenWindows().forEach([&hiddenSet](HWND hwnd, const HiddenWindow&) {
+        hiddenSet.insert(hwnd);
+        });
 
-    // 保存当前选中的窗口句柄
-    HWND previouslySelectedHwnd = getSelectedWindow();
+    // 直接对列式快照求差异，模型只对新增、移除、变化的行发出通知，选中和滚动位置保持不变
+    windowsModel->setSnapshot(*snapshot, hiddenSet);
+}
+
+HWND MainWindow::windowAtRow(const QTableView* view, int row) const
+{
+    if (row < 0) return nullptr;
 
-    windowsTable->setSortingEnabled(false);
-    windowsTable->setRowCount(0);
+    QModelIndex index = view->model()->index(row, 0);
+    return reinterpret_cast<HWND>(index.data(WindowTableModel::HwndRole).toULongLong());
+}
 
-    // 设置列数为6，添加图标列
-    windowsTable->setColumnCount(6);
-    windowsTable->setHorizontalHeaderLabels({
+QStringList MainWindow::tableHeaderLabels() const
+{
+    return {
         "", // 图标列
         trc("MainWindow", "Window Title"),
         trc("MainWindow", "Handle"),
         trc("MainWindow", "Class"),
         trc("MainWindow", "Process ID"),
         trc("MainWindow", "Process")
-        });
-
-    for (const auto& window : currentWindowsInfo) {
-        int row = windowsTable->rowCount();
-        windowsTable->insertRow(row);
-
-        // 图标
-        QTableWidgetItem* iconItem = new QTableWidgetItem();
-        if (!window.second.icon.isNull()) {
-            iconItem->setIcon(window.second.icon);
-        }
-        iconItem->setData(Qt::UserRole, reinterpret_cast<qulonglong>(window.second.hwnd));
-
-        // 窗口标题
-        QTableWidgetItem* titleItem = new QTableWidgetItem(window.second.title);
-        titleItem->setData(Qt::UserRole, reinterpret_cast<qulonglong>(window.second.hwnd));
-
-        // 窗口句柄
-        QTableWidgetItem* handleItem = new QTableWidgetItem(
-            QString::number(reinterpret_cast<qulonglong>(window.second.hwnd), 16).toUpper());
-
-        // 窗口类名
-        QTableWidgetItem* classItem = new QTableWidgetItem(window.second.className);
-
-        // 进程ID
-        QTableWidgetItem* pidItem = new QTableWidgetItem(QString::number(window.second.processId));
-
-        // 进程名
-        QTableWidgetItem* processItem = new QTableWidgetItem(window.second.processName);
-
-        windowsTable->setItem(row, 0, iconItem);     // 图标
-        windowsTable->setItem(row, 1, titleItem);    // 窗口标题
-        windowsTable->setItem(row, 2, handleItem);   // 句柄
-        windowsTable->setItem(row, 3, classItem);    // 类
-        windowsTable->setItem(row, 4, pidItem);      // 进程ID
-        windowsTable->setItem(row, 5, processItem);  // 进程名
-
-        // 隐藏窗口显示为灰色
-        if (window.second.isHidden) {
-            for (int col = 0; col < 6; ++col) {
-                if (auto item = windowsTable->item(row, col)) {
-                    item->setForeground(Qt::gray);
-                }
-            }
-        }
-
-        // 恢复选中状态
-        if (window.second.hwnd == previouslySelectedHwnd) {
-            windowsTable->setCurrentCell(row, 0);
-        }
-    }
-
-    // 调整列宽
-    windowsTable->setColumnWidth(0, 24);  // 图标列宽度
-    windowsTable->setColumnWidth(1, 276); // 标题（调整后）
-    windowsTable->setColumnWidth(2, 80);  // 句柄
-    windowsTable->setColumnWidth(3, 120); // 窗口类
-    windowsTable->setColumnWidth(4, 80);  // 进程ID
-    windowsTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::Stretch);
-
-    windowsTable->setSortingEnabled(true);
-
-    // 保存当前窗口信息用于下次比较
-    m_lastWindowsInfo = currentWindowsInfo;
-}
-
-QList<QPair<HWND, MainWindow::WindowInfo>> MainWindow::getAllWindowsInfo() const
-{
-    QList<QPair<HWND, WindowInfo>> windows;
-    DWORD currentProcessId = GetCurrentProcessId();
-
-    // 获取所有隐藏窗口
-    auto hiddenWindows = WindowsTrayManager::instance().getHiddenWindows();
-    QSet<HWND> hiddenSet;
-    for (const auto& hidden : hiddenWindows) {
-        hiddenSet.insert(hidden.first);
-    }
-
-    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
-        auto windowsList = reinterpret_cast<QList<QPair<HWND, WindowInfo>>*>(lParam);
-        DWORD currentProcessId = GetCurrentProcessId();
-
-        // 获取窗口标题
-        wchar_t title[256];
-        GetWindowText(hwnd, title, 256);
-        QString windowTitle = QString::fromWCharArray(title);
-
-        // 过滤条件
-        // 1.窗口有效性
-        if (!IsWindow(hwnd) || !IsWindowVisible(hwnd)) {
-            return TRUE;
-        }
-        // 2.非自身进程
-        DWORD processId;
-        GetWindowThreadProcessId(hwnd, &processId);
-        if (processId == currentProcessId) {
-            return TRUE;
-        }
-        // 3.标题非空
-        LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
-        if (exStyle & WS_EX_TOOLWINDOW) {
-            return TRUE;
-        }
-        // 4.非删除标记
-        if (GetProp(hwnd, L"ITaskList_Deleted")) {
-            return TRUE;
-        }
-        // 5.所有者关系和可激活性
-        HWND owner = GetWindow(hwnd, GW_OWNER);
-        bool hasOwner = (owner != nullptr);
-        bool isAppWindow = (exStyle & WS_EX_APPWINDOW);
-
-        if (hasOwner && !isAppWindow) {
-            return TRUE;
-        }
-
-        if ((exStyle & WS_EX_NOACTIVATE) && !isAppWindow) {
-            return TRUE;
-        }
-        
-        wchar_t className[256];
-        GetClassName(hwnd, className, 256);
-        QString windowClass = QString::fromWCharArray(className);
-
-        // 6.Application Frame Window 检查
-        if (windowClass == "ApplicationFrameWindow" ||
-            windowClass == "Windows.UI.Core.CoreWindow" ||
-            windowClass == "StartMenuSizingFrame" ||
-            windowClass == "Shell_LightDismissOverlay") {
-            return TRUE;
-        }
-
-        // 获取进程名
-        HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-        wchar_t processName[MAX_PATH] = L"";
-        QString processNameStr = "Unknown";
-
-        if (process) {
-            GetModuleFileNameEx(process, NULL, processName, MAX_PATH);
-            processNameStr = QFileInfo(QString::fromWCharArray(processName)).fileName();
-            CloseHandle(process);
-        }
-
-        // 获取窗口图标
-        QIcon windowIcon;
-        HICON hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
-        if (!hIcon) {
-            hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
-        }
-        if (!hIcon) {
-            hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_BIG, 0);
-        }
-        if (!hIcon) {
-            hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICON);
-        }
-
-        // 如果仍然没有图标，尝试从进程获取
-        if (!hIcon && processId) {
-            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-            if (hProcess) {
-                wchar_t exePath[MAX_PATH];
-                if (GetModuleFileNameEx(hProcess, NULL, exePath, MAX_PATH)) {
-                    HICON hAppIcon = ExtractIcon(GetModuleHandle(NULL), exePath, 0);
-                    if (hAppIcon) {
-                        hIcon = hAppIcon;
-                    }
-                }
-                CloseHandle(hProcess);
-            }
-        }
-
-        // 如果获取到图标，转换为QIcon
-        if (hIcon) {
-            windowIcon = QIcon(QPixmap::fromImage(QImage::fromHICON(hIcon)));
-
-            // 清理系统图标资源（如果是我们自己提取的）
-            if (hIcon != (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0) &&
-                hIcon != (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM) &&
-                hIcon != (HICON)SendMessage(hwnd, WM_GETICON, ICON_BIG, 0) &&
-                hIcon != (HICON)GetClassLongPtr(hwnd, GCLP_HICON)) {
-                DestroyIcon(hIcon);
-            }
-        }
-
-        WindowInfo info;
-        info.title = windowTitle;
-        info.processName = processNameStr;
-        info.className = windowClass;
-        info.processId = processId;
-        info.hwnd = hwnd;
-        info.isVisible = IsWindowVisible(hwnd);
-        info.isHidden = false; // 会在外部设置
-        info.icon = windowIcon; // 设置图标
-
-        windowsList->append(qMakePair(hwnd, info));
-        return TRUE;
-        }, reinterpret_cast<LPARAM>(&windows));
-
-    // 标记隐藏窗口
-    for (auto& window : windows) {
-        if (hiddenSet.contains(window.first)) {
-            window.second.isHidden = true;
-        }
-    }
-
-    return windows;
+    };
 }
 
 HWND MainWindow::getSelectedWindow() const
 {
-    int row = windowsTable->currentRow();
-    if (row < 0) return nullptr;
-
-    return reinterpret_cast<HWND>(windowsTable->item(row, 0)->data(Qt::UserRole).toULongLong());
+    return windowAtRow(windowsTable, windowsTable->currentIndex().row());
 }
 
 void MainWindow::bringToFront()
@@ -1114,8 +1056,7 @@ void MainWindow::endTask()
 
 void MainWindow::refreshAllLists()
 {
-    refreshWindowsTable();
-    refreshHiddenWindowsTable();
+    m_invalidator->invalidate(UiInvalidator::WindowTable | UiInvalidator::HiddenTable);
 }
 
 void MainWindow::loadLanguage(const QString& language)
@@ -1136,131 +1077,11 @@ void MainWindow::loadLanguage(const QString& language)
 
 void MainWindow::retranslateUI()
 {
-    // 更新窗口标题
-    setWindowTitle(trc("MainWindow", "Traynex"));
-
-    // 更新表格标题
-    windowsTable->setHorizontalHeaderLabels({
-        "", // 图标列
-        trc("MainWindow", "Window Title"),
-        trc("MainWindow", "Handle"),
-        trc("MainWindow", "Class"),
-        trc("MainWindow", "Process ID"),
-        trc("MainWindow", "Process")
-        });
-
-    hiddenWindowsTable->setHorizontalHeaderLabels({
-        "", // 图标列
-        trc("MainWindow", "Window Title"),
-        trc("MainWindow", "Handle"),
-        trc("MainWindow", "Class"),
-        trc("MainWindow", "Process ID"),
-        trc("MainWindow", "Process")
-        });
-
-
-    // 标签页标题
-    tabWidget->setTabText(0, trc("MainWindow", "Main"));
-    tabWidget->setTabText(1, trc("MainWindow", "Hidden Windows"));
-    tabWidget->setTabText(2, trc("MainWindow", "Settings"));
-    tabWidget->setTabText(3, trc("MainWindow", "About"));
-
-    // 托盘菜单
-    if (trayIcon) {
-        showAction->setText(trc("MainWindow", "Open Main Window"));
-        restoreLastAction->setText(trc("MainWindow", "Restore Last Window"));
-        restoreAllAction->setText(trc("MainWindow", "Restore All Windows"));
-        quitAction->setText(trc("MainWindow", "Exit"));
-        trayIcon->setToolTip(trc("MainWindow", "Traynex - Right click for menu"));
-    }
-    // 更动态菜单布局
-    updateTrayMenuLayout();
-    // 设置页面
-    // 组标题
-    if (auto generalGroup = findChild<QGroupBox*>("generalGroup")) {
-        generalGroup->setTitle(trc("MainWindow", "General Settings"));
-    }
-    if (auto refreshGroup = findChild<QGroupBox*>("refreshGroup")) {
-        refreshGroup->setTitle(trc("MainWindow", "Auto Refresh Settings"));
-    }
-    if (auto windowGroup = findChild<QGroupBox*>("windowGroup")) {
-        windowGroup->setTitle(trc("MainWindow", "Window Settings"));
-    }
-
-    // 复选框和标签
-    startWithSystemCheck->setText(trc("MainWindow", "Start with Windows"));
-    enableHotkeyCheck->setText(trc("MainWindow", "Enable Hotkey"));
-    autoRefreshCheck->setText(trc("MainWindow", "Enable auto refresh"));
-    alwaysOnTopCheck->setText(trc("MainWindow", "Always on Top"));
-
-    // 表单标签
-    if (auto refreshLabel = findChild<QLabel*>("refreshIntervalLabel")) {
-        refreshLabel->setText(trc("MainWindow", "Refresh interval:"));
-    }
-    if (auto maxWindowsLabel = findChild<QLabel*>("maxWindowsLabel")) {
-        maxWindowsLabel->setText(trc("MainWindow", "Maximum hidden windows:"));
-    }
-    if (auto languageLabel = findChild<QLabel*>("languageLabel")) {
-        languageLabel->setText(trc("MainWindow", "Language:"));
-    }
-
-    // 关于页面
-    if (auto aboutTitle = findChild<QLabel*>("aboutTitle")) {
-        aboutTitle->setText(trc("MainWindow", "About"));
-    }
-
-    // 关于页面按钮
-    if (auto githubButton = findChild<QPushButton*>("githubButton")) {
-        githubButton->setText(trc("MainWindow", "Visit GitHub Repository"));
-    }
-    if (auto checkUpdateButton = findChild<QPushButton*>("checkUpdateButton")) {
-        checkUpdateButton->setText(trc("MainWindow", "Check for Updates"));
-    }
-
-    // 更新关于文本
-    showAbout();
+    // 控件文本在创建时已登记绑定，切换语言只需逐项重新赋值
+    m_translations->retranslate();
 
-    // 右键菜单
-    if (contextMenu) {
-        hideToTrayAction->setText(trc("MainWindow", "Hide to Tray Icon"));
-        hideToAppTrayAction->setText(trc("MainWindow", "Hide to Tray Menu"));
-        bringToFrontAction->setText(trc("MainWindow", "Bring to Front"));
-        highlightAction->setText(trc("MainWindow", "Highlight Window"));
-        toggleOnTopAction->setText(trc("MainWindow", "Always on Top"));
-        muteAction->setText(trc("MainWindow", "Mute Process"));
-        opacityMenu->setTitle(trc("MainWindow", "Opacity"));
-        openFolderAction->setText(trc("MainWindow", "Open File Location"));
-        endTaskAction->setText(trc("MainWindow", "End Task"));
-    }
-
-    // 隐藏窗口表格右键菜单
-    if (hiddenTableContextMenu) {
-        restoreHiddenAction->setText(trc("MainWindow", "Restore Window"));
-        restoreLastHiddenAction->setText(trc("MainWindow", "Restore Last Window"));
-        restoreAllHiddenAction->setText(trc("MainWindow", "Restore All Windows"));
-    }
-
-    // 热键设置组标题
-    if (auto hotkeyGroup = findChild<QGroupBox*>("hotkeyGroup")) {
-        hotkeyGroup->setTitle(trc("MainWindow", "Hotkey Settings"));
-    }
-
-    // 热键标签
-    if (auto minimizeHotkeyLabel = findChild<QLabel*>("minimizeHotkeyLabel")) {
-        minimizeHotkeyLabel->setText(trc("MainWindow", "Minimize to Tray Icon:"));
-    }
-
-    // 更新热键相关控件
-    setMinimizeHotkeyButton->setText(trc("MainWindow", "Set Hotkey"));
-    minimizeHotkeyEdit->setPlaceholderText(trc("MainWindow", "Click to set hotkey"));
-
-    // 清除按钮
-    if (auto clearButton = findChild<QPushButton*>("clearMinimizeHotkeyButton")) {
-        clearButton->setText(trc("MainWindow", "Clear"));
-    }
-
-    // 刷新表格内容
-    refreshWindowsTable();
+    // 刷新状态文本随调度器状态变化，单独更新
+    updateRefreshStatus();
 }
 
 void MainWindow::onRefreshSettingChanged()
@@ -1268,18 +1089,38 @@ void MainWindow::onRefreshSettingChanged()
     bool autoRefresh = autoRefreshCheck->isChecked();
     int interval = refreshIntervalSpin->value();
 
+    // 刷新间隔用于合并窗口事件，同时作为对账的最短间隔
+    m_snapshotProducer->setCoalesceInterval(interval);
+    m_refreshScheduler->setMinInterval(interval);
+
     // 立即应用刷新设置
     if (autoRefresh) {
-        refreshTimer->start(interval);
+        m_snapshotProducer->start();
     }
     else {
-        refreshTimer->stop();
+        m_snapshotProducer->stop();
     }
+    m_refreshScheduler->setPaused(RefreshScheduler::Disabled, !autoRefresh);
+    updateRefreshStatus();
 
     qDebug() << "Refresh setting changed - Auto:" << autoRefresh << "Interval:" << interval;
+}
+
+void MainWindow::onTrayWindowsChanged(const TrayChange& change)
+{
+    // 隐藏顺序由 WindowsTrayManager 的 MRU 维护，这里只需标记刷新
+    Q_UNUSED(change);
+    m_invalidator->invalidate(UiInvalidator::WindowTable | UiInvalidator::HiddenTable | UiInvalidator::TrayMenu);
+}
 
-    // 自动保存设置
-    QTimer::singleShot(100, this, &MainWindow::autoSaveSettings);
+void MainWindow::updateRefreshStatus()
+{
+    if (m_refreshScheduler->isPaused()) {
+        refreshStatusLabel->setText(trc("MainWindow", "Paused"));
+    }
+    else {
+        refreshStatusLabel->setText(QString::number(m_refreshScheduler->currentInterval()) + trc("MainWindow", "ms"));
+    }
 }
 
 void MainWindow::onLanguageChanged()
@@ -1293,9 +1134,6 @@ void MainWindow::onLanguageChanged()
     }
 
     qDebug() << "Language changed to:" << newLanguage;
-
-    // 自动保存设置
-    QTimer::singleShot(100, this, &MainWindow::autoSaveSettings);
 }
 
 void MainWindow::onStartWithSystemChanged()
@@ -1316,9 +1154,6 @@ void MainWindow::onStartWithSystemChanged()
     }
 
     qDebug() << "Start with system changed:" << startWithSystem;
-
-    // 自动保存设置
-    QTimer::singleShot(100, this, &MainWindow::autoSaveSettings);
 }
 
 void MainWindow::onMaxWindowsChanged()
@@ -1326,19 +1161,23 @@ void MainWindow::onMaxWindowsChanged()
     int maxWindows = maxWindowsSpin->value();
 
     // 更新最大窗口限制
-    // WindowsTrayManager::instance().setMaxWindows(maxWindows);
+    WindowsTrayManager::instance().setMaxWindows(maxWindows);
 
     qDebug() << "Max windows changed:" << maxWindows;
+}
 
-    // 自动保存设置
-    QTimer::singleShot(100, this, &MainWindow::autoSaveSettings);
+void MainWindow::onMenuEntriesChanged()
+{
+    if (m_trayWindowMenu) {
+        m_trayWindowMenu->setTopLevelCap(menuEntriesSpin->value());
+    }
 }
 
-void MainWindow::autoSaveSettings()
+void MainWindow::onRestoreCountChanged()
 {
-    saveSettings();
-    saveHotkeySettings();
-    qDebug() << "Settings auto-saved";
+    if (restoreRecentAction) {
+        restoreRecentAction->setText(trc("MainWindow", "Restore Last %1 Windows").arg(restoreCountSpin->value()));
+    }
 }
 
 void MainWindow::onAlwaysOnTopChanged()
@@ -1349,9 +1188,6 @@ void MainWindow::onAlwaysOnTopChanged()
     updateWindowFlags();
 
     qDebug() << "Always on top changed:" << alwaysOnTop;
-
-    // 自动保存设置
-    QTimer::singleShot(100, this, &MainWindow::autoSaveSettings);
 }
 
 void MainWindow::updateWindowFlags()
@@ -1488,158 +1324,33 @@ void MainWindow::toggleWindowOnTop()
 
 void MainWindow::refreshHiddenWindowsTable()
 {
-    hiddenWindowsTable->setSortingEnabled(false);
-    hiddenWindowsTable->setRowCount(0);
-
-    // 获取系统托盘隐藏的窗口
-    auto systemHiddenWindows = WindowsTrayManager::instance().getHiddenWindows();
-
-    // 获取应用托盘菜单隐藏的窗口
-    auto appTrayHiddenWindows = m_appTrayWindows;
-
-    // 合并两种隐藏窗口
-    QMap<HWND, std::tuple<QString, QString, QString, DWORD, QIcon>> allHiddenWindows;
-
-    // 添加系统托盘隐藏窗口
-    for (const auto& window : systemHiddenWindows) {
-        HWND hwnd = window.first;
-        if (hwnd && IsWindow(hwnd)) {
-            // 获取进程名、类名、进程ID和图标
-            QString processName = "Unknown";
-            QString className = "Unknown";
-            DWORD processId;
-            QIcon windowIcon;
-
-            GetWindowThreadProcessId(hwnd, &processId);
-
-            HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-            if (process) {
-                wchar_t processPath[MAX_PATH] = L"";
-                if (GetModuleFileNameEx(process, NULL, processPath, MAX_PATH)) {
-                    processName = QFileInfo(QString::fromWCharArray(processPath)).fileName();
-                }
-                CloseHandle(process);
-            }
-
-            wchar_t classBuffer[256];
-            if (GetClassName(hwnd, classBuffer, 256)) {
-                className = QString::fromWCharArray(classBuffer);
-            }
-
-            // 获取图标
-            HICON hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
-            if (!hIcon) hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
-            if (hIcon) {
-                windowIcon = QIcon(QPixmap::fromImage(QImage::fromHICON(hIcon)));
-            }
-
-            allHiddenWindows[hwnd] = std::make_tuple(
-                QString::fromStdWString(window.second),
-                processName,
-                className,
-                processId,
-                windowIcon
-            );
-        }
-    }
-
-    // 添加应用托盘菜单隐藏窗口
-    for (auto it = appTrayHiddenWindows.begin(); it != appTrayHiddenWindows.end(); ++it) {
-        HWND hwnd = it.key();
-        if (hwnd && IsWindow(hwnd)) {
-            if (!allHiddenWindows.contains(hwnd)) {
-                wchar_t title[256];
-                QString windowTitle = trc("MainWindow", "Unknown Window");
-                if (GetWindowText(hwnd, title, 256) > 0) {
-                    windowTitle = QString::fromWCharArray(title);
-                }
-
-                QString processName = "Unknown";
-                QString className = "Unknown";
-                DWORD processId;
-                QIcon windowIcon;
-
-                GetWindowThreadProcessId(hwnd, &processId);
-
-                HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-                if (process) {
-                    wchar_t processPath[MAX_PATH] = L"";
-                    if (GetModuleFileNameEx(process, NULL, processPath, MAX_PATH)) {
-                        processName = QFileInfo(QString::fromWCharArray(processPath)).fileName();
-                    }
-                    CloseHandle(process);
-                }
-
-                wchar_t classBuffer[256];
-                if (GetClassName(hwnd, classBuffer, 256)) {
-                    className = QString::fromWCharArray(classBuffer);
-                }
-
-                // 获取图标
-                HICON hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
-                if (!hIcon) hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
-                if (hIcon) {
-                    windowIcon = QIcon(QPixmap::fromImage(QImage::fromHICON(hIcon)));
-                }
-
-                allHiddenWindows[hwnd] = std::make_tuple(windowTitle, processName, className, processId, windowIcon);
-            }
+    // 两种方式隐藏的窗口都在同一张表里，信息在隐藏时已经采集，这里只读不查询
+    const QString unknownTitle = trc("MainWindow", "Unknown Window");
+    QList<QPair<HWND, WindowInfo>> hiddenList;
+    WindowsTrayManager::instance().hiddenWindows().forEach([&](HWND hwnd, const HiddenWindow& hidden) {
+        if (!IsWindow(hwnd)) {
+            return;
         }
-    }
-
-    // 显示所有隐藏窗口
-    for (auto it = allHiddenWindows.begin(); it != allHiddenWindows.end(); ++it) {
-        HWND hwnd = it.key();
-        auto [title, processName, className, processId, icon] = it.value();
-
-        int row = hiddenWindowsTable->rowCount();
-        hiddenWindowsTable->insertRow(row);
-
-        // 图标
-        QTableWidgetItem* iconItem = new QTableWidgetItem();
-        if (!icon.isNull()) {
-            iconItem->setIcon(icon);
+        WindowInfo info = hidden.info;
+        if (info.title.isEmpty()) {
+            info.title = unknownTitle;
         }
-        iconItem->setData(Qt::UserRole, reinterpret_cast<qulonglong>(hwnd));
-
-        // 窗口标题
-        QTableWidgetItem* titleItem = new QTableWidgetItem(title);
-        titleItem->setData(Qt::UserRole, reinterpret_cast<qulonglong>(hwnd));
-
-        // 窗口句柄
-        QTableWidgetItem* handleItem = new QTableWidgetItem(
-            QString::number(reinterpret_cast<qulonglong>(hwnd), 16).toUpper());
-
-        // 窗口类名
-        QTableWidgetItem* classItem = new QTableWidgetItem(className);
-
-        // 进程ID
-        QTableWidgetItem* pidItem = new QTableWidgetItem(QString::number(processId));
-
-        // 进程名
-        QTableWidgetItem* processItem = new QTableWidgetItem(processName);
-
-        hiddenWindowsTable->setItem(row, 0, iconItem);     // 图标
-        hiddenWindowsTable->setItem(row, 1, titleItem);    // 窗口标题
-        hiddenWindowsTable->setItem(row, 2, handleItem);   // 句柄
-        hiddenWindowsTable->setItem(row, 3, classItem);    // 类
-        hiddenWindowsTable->setItem(row, 4, pidItem);      // 进程ID
-        hiddenWindowsTable->setItem(row, 5, processItem);  // 进程名
-    }
+        hiddenList.append(qMakePair(hwnd, info));
+        });
 
-    hiddenWindowsTable->setSortingEnabled(true);
+    hiddenWindowsModel->setWindows(hiddenList);
 }
 
 void MainWindow::restoreSelectedHiddenWindow()
 {
-    int row = hiddenWindowsTable->currentRow();
+    int row = hiddenWindowsTable->currentIndex().row();
     if (row < 0) {
         QMessageBox::information(this, trc("MainWindow", "Information"),
             trc("MainWindow", "Please select a window to restore"));
         return;
     }
 
-    HWND hwnd = reinterpret_cast<HWND>(hiddenWindowsTable->item(row, 0)->data(Qt::UserRole).toULongLong());
+    HWND hwnd = windowAtRow(hiddenWindowsTable, row);
     if (!hwnd || !IsWindow(hwnd)) {
         QMessageBox::warning(this, trc("MainWindow", "Warning"),
             trc("MainWindow", "The selected window is no longer available"));
@@ -1649,23 +1360,21 @@ void MainWindow::restoreSelectedHiddenWindow()
 
     bool success = false;
 
-    // 尝试从系统托盘恢复
-    success = WindowsTrayManager::instance().restoreWindow(hwnd);
-
-    // 系统托盘恢复失败，尝试从应用托盘菜单恢复
-    if (!success && m_appTrayWindows.contains(hwnd)) {
+    // 按隐藏方式恢复；系统托盘恢复成功时由 trayWindowsChanged 刷新
+    const HiddenWindow* hidden = WindowsTrayManager::instance().hiddenWindow(hwnd);
+    if (hidden && hidden->store == HiddenWindowRecord::SystemTray) {
+        success = WindowsTrayManager::instance().restoreWindow(hwnd);
+    }
+    else if (hidden && hidden->store == HiddenWindowRecord::AppTray) {
         ShowWindow(hwnd, SW_SHOW);
         SetForegroundWindow(hwnd);
         removeWindowFromTrayMenu(hwnd);
-        success = true;
-    }
-
-    if (success) {
-        m_hiddenWindowOrder.removeAll(hwnd);
         refreshAllLists();
         updateTrayMenu();
+        success = true;
     }
-    else {
+
+    if (!success) {
         QMessageBox::warning(this, trc("MainWindow", "Error"),
             trc("MainWindow", "Failed to restore the window"));
     }
@@ -1676,9 +1385,12 @@ void MainWindow::onHiddenTableContextMenu(const QPoint& pos)
     if (!hiddenTableContextMenu) {
         hiddenTableContextMenu = new QMenu(this);
 
-        restoreHiddenAction = new QAction(trc("MainWindow", "Restore Window"), this);
-        restoreLastHiddenAction = new QAction(trc("MainWindow", "Restore Last Window"), this);
-        restoreAllHiddenAction = new QAction(trc("MainWindow", "Restore All Windows"), this);
+        restoreHiddenAction = new QAction(this);
+        trBind(restoreHiddenAction, &QAction::setText, "MainWindow", "Restore Window");
+        restoreLastHiddenAction = new QAction(this);
+        trBind(restoreLastHiddenAction, &QAction::setText, "MainWindow", "Restore Last Window");
+        restoreAllHiddenAction = new QAction(this);
+        trBind(restoreAllHiddenAction, &QAction::setText, "MainWindow", "Restore All Windows");
 
         hiddenTableContextMenu->addAction(restoreHiddenAction);
         hiddenTableContextMenu->addAction(restoreLastHiddenAction);
@@ -1695,35 +1407,43 @@ void MainWindow::onHiddenTableContextMenu(const QPoint& pos)
     HWND selectedHwnd = nullptr;
 
     if (row >= 0) {
-        hiddenWindowsTable->setCurrentCell(row, 0);
-        selectedHwnd = reinterpret_cast<HWND>(hiddenWindowsTable->item(row, 0)->data(Qt::UserRole).toULongLong());
+        hiddenWindowsTable->selectRow(row);
+        selectedHwnd = windowAtRow(hiddenWindowsTable, row);
     }
 
     // 根据状态更新菜单项
     restoreHiddenAction->setEnabled(selectedHwnd && IsWindow(selectedHwnd));
-    restoreLastHiddenAction->setEnabled(!m_hiddenWindowOrder.isEmpty());
+    restoreLastHiddenAction->setEnabled(WindowsTrayManager::instance().lastHidden() != nullptr);
 
     // 检查所有类型的隐藏窗口
-    auto systemHiddenWindows = WindowsTrayManager::instance().getHiddenWindows();
-    bool hasSystemHiddenWindows = !systemHiddenWindows.empty();
-    bool hasAppTrayHiddenWindows = !m_appTrayWindows.isEmpty();
-
-    restoreAllHiddenAction->setEnabled(hasSystemHiddenWindows || hasAppTrayHiddenWindows);
+    restoreAllHiddenAction->setEnabled(hasHiddenWindows());
 
     hiddenTableContextMenu->exec(hiddenWindowsTable->viewport()->mapToGlobal(pos));
 }
 
 void MainWindow::updateTrayMenu()
+{
+    m_invalidator->invalidate(UiInvalidator::TrayMenu);
+}
+
+void MainWindow::updateTrayMenuState()
 {
     // 安全检查
     if (!trayMenu || !restoreAllAction) {
         return;
     }
 
-    restoreLastAction->setEnabled(!m_hiddenWindowOrder.isEmpty());
+    // 窗口项由 TrayWindowMenu 增量维护，这里只更新固定动作的状态
+    const bool hasRecent = WindowsTrayManager::instance().lastHidden() != nullptr;
+    restoreLastAction->setEnabled(hasRecent);
+    restoreRecentAction->setEnabled(hasRecent);
+    restoreAllAction->setEnabled(hasHiddenWindows());
+}
 
-    // 更新菜单布局
-    updateTrayMenuLayout();
+bool MainWindow::hasHiddenWindows() const
+{
+    // 两种隐藏方式共用一张表，直接取计数
+    return WindowsTrayManager::instance().hiddenCount() > 0;
 }
 
 void MainWindow::hideToAppTray()
@@ -1742,6 +1462,11 @@ void MainWindow::hideToAppTray()
         return;
     }
 
+    // 已经以任一方式隐藏
+    if (WindowsTrayManager::instance().isHidden(hwnd)) {
+        return;
+    }
+
     // 检查是否是受保护的窗口
     wchar_t className[256];
     if (!GetClassName(hwnd, className, 256)) {
@@ -1765,23 +1490,11 @@ void MainWindow::hideToAppTray()
         }
     }
 
-    // 获取窗口标题
-    wchar_t title[256];
-    GetWindowText(hwnd, title, 256);
-    QString windowTitle = QString::fromWCharArray(title);
-
-    // 获取窗口图标
-    QIcon windowIcon = getWindowIcon(hwnd);
-
     // 隐藏窗口
     ShowWindow(hwnd, SW_HIDE);
 
-    // 记录隐藏顺序
-    m_hiddenWindowOrder.removeAll(hwnd);  // 先移除
-    m_hiddenWindowOrder.prepend(hwnd);    // 添加到开头
-
-    // 添加到托盘菜单（带图标）
-    addWindowToTrayMenu(hwnd, windowTitle, windowIcon);
+    // 添加到托盘菜单，同时登记到隐藏窗口表
+    addWindowToTrayMenu(hwnd);
 
     // 刷新显示
     refreshAllLists();
@@ -1791,211 +1504,42 @@ void MainWindow::hideToAppTray()
         trc("MainWindow", "Window hidden to app tray successfully"));
 }
 
-void MainWindow::addWindowToTrayMenu(HWND hwnd, const QString& title, const QIcon& icon)
+void MainWindow::addWindowToTrayMenu(HWND hwnd)
 {
-    if (!trayMenu) {
+    if (!m_trayWindowMenu) {
         qWarning() << "trayMenu is null, cannot add window";
         return;
     }
 
-    // 如果窗口已经存在，先移除
-    if (m_appTrayWindows.contains(hwnd)) {
-        QAction* oldAction = m_appTrayWindows[hwnd];
-        if (oldAction) {
-            trayMenu->removeAction(oldAction);
-            oldAction->deleteLater();
-        }
-        m_appTrayWindows.remove(hwnd);
-    }
-
-    // 获取或创建图标
-    QIcon windowIcon = icon;
-    if (windowIcon.isNull()) {
-        windowIcon = getWindowIcon(hwnd);
-    }
-
-    // 如果仍然没有图标，使用默认图标
-    if (windowIcon.isNull()) {
-        windowIcon = QApplication::style()->standardIcon(QStyle::SP_ComputerIcon);
-    }
-
-    // 创建显示标题
-    QString displayTitle = title;
-    if (displayTitle.isEmpty()) {
-        displayTitle = trc("MainWindow", "Unknown Window");
-    }
-
-    // 限制标题长度
-    if (displayTitle.length() > 40) {
-        displayTitle = displayTitle.left(37) + "...";
-    }
-
-    // 创建恢复该窗口的动作
-    QAction* restoreAction = new QAction(windowIcon, displayTitle, trayMenu);
-
-    // 使用 QVariantMap 存储完整窗口信息
-    QVariantMap windowData;
-    windowData["hwnd"] = reinterpret_cast<qulonglong>(hwnd);
-    windowData["title"] = title;
-    windowData["icon"] = windowIcon;
-
-    // 获取进程信息用于显示
-    DWORD processId;
-    GetWindowThreadProcessId(hwnd, &processId);
-    QString processName = "Unknown";
-
-    HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-    if (process) {
-        wchar_t processPath[MAX_PATH] = L"";
-        if (GetModuleFileNameEx(process, NULL, processPath, MAX_PATH)) {
-            processName = QFileInfo(QString::fromWCharArray(processPath)).fileName();
-        }
-        CloseHandle(process);
+    // 先登记到隐藏窗口表（已登记的不重复记录），菜单项直接使用登记时采集的信息
+    WindowsTrayManager& manager = WindowsTrayManager::instance();
+    manager.recordAppTrayChange(hwnd, true);
+    const HiddenWindow* hidden = manager.hiddenWindow(hwnd);
+    if (!hidden || hidden->store != HiddenWindowRecord::AppTray) {
+        return;
     }
-    windowData["processName"] = processName;
-
-    restoreAction->setData(windowData);
-
-    // 设置工具提示显示更详细的信息
-    QString toolTip = QString("%1\nProcess: %2\nHandle: 0x%3")
-        .arg(title)
-        .arg(processName)
-        .arg(QString::number(reinterpret_cast<qulonglong>(hwnd), 16).toUpper());
-    restoreAction->setToolTip(toolTip);
-
-    connect(restoreAction, &QAction::triggered, this, &MainWindow::restoreWindowFromAppTray);
 
-    // 添加到映射中
-    m_appTrayWindows[hwnd] = restoreAction;
+    // 菜单项在打开菜单时才生成，这里只记录标题、图标键和进程ID
+    TrayWindowMenu::Item item;
+    item.hwnd = hwnd;
+    item.title = hidden->info.title;
+    item.processId = hidden->info.processId;
+    item.iconKey = hidden->info.iconKey;
+    m_trayWindowMenu->insert(item);
 
-    // 更新菜单布局
-    updateTrayMenuLayout();
+    m_invalidator->invalidate(UiInvalidator::TrayMenu);
 }
 
 void MainWindow::removeWindowFromTrayMenu(HWND hwnd)
 {
-    if (!trayMenu) {
-        return;
-    }
-
-    if (m_appTrayWindows.contains(hwnd)) {
-        QAction* action = m_appTrayWindows[hwnd];
-        if (action) {
-            trayMenu->removeAction(action);
-            action->deleteLater();
-        }
-        m_appTrayWindows.remove(hwnd);
-        updateTrayMenuLayout();
-    }
-}
-
-void MainWindow::updateTrayMenuLayout()
-{
-    if (!trayMenu) {
-        qWarning() << "trayMenu is null!";
-        return;
-    }
-
-    // 清除现有的隐藏窗口动作
-    QList<QAction*> actions = trayMenu->actions();
-
-    // 找到分隔符的位置，保留固定动作
-    int firstSeparatorIndex = -1;
-    int secondSeparatorIndex = -1;
-
-    for (int i = 0; i < actions.size(); ++i) {
-        if (actions[i]->isSeparator()) {
-            if (firstSeparatorIndex == -1) {
-                firstSeparatorIndex = i;
-            }
-            else if (secondSeparatorIndex == -1) {
-                secondSeparatorIndex = i;
-                break;
-            }
-        }
-    }
-
-    // 移除第一个分隔符和第二个分隔符之间的所有动作
-    if (firstSeparatorIndex != -1 && secondSeparatorIndex != -1) {
-        for (int i = secondSeparatorIndex - 1; i > firstSeparatorIndex; --i) {
-            QAction* action = actions[i];
-            // 只移除不是固定动作的项
-            if (action != showAction &&
-                action != restoreLastAction &&
-                action != restoreAllAction &&
-                action != quitAction &&
-                !action->isSeparator()) {
-                trayMenu->removeAction(action);
-            }
-        }
-    }
-
-    // 清理无效的窗口
-    QList<HWND> windowsToRemove;
-    for (auto it = m_appTrayWindows.begin(); it != m_appTrayWindows.end(); ++it) {
-        HWND hwnd = it.key();
-        QAction* action = it.value();
-
-        if (!hwnd || !IsWindow(hwnd)) {
-            windowsToRemove.append(hwnd);
-            if (action) {
-                trayMenu->removeAction(action);
-                action->deleteLater();
-            }
-        }
-    }
-
-    // 移除无效窗口
-    for (HWND hwnd : windowsToRemove) {
-        m_appTrayWindows.remove(hwnd);
-    }
-
-    // 如果有隐藏窗口，在第一个分隔符后添加它们
-    if (!m_appTrayWindows.isEmpty()) {
-        QList<QAction*> actions = trayMenu->actions();
-        int targetSeparatorIndex = -1;
-        int separatorCount = 0;
-
-        for (int i = 0; i < actions.size(); ++i) {
-            if (actions[i]->isSeparator()) {
-                separatorCount++;
-                if (separatorCount == 2) { // 第二个分隔符
-                    targetSeparatorIndex = i;
-                    break;
-                }
-            }
-        }
-
-        if (targetSeparatorIndex != -1) {
-            // 在第二个分隔符之前添加隐藏窗口
-            for (auto it = m_appTrayWindows.begin(); it != m_appTrayWindows.end(); ++it) {
-                HWND hwnd = it.key();
-                QAction* action = it.value();
-
-                if (hwnd && IsWindow(hwnd) && action) {
-                    trayMenu->insertAction(actions[targetSeparatorIndex], action);
-                }
-            }
-        }
+    if (m_trayWindowMenu && m_trayWindowMenu->remove(hwnd)) {
+        WindowsTrayManager::instance().recordAppTrayChange(hwnd, false);
+        m_invalidator->invalidate(UiInvalidator::TrayMenu);
     }
-
-    // 更新 restoreAllAction 状态
-    auto systemHiddenWindows = WindowsTrayManager::instance().getHiddenWindows();
-    restoreAllAction->setEnabled(!systemHiddenWindows.empty() || !m_appTrayWindows.isEmpty());
 }
 
-void MainWindow::restoreWindowFromAppTray()
+void MainWindow::restoreWindowFromAppTray(HWND hwnd)
 {
-    QAction* action = qobject_cast<QAction*>(sender());
-    if (!action) {
-        return;
-    }
-
-    // 从 QVariantMap 中获取窗口信息
-    QVariantMap windowData = action->data().toMap();
-    HWND hwnd = reinterpret_cast<HWND>(windowData["hwnd"].toULongLong());
-    QString title = windowData["title"].toString();
-
     if (!hwnd || !IsWindow(hwnd)) {
         QMessageBox::warning(this, trc("MainWindow", "Warning"),
             trc("MainWindow", "The selected window is no longer available"));
@@ -2011,164 +1555,144 @@ void MainWindow::restoreWindowFromAppTray()
     // 从菜单中移除
     removeWindowFromTrayMenu(hwnd);
 
-    m_hiddenWindowOrder.removeAll(hwnd);
-
     // 刷新显示
     refreshAllLists();
     updateTrayMenu();
 
-    qDebug() << "Window restored from app tray:" << title
+    qDebug() << "Window restored from app tray:"
         << "Handle:" << QString::number(reinterpret_cast<qulonglong>(hwnd), 16);
 }
 
 void MainWindow::restoreLastWindow()
 {
-    if (m_hiddenWindowOrder.isEmpty()) {
+    if (!WindowsTrayManager::instance().lastHidden()) {
         QMessageBox::information(this, trc("MainWindow", "Information"),
             trc("MainWindow", "No hidden windows to restore"));
         return;
     }
 
-    // 获取最近隐藏的窗口
-    HWND lastHwnd = m_hiddenWindowOrder.takeFirst();  // 从列表中移除
-
-    if (!lastHwnd || !IsWindow(lastHwnd)) {
-        // 如果窗口无效，递归尝试下一个
-        m_hiddenWindowOrder.removeAll(lastHwnd);
-        restoreLastWindow();
+    std::vector<HWND> restored = restoreRecentWindows(1);
+    if (restored.empty()) {
+        QMessageBox::warning(this, trc("MainWindow", "Error"),
+            trc("MainWindow", "Failed to restore the last window"));
         return;
     }
 
-    bool success = false;
-
-    // 尝试从系统托盘恢复
-    success = WindowsTrayManager::instance().restoreWindow(lastHwnd);
-
-    // 系统托盘恢复失败，尝试从应用托盘菜单恢复
-    if (!success && m_appTrayWindows.contains(lastHwnd)) {
-        ShowWindow(lastHwnd, SW_SHOW);
-        SetForegroundWindow(lastHwnd);
-        removeWindowFromTrayMenu(lastHwnd);
-        success = true;
-    }
-
-    if (success) {
-        refreshAllLists();
-        updateTrayMenu();
-
-        // 显示成功消息
-        wchar_t title[256];
-        if (GetWindowText(lastHwnd, title, 256) > 0) {
-            QMessageBox::information(this, trc("MainWindow", "Success"),
-                trc("MainWindow", "Restored window: %1").arg(QString::fromWCharArray(title)));
-        }
-    }
-    else {
-        // 恢复失败，将窗口重新放回列表开头
-        m_hiddenWindowOrder.prepend(lastHwnd);
-        QMessageBox::warning(this, trc("MainWindow", "Error"),
-            trc("MainWindow", "Failed to restore the last window"));
+    // 显示成功消息
+    wchar_t title[256];
+    if (GetWindowText(restored.front(), title, 256) > 0) {
+        QMessageBox::information(this, trc("MainWindow", "Success"),
+            trc("MainWindow", "Restored window: %1").arg(QString::fromWCharArray(title)));
     }
 }
 
-QIcon MainWindow::getWindowIcon(HWND hwnd) const
+void MainWindow::restoreLastWindows()
 {
-    if (!hwnd || !IsWindow(hwnd)) {
-        return QIcon();
+    if (!WindowsTrayManager::instance().lastHidden()) {
+        QMessageBox::information(this, trc("MainWindow", "Information"),
+            trc("MainWindow", "No hidden windows to restore"));
+        return;
     }
 
-    QIcon windowIcon;
-
-    // 尝试获取窗口的小图标
-    HICON hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
-
-    // 尝试获取窗口类的小图标
-    if (!hIcon) {
-        hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
-    }
+    restoreRecentWindows(restoreCountSpin->value());
+}
 
-    // 尝试获取窗口的大图标
-    if (!hIcon) {
-        hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_BIG, 0);
-    }
+std::vector<HWND> MainWindow::restoreRecentWindows(int count)
+{
+    WindowsTrayManager& manager = WindowsTrayManager::instance();
 
-    // 尝试获取窗口类的大图标
-    if (!hIcon) {
-        hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICON);
-    }
+    // 两种托盘的恢复合并为一次日志提交、一次通知
+    WindowsTrayManager::Batch batch;
 
-    // 从进程文件获取图标
-    if (!hIcon) {
-        DWORD processId;
-        GetWindowThreadProcessId(hwnd, &processId);
+    // 从最近隐藏的开始取 count 个仍然存在的窗口，途中遇到的已销毁窗口一并清理
+    std::vector<HWND> systemWindows;
+    std::vector<HWND> restored;
+    for (HWND hwnd : manager.recentlyHidden()) {
+        if (static_cast<int>(restored.size()) >= count) {
+            break;
+        }
 
-        if (processId) {
-            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-            if (hProcess) {
-                wchar_t exePath[MAX_PATH];
-                if (GetModuleFileNameEx(hProcess, NULL, exePath, MAX_PATH)) {
-                    // 提取第一个图标
-                    hIcon = ExtractIcon(GetModuleHandle(NULL), exePath, 0);
-                }
-                CloseHandle(hProcess);
+        const HiddenWindow* hidden = manager.hiddenWindow(hwnd);
+        const bool alive = IsWindow(hwnd) != FALSE;
+        if (hidden && hidden->store == HiddenWindowRecord::SystemTray) {
+            // 已销毁的窗口交给 restoreWindows 清理图标和记录
+            systemWindows.push_back(hwnd);
+        }
+        else if (hidden && hidden->store == HiddenWindowRecord::AppTray) {
+            if (alive) {
+                ShowWindow(hwnd, SW_SHOW);
             }
+            removeWindowFromTrayMenu(hwnd);
+        }
+        else {
+            continue;
         }
-    }
 
-    // 使用默认应用程序图标
-    if (!hIcon) {
-        hIcon = LoadIcon(NULL, IDI_APPLICATION);
+        if (alive) {
+            restored.push_back(hwnd);
+        }
     }
 
-    // 将 HICON 转换为 QIcon
-    if (hIcon) {
-        QPixmap pixmap = QPixmap::fromImage(QImage::fromHICON(hIcon));
-        if (!pixmap.isNull()) {
-            windowIcon = QIcon(pixmap);
-
-            // 清理提取的图标资源
-            if (hIcon != (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0) &&
-                hIcon != (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM) &&
-                hIcon != (HICON)SendMessage(hwnd, WM_GETICON, ICON_BIG, 0) &&
-                hIcon != (HICON)GetClassLongPtr(hwnd, GCLP_HICON) &&
-                hIcon != LoadIcon(NULL, IDI_APPLICATION)) {
-                DestroyIcon(hIcon);
-            }
-        }
+    // 只激活最近隐藏的那个窗口
+    if (!restored.empty()) {
+        manager.setFocusTarget(restored.front());
     }
+    manager.restoreWindows(systemWindows);
 
-    return windowIcon;
+    refreshAllLists();
+    updateTrayMenu();
+    return restored;
 }
 
-void MainWindow::updateTrayMenuIcons()
+void MainWindow::setupHotkeys()
 {
-    // 更新所有托盘菜单项的图标
-    for (auto it = m_appTrayWindows.begin(); it != m_appTrayWindows.end(); ++it) {
-        HWND hwnd = it.key();
-        QAction* action = it.value();
-
-        if (hwnd && IsWindow(hwnd) && action) {
-            // 检查当前图标是否有效
-            if (action->icon().isNull()) {
-                QIcon newIcon = getWindowIcon(hwnd);
-                if (!newIcon.isNull()) {
-                    action->setIcon(newIcon);
+    HotkeyManager& hotkeys = HotkeyManager::instance();
 
-                    // 更新存储的数据
-                    QVariantMap windowData = action->data().toMap();
-                    windowData["icon"] = newIcon;
-                    action->setData(windowData);
-                }
+    // 每个动作直接绑定到热键槽位，触发时按热键 ID 分派，不再比较字符串
+    // 动作保存在单例里，窗口销毁后即使析构前还有排队的触发也不会访问已释放的对象
+    QPointer<MainWindow> self(this);
+    auto bind = [self, &hotkeys](const QString& id, HotkeyManager::Action action) {
+        hotkeys.setAction(id, [self, action](HWND foreground) {
+            if (!self) {
+                return;
             }
+            self->m_refreshScheduler->wake();
+            action(foreground);
+            });
+    };
+
+    // 使用按下热键时的前台窗口，GUI 线程处理晚了也不会作用到错误的窗口
+    bind("minimize_active", [this](HWND foreground) { minimizeToTray(foreground); });
+    bind("restore_last", [this](HWND) { restoreRecentWindows(1); });
+    bind("restore_recent", [this](HWND) { restoreRecentWindows(restoreCountSpin->value()); });
+    bind("restore_all", [this](HWND) { restoreAllWindows(); });
+    bind("show_window", [this](HWND) { showWindow(); });
+    bind("toggle_main_window", [this](HWND foreground) {
+        if (isVisible() && foreground == (HWND)winId()) {
+            hide();
         }
-    }
-}
+        else {
+            showWindow();
+        }
+        });
+    bind("toggle_mute", [this](HWND foreground) {
+        DWORD processId = 0;
+        if (foreground && GetWindowThreadProcessId(foreground, &processId)) {
+            toggleProcessMute(processId);
+        }
+        });
+    bind("toggle_on_top", [this](HWND foreground) {
+        if (foreground && IsWindow(foreground) && foreground != (HWND)winId()) {
+            setWindowOnTop(foreground, !isWindowOnTop(foreground));
+        }
+        });
+    bind("opacity_up", [this](HWND foreground) { stepWindowOpacity(foreground, OpacityStepPercent); });
+    bind("opacity_down", [this](HWND foreground) { stepWindowOpacity(foreground, -OpacityStepPercent); });
 
-void MainWindow::setupHotkeys()
-{
-    // 连接热键信号
-    connect(&HotkeyManager::instance(), &HotkeyManager::hotkeyTriggered,
-        this, &MainWindow::onHotkeyTriggered);
+    // 最小化热键在消息线程上立即隐藏前台窗口，不等 GUI 线程
+    hotkeys.setImmediateAction("minimize_active", [](HWND foreground) {
+        WindowsTrayManager::hideImmediately(foreground);
+        });
 
     // 加载保存的热键设置
     loadHotkeySettings();
@@ -2176,44 +1700,28 @@ void MainWindow::setupHotkeys()
 
 void MainWindow::loadHotkeySettings()
 {
-    QSettings settings(getConfigPath(), QSettings::IniFormat);
-    settings.beginGroup("Hotkeys");
+    for (const HotkeyActionDef& action : HotkeyActions) {
+        QString key = m_settings->value(QString("Hotkeys/") + action.id, action.defaultSequence).toString();
+        QKeySequence sequence = QKeySequence::fromString(key);
 
-    QString minimizeKey = settings.value("minimize_active", "Win+Shift+Z").toString();
-    QKeySequence minimizeSequence = QKeySequence::fromString(minimizeKey);
-
-    if (!minimizeSequence.isEmpty()) {
-        HotkeyManager::instance().registerHotkey("minimize_active", minimizeSequence);
+        if (!sequence.isEmpty()) {
+            HotkeyManager::instance().registerHotkey(action.id, sequence);
+        }
     }
 
-    settings.endGroup();
-
     updateMinimizeHotkeyDisplay();
 }
 
 void MainWindow::saveHotkeySettings()
 {
-    QSettings settings(getConfigPath(), QSettings::IniFormat);
-
-    settings.beginGroup("Hotkeys");
-
-    // 保存所有热键
+    // 写入每个动作的当前热键；已清除的热键写为空，重启后不会恢复成旧值或默认值
     auto hotkeys = HotkeyManager::instance().getAllHotkeys();
-    for (auto it = hotkeys.begin(); it != hotkeys.end(); ++it) {
-        settings.setValue(it.key(), it.value().toString());
-    }
-
-    settings.endGroup();
-}
-
-void MainWindow::onHotkeyTriggered(const QString& id)
-{
-    if (id == "minimize_active") {
-        minimizeActiveToTray();
-    }
-    // 可以添加更多热键处理
-    else if (id == "show_window") {
-        showWindow();
+    for (const HotkeyActionDef& action : HotkeyActions) {
+        const QString key = QString("Hotkeys/") + action.id;
+        const QString sequence = hotkeys.value(action.id).toString();
+        if (m_settings->value(key, action.defaultSequence).toString() != sequence) {
+            m_settings->setValue(key, sequence);
+        }
     }
 }
 
@@ -2345,10 +1853,7 @@ void MainWindow::cancelHotkeySetting()
 
 void MainWindow::onOpacitySliderChanged(int val)
 {
-    int row = windowsTable->currentRow();
-    if (row < 0) return;
-
-    HWND hwnd = reinterpret_cast<HWND>(windowsTable->item(row, 0)->data(Qt::UserRole).toULongLong());
+    HWND hwnd = getSelectedWindow();
     if (!hwnd || !IsWindow(hwnd)) return;
 
     BYTE alpha = static_cast<BYTE>(val / 0.390625 - 1);
@@ -2373,10 +1878,9 @@ void MainWindow::toggleMuteWindow() {
     GetWindowThreadProcessId(hwnd, &processId);
 
     bool current = muteStates.value(processId, false);
-    bool success = VolumeControl::SetProcessMuteWithTimeout(processId, !current, 1000);
+    bool success = toggleProcessMute(processId);
 
     if (success) {
-        muteStates[processId] = !current;
         QMessageBox::information(this, trc("MainWindow", "Success"),
             trc("MainWindow", "Window %1.").arg(current ? "unmuted" : "muted"));
     }
@@ -2395,15 +1899,10 @@ void MainWindow::openFileLocation()
     GetWindowThreadProcessId(hwnd, &pid);
     if (!pid) return;
 
-    HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-    if (!hProc) return;
-    wchar_t path[MAX_PATH]{};
-    DWORD len = MAX_PATH;
-    QueryFullProcessImageNameW(hProc, 0, path, &len);
-    CloseHandle(hProc);
-    if (!len) return;
+    QString exePath = ProcessInfoCache::instance().processPath(pid);
+    if (exePath.isEmpty()) return;
 
-    QString fullPath = QDir::toNativeSeparators(QString::fromWCharArray(path));
+    QString fullPath = QDir::toNativeSeparators(exePath);
     if (!QFileInfo::exists(fullPath)) return;
 
     // 选择文件
@@ -2420,21 +1919,47 @@ void MainWindow::showFileProperties()
     GetWindowThreadProcessId(hwnd, &pid);
     if (!pid) return;
 
-    HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-    if (!hProc) return;
-    wchar_t path[MAX_PATH]{};
-    DWORD len = MAX_PATH;
-    QueryFullProcessImageNameW(hProc, 0, path, &len);
-    CloseHandle(hProc);
-    if (!len) return;
+    QString exePath = ProcessInfoCache::instance().processPath(pid);
+    if (exePath.isEmpty() || !QFileInfo::exists(exePath)) return;
 
-    if (!QFileInfo::exists(QString::fromWCharArray(path))) return;
+    std::wstring path = exePath.toStdWString();
 
     SHELLEXECUTEINFO sei{};
     sei.cbSize = sizeof(SHELLEXECUTEINFO);
-    sei.lpFile = path;
+    sei.lpFile = path.c_str();
     sei.nShow = SW_SHOW;
     sei.fMask = SEE_MASK_INVOKEIDLIST;
     sei.lpVerb = L"properties";
     ShellExecuteExW(&sei);
+}
+
+bool MainWindow::toggleProcessMute(DWORD processId)
+{
+    bool current = muteStates.value(processId, false);
+    if (!VolumeControl::SetProcessMuteWithTimeout(processId, !current, 1000)) {
+        return false;
+    }
+    muteStates[processId] = !current;
+    return true;
+}
+
+void MainWindow::stepWindowOpacity(HWND hwnd, int percent)
+{
+    if (!hwnd || !IsWindow(hwnd) || hwnd == (HWND)winId()) {
+        return;
+    }
+
+    BYTE alpha = 255;
+    DWORD flags = 0;
+    LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+    if (!(exStyle & WS_EX_LAYERED)) {
+        SetWindowLongPtr(hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+    }
+    else if (!GetLayeredWindowAttributes(hwnd, nullptr, &alpha, &flags) || !(flags & LWA_ALPHA)) {
+        alpha = 255;
+    }
+
+    // 不低于 10%，避免窗口完全看不见
+    int value = qBound(26, alpha + percent * 255 / 100, 255);
+    SetLayeredWindowAttributes(hwnd, 0, static_cast<BYTE>(value), LWA_ALPHA);
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <QMainWindow>
 #include <QCloseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QSystemTrayIcon>
 #include <QAction>
 #include <QMenu>
@@ -11,7 +13,7 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QTabWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QGroupBox>
 #include <QCheckBox>
 #include <QSpinBox>
@@ -19,7 +21,20 @@
 #include <QTimer>
 #include <QMap>
 #include <QLineEdit>
+#include <QPlainTextEdit>
+#include <vector>
 #include <windows.h>
+#include "windowinfo.h"
+#include "translator.h"
+
+class WindowSnapshotProducer;
+class WindowTableModel;
+class RefreshScheduler;
+class UiInvalidator;
+class TranslationBinder;
+class SettingsStore;
+class TrayWindowMenu;
+struct TrayChange;
 
 class MainWindow : public QMainWindow
 {
@@ -29,7 +44,8 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
     ~MainWindow();
 
-    QString trc(const char* context, const char* source) const;
+    // 键在编译期算好，见 mainwindow.cpp 中的 trc 宏
+    QString trc(quint64 key, const char* source) const { return Translator::instance().translate(key, source); }
 
 private slots:
     void minimizeActiveToTray();
@@ -48,7 +64,8 @@ private slots:
     void onLanguageChanged();
     void onStartWithSystemChanged();
     void onMaxWindowsChanged();
-    void autoSaveSettings();
+    void onMenuEntriesChanged();
+    void onRestoreCountChanged();
     void onAlwaysOnTopChanged();
     void highlightWindow();
     void toggleWindowOnTop();
@@ -57,18 +74,22 @@ private slots:
     void onHiddenTableContextMenu(const QPoint& pos);
     void updateTrayMenu();
     void hideToAppTray();
-    void restoreWindowFromAppTray();
+    void restoreWindowFromAppTray(HWND hwnd);
     void restoreLastWindow();
-    void onHotkeyTriggered(const QString& id);
+    void restoreLastWindows();
     void startSetMinimizeHotkey();
     void clearMinimizeHotkey();
     void updateMinimizeHotkeyDisplay();
     void onOpacitySliderChanged(int value);
     void openFileLocation();
     void showFileProperties();
+    void updateDiagnostics();
+    void updateRefreshStatus();
 
 protected:
     void closeEvent(QCloseEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
     bool eventFilter(QObject* obj, QEvent* event) override;
 
 private:
@@ -76,7 +97,6 @@ private:
     void setupUI();
     void setupConnections();
     void loadSettings();
-    void saveSettings();
 
     void refreshWindowsTable();
     void createContextMenu();
@@ -88,13 +108,19 @@ private:
 
     void flashWindowInTaskbar(HWND hwnd);
 
+    void minimizeToTray(HWND hwnd);
+
     bool isWindowOnTop(HWND hwnd);
     void setWindowOnTop(HWND hwnd, bool onTop);
 
-    void addWindowToTrayMenu(HWND hwnd, const QString& title, const QIcon& icon = QIcon());
+    void onTrayWindowsChanged(const TrayChange& change);
+    void updateTrayMenuState();
+    bool hasHiddenWindows() const;
+
+    void addWindowToTrayMenu(HWND hwnd);
     void removeWindowFromTrayMenu(HWND hwnd);
-    void updateTrayMenuLayout();
-    void updateTrayMenuIcons();
+    // 按最近隐藏顺序恢复至多 count 个窗口，返回实际恢复的窗口
+    std::vector<HWND> restoreRecentWindows(int count);
 
     void setupHotkeys();
     void saveHotkeySettings();
@@ -104,33 +130,25 @@ private:
     void cancelHotkeySetting();
 
     void toggleMuteWindow();
+    bool toggleProcessMute(DWORD processId);
+    void stepWindowOpacity(HWND hwnd, int percent);
 
-    QIcon getWindowIcon(HWND hwnd) const;
-
-    struct WindowInfo {
-        QString title;
-        QString processName;
-        QString className;
-        DWORD processId;
-        HWND hwnd;
-        bool isHidden;
-        bool isVisible;
-        QIcon icon;
-    };
-    QList<QPair<HWND, WindowInfo>> getAllWindowsInfo() const;
-    QList<QPair<HWND, WindowInfo>> m_lastWindowsInfo;
-    QList<HWND> m_hiddenWindowOrder;
+
+    WindowSnapshotProducer* m_snapshotProducer = nullptr;
     QMap<DWORD, bool> muteStates;
 
     // 配置文件路径
     QString getConfigPath() const;
     HWND getSelectedWindow() const;
+    HWND windowAtRow(const QTableView* view, int row) const;
+    QStringList tableHeaderLabels() const;
 
     // UI 组件
     QTabWidget* tabWidget;
 
     // 主页面组件
-    QTableWidget* windowsTable;
+    QTableView* windowsTable;
+    WindowTableModel* windowsModel;
 
     // 主页面右键菜单
     QMenu* contextMenu;
@@ -151,7 +169,8 @@ private:
     QLabel* opacityLabel;
 
     // 隐藏窗口页面组件
-    QTableWidget* hiddenWindowsTable;
+    QTableView* hiddenWindowsTable;
+    WindowTableModel* hiddenWindowsModel;
 
 	// 隐藏窗口页面右键菜单
     QMenu* hiddenTableContextMenu;
@@ -163,6 +182,8 @@ private:
     QCheckBox* startWithSystemCheck;
     QCheckBox* enableHotkeyCheck;
     QSpinBox* maxWindowsSpin;
+    QSpinBox* menuEntriesSpin;
+    QSpinBox* restoreCountSpin;
     QComboBox* languageCombo;
     QPushButton* saveSettingsButton;
     QCheckBox* alwaysOnTopCheck;
@@ -171,18 +192,26 @@ private:
 
     // 关于页面组件
     QLabel* aboutLabel;
+    QPlainTextEdit* diagnosticsView;
 
     // 托盘相关
     QSystemTrayIcon* trayIcon;
     QMenu* trayMenu;
     QAction* showAction;
-    QMap<HWND, QAction*> m_appTrayWindows;
+    TrayWindowMenu* m_trayWindowMenu;
     QAction* restoreLastAction;
+    QAction* restoreRecentAction;
     QAction* restoreAllAction;
     QAction* quitAction;
 
-    // 定时刷新计时器
-    QTimer* refreshTimer;
+    // 自适应对账调度器（窗口事件的兜底）
+    RefreshScheduler* m_refreshScheduler;
+
+    // 表格和托盘菜单的合并刷新
+    UiInvalidator* m_invalidator;
+    TranslationBinder* m_translations;
+    SettingsStore* m_settings;
+    QLabel* refreshStatusLabel;
 
     QCheckBox* autoRefreshCheck;
     QSpinBox* refreshIntervalSpin;
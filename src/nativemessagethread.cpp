@@ -0,0 +1,164 @@
+#include "nativemessagethread.h"
+#include "diagnostics.h"
+#include <QDebug>
+#include <chrono>
+
+// 静态成员初始化
+NativeMessageThread* NativeMessageThread::s_instance = nullptr;
+
+NativeMessageThread& NativeMessageThread::instance()
+{
+    if (!s_instance) {
+        s_instance = new NativeMessageThread();
+    }
+    return *s_instance;
+}
+
+NativeMessageThread::NativeMessageThread()
+{
+    Diagnostics::instance().registerSource("Native messages", [this]() {
+        return statsString();
+        });
+}
+
+bool NativeMessageThread::startThread()
+{
+    if (isRunning()) {
+        return m_control != nullptr;
+    }
+
+    // 线程大部分时间阻塞在 GetMessage 上，提高优先级只影响消息到达后的调度
+    start(QThread::HighestPriority);
+    m_ready.acquire();
+
+    if (!m_control) {
+        qWarning() << "Failed to create native message window";
+        wait();
+        return false;
+    }
+    return true;
+}
+
+void NativeMessageThread::stopThread()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    if (m_control) {
+        PostMessage(m_control, WM_CLOSE, 0, 0);
+    }
+    wait();
+}
+
+void NativeMessageThread::run()
+{
+    // 控制窗口：接收跨线程同步调用和退出请求
+    WNDCLASS wc = {};
+    wc.lpfnWndProc = controlProc;
+    wc.hInstance = GetModuleHandle(nullptr);
+    wc.lpszClassName = L"NativeMessageThreadClass";
+    RegisterClass(&wc);
+
+    m_control = CreateWindow(
+        wc.lpszClassName,
+        L"Native Message Thread",
+        0, 0, 0, 0, 0,
+        HWND_MESSAGE,
+        nullptr,
+        GetModuleHandle(nullptr),
+        this
+    );
+    m_threadId = GetCurrentThreadId();
+    m_ready.release();
+
+    if (!m_control) {
+        m_threadId = 0;
+        return;
+    }
+
+    MSG msg;
+    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+        DispatchMessage(&msg);
+    }
+
+    DestroyWindow(m_control);
+    m_control = nullptr;
+    m_threadId = 0;
+}
+
+LRESULT CALLBACK NativeMessageThread::controlProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+    switch (uMsg) {
+    case WM_INVOKE:
+        (*reinterpret_cast<const std::function<void()>*>(lParam))();
+        return 0;
+
+    case WM_CLOSE:
+        PostQuitMessage(0);
+        return 0;
+
+    default:
+        return DefWindowProc(hwnd, uMsg, wParam, lParam);
+    }
+}
+
+void NativeMessageThread::invoke(const std::function<void()>& fn)
+{
+    if (!m_control || isCurrentThread()) {
+        fn();
+        return;
+    }
+    SendMessage(m_control, WM_INVOKE, 0, reinterpret_cast<LPARAM>(&fn));
+}
+
+void NativeMessageThread::post(const Event& event)
+{
+    if (!m_queue.push(event)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_posted.fetch_add(1, std::memory_order_relaxed);
+
+    // GUI 线程还没处理上一次唤醒时不再重复投递
+    if (!m_wakePending.exchange(true)) {
+        QMetaObject::invokeMethod(this, [this]() { drain(); }, Qt::QueuedConnection);
+    }
+}
+
+void NativeMessageThread::setHandler(Event::Type type, std::function<void(const Event&)> handler)
+{
+    m_handlers[type] = std::move(handler);
+}
+
+void NativeMessageThread::drain()
+{
+    // 先清除标记再取队列：取空之后才入队的事件会触发新的唤醒
+    m_wakePending.store(false);
+    ++m_wakeups;
+
+    Event event;
+    while (m_queue.pop(event)) {
+        m_lastLatencyNs = nowNs() - event.timestampNs;
+        m_maxLatencyNs = qMax(m_maxLatencyNs, m_lastLatencyNs);
+        ++m_delivered;
+
+        if (m_handlers[event.type]) {
+            m_handlers[event.type](event);
+        }
+    }
+}
+
+qint64 NativeMessageThread::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString NativeMessageThread::statsString() const
+{
+    return QString("running=%1 posted=%2 dropped=%3 delivered=%4 wakeups=%5 latency=%6us max=%7us")
+        .arg(isRunning() ? "yes" : "no")
+        .arg(m_posted.load()).arg(m_dropped.load()).arg(m_delivered).arg(m_wakeups)
+        .arg(m_lastLatencyNs / 1000).arg(m_maxLatencyNs / 1000);
+}
\ No newline at end of file
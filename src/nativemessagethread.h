@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QThread>
+#include <QSemaphore>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <windows.h>
+#include "spscqueue.h"
+
+// 原生消息线程
+// 托盘图标和热键的消息窗口建在这个独立的高优先级线程上，运行纯 Win32 消息循环，
+// GUI 线程忙于刷新表格或停在模态对话框里时，WM_HOTKEY 和托盘消息照样立即处理。
+// 需要 GUI 线程处理的通知写入无锁单生产者队列，每批只唤醒一次 GUI 线程。
+class NativeMessageThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    static NativeMessageThread& instance();
+
+    // 投递给 GUI 线程的通知
+    struct Event {
+        enum Type : uint8_t { Hotkey = 0, TrayIcon = 1, TypeCount };
+
+        Type type = Hotkey;
+        UINT code = 0;              // 热键 ID，或托盘事件（WM_LBUTTONDBLCLK 等）
+        UINT iconId = 0;            // 托盘图标 ID
+        HWND foreground = nullptr;  // 消息到达时的前台窗口
+        qint64 timestampNs = 0;     // 消息到达时间，用于统计延迟
+    };
+
+    // 启动线程并等待消息窗口就绪；可重复调用
+    bool startThread();
+    // 退出消息循环并等待线程结束，线程上的窗口随之销毁
+    void stopThread();
+
+    bool isCurrentThread() const { return GetCurrentThreadId() == m_threadId; }
+
+    // 在消息线程上同步执行。窗口的创建/销毁和 RegisterHotKey 必须在窗口所属线程调用；
+    // 线程未运行时直接在调用线程上执行
+    void invoke(const std::function<void()>& fn);
+
+    // 只能在消息线程上调用
+    void post(const Event& event);
+
+    // 通知在 GUI 线程上按类型分发
+    void setHandler(Event::Type type, std::function<void(const Event&)> handler);
+
+    static qint64 nowNs();
+
+    QString statsString() const;
+
+protected:
+    void run() override;
+
+private:
+    NativeMessageThread();
+
+    void drain();
+
+    static LRESULT CALLBACK controlProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+    HWND m_control = nullptr;
+    DWORD m_threadId = 0;
+    QSemaphore m_ready;
+
+    SpscQueue<Event, 256> m_queue;
+    std::atomic<bool> m_wakePending{ false };
+    std::function<void(const Event&)> m_handlers[Event::TypeCount];
+
+    std::atomic<quint64> m_posted{ 0 };
+    std::atomic<quint64> m_dropped{ 0 };
+    quint64 m_wakeups = 0;
+    quint64 m_delivered = 0;
+    qint64 m_lastLatencyNs = 0;
+    qint64 m_maxLatencyNs = 0;
+
+    static NativeMessageThread* s_instance;
+
+    static constexpr UINT WM_INVOKE = WM_APP + 1;
+};
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+// 窗口注册表、快照、进程缓存等模块接口中用到的 Win32 基本类型。
+// Windows 上直接来自 <windows.h>；其他平台只声明这几个类型，
+// 使这些模块和它们的测试（模拟事件源、合成后端等）可以脱离 Win32 编译运行
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+
+struct HWND__;
+struct HICON__;
+typedef HWND__* HWND;
+typedef HICON__* HICON;
+typedef uint32_t DWORD;
+typedef unsigned int UINT;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef uintptr_t DWORD_PTR;
+#endif
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "processinfocache.h"
+#include "diagnostics.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <vector>
+
+#ifdef _WIN32
+#include <winternl.h>
+
+namespace {
+
+// SYSTEM_PROCESS_INFORMATION 的前缀部分，只声明用到的字段
+struct SystemProcessEntry {
+    ULONG NextEntryOffset;
+    ULONG NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG HardFaultCount;
+    ULONG NumberOfThreadsHighWatermark;
+    ULONGLONG CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER KernelTime;
+    UNICODE_STRING ImageName;
+    LONG BasePriority;
+    HANDLE UniqueProcessId;
+};
+
+typedef LONG(NTAPI* NtQuerySystemInformationFn)(ULONG, PVOID, ULONG, PULONG);
+
+constexpr ULONG SystemProcessInformationClass = 5;
+constexpr LONG StatusInfoLengthMismatch = static_cast<LONG>(0xC0000004);
+
+quint64 fileTimeToUInt64(const FILETIME& time)
+{
+    return (static_cast<quint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+QString fileNameFromPath(const QString& path)
+{
+    int index = path.lastIndexOf('\\');
+    return index >= 0 ? path.mid(index + 1) : path;
+}
+
+// 基于 NtQuerySystemInformation 的系统进程表
+class Win32ProcessTableSource : public ProcessTableSource
+{
+public:
+    Win32ProcessTableSource()
+    {
+        HMODULE ntdll = GetModuleHandle(L"ntdll.dll");
+        if (ntdll) {
+            m_query = reinterpret_cast<NtQuerySystemInformationFn>(
+                GetProcAddress(ntdll, "NtQuerySystemInformation"));
+        }
+    }
+
+    ~Win32ProcessTableSource() override
+    {
+        for (const PinnedProcess& pinned : m_pinned) {
+            CloseHandle(pinned.handle);
+        }
+    }
+
+    bool snapshot(QVector<ProcessInfo>& processes) override
+    {
+        if (!m_query) {
+            return false;
+        }
+
+        // 进程数量会变化，缓冲区不足时按返回的大小重试
+        ULONG needed = 0;
+        LONG status = StatusInfoLengthMismatch;
+        for (int attempt = 0; attempt < 4 && status == StatusInfoLengthMismatch; ++attempt) {
+            if (m_buffer.size() < needed + 64 * 1024) {
+                m_buffer.resize(needed + 64 * 1024);
+            }
+            status = m_query(SystemProcessInformationClass, m_buffer.data(),
+                static_cast<ULONG>(m_buffer.size()), &needed);
+        }
+        if (status < 0) {
+            return false;
+        }
+
+        processes.clear();
+        const BYTE* cursor = m_buffer.data();
+        while (true) {
+            const auto* entry = reinterpret_cast<const SystemProcessEntry*>(cursor);
+
+            ProcessInfo info;
+            info.processId = static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(entry->UniqueProcessId));
+            info.startTime = static_cast<quint64>(entry->CreateTime.QuadPart);
+            if (entry->ImageName.Buffer) {
+                info.name = QString::fromWCharArray(entry->ImageName.Buffer,
+                    entry->ImageName.Length / sizeof(wchar_t));
+            }
+            processes.append(info);
+
+            if (entry->NextEntryOffset == 0) {
+                break;
+            }
+            cursor += entry->NextEntryOffset;
+        }
+        return true;
+    }
+
+    bool queryProcess(DWORD processId, ProcessInfo& info) override
+    {
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+        if (!process) {
+            return false;
+        }
+
+        FILETIME creation, exit, kernel, user;
+        if (GetProcessTimes(process, &creation, &exit, &kernel, &user)) {
+            info.startTime = fileTimeToUInt64(creation);
+        }
+
+        wchar_t path[MAX_PATH]{};
+        DWORD len = MAX_PATH;
+        if (QueryFullProcessImageNameW(process, 0, path, &len)) {
+            info.path = QString::fromWCharArray(path, len);
+            info.name = fileNameFromPath(info.path);
+        }
+        info.pathResolved = true;
+        info.processId = processId;
+
+        CloseHandle(process);
+        return true;
+    }
+
+    QString queryPath(DWORD processId, quint64 startTime) override
+    {
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+        if (!process) {
+            return {};
+        }
+
+        QString result;
+        FILETIME creation, exit, kernel, user;
+        if (GetProcessTimes(process, &creation, &exit, &kernel, &user) &&
+            fileTimeToUInt64(creation) == startTime) {
+            wchar_t path[MAX_PATH]{};
+            DWORD len = MAX_PATH;
+            if (QueryFullProcessImageNameW(process, 0, path, &len)) {
+                result = QString::fromWCharArray(path, len);
+            }
+        }
+
+        CloseHandle(process);
+        return result;
+    }
+
+    bool isRunning(DWORD processId, quint64 startTime) override
+    {
+        // 持有进程句柄期间系统不会复用它的进程ID，
+        // 因此句柄打开时确认过启动时间之后，每次只需检查进程是否已退出
+        auto it = m_pinned.find(processId);
+        if (it == m_pinned.end() || it->startTime != startTime) {
+            if (it != m_pinned.end()) {
+                CloseHandle(it->handle);
+                m_pinned.erase(it);
+            }
+
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, processId);
+            if (!process) {
+                return false;
+            }
+            FILETIME creation, exit, kernel, user;
+            if (!GetProcessTimes(process, &creation, &exit, &kernel, &user) ||
+                fileTimeToUInt64(creation) != startTime) {
+                CloseHandle(process);
+                return false;
+            }
+            it = m_pinned.insert(processId, PinnedProcess{ process, startTime });
+        }
+        return WaitForSingleObject(it->handle, 0) == WAIT_TIMEOUT;
+    }
+
+    void release(DWORD processId) override
+    {
+        auto it = m_pinned.find(processId);
+        if (it != m_pinned.end()) {
+            CloseHandle(it->handle);
+            m_pinned.erase(it);
+        }
+    }
+
+private:
+    struct PinnedProcess {
+        HANDLE handle;
+        quint64 startTime;
+    };
+
+    NtQuerySystemInformationFn m_query = nullptr;
+    std::vector<BYTE> m_buffer;
+    QHash<DWORD, PinnedProcess> m_pinned;   // 只在缓存的锁内访问
+};
+
+} // namespace
+#endif
+
+ProcessInfoCache& ProcessInfoCache::instance()
+{
+    static ProcessInfoCache inst;
+    return inst;
+}
+
+ProcessInfoCache::ProcessInfoCache()
+#ifdef _WIN32
+    : m_source(new Win32ProcessTableSource())
+#endif
+{
+    Diagnostics::instance().registerSource("Process cache", [this]() {
+        return statsString();
+        });
+}
+
+void ProcessInfoCache::setSource(std::unique_ptr<ProcessTableSource> source)
+{
+    QMutexLocker locker(&m_mutex);
+    m_source = std::move(source);
+    m_processes.clear();
+    m_failed.clear();
+}
+
+void ProcessInfoCache::refresh()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_source) {
+        return;
+    }
+
+    QVector<ProcessInfo> processes;
+    if (!m_source->snapshot(processes)) {
+        return;
+    }
+
+    QHash<DWORD, ProcessInfo> updated;
+    updated.reserve(processes.size());
+
+    for (ProcessInfo& process : processes) {
+        auto it = m_processes.constFind(process.processId);
+        if (it != m_processes.constEnd() && it->startTime == process.startTime) {
+            // 同一进程，保留已解析的路径
+            process.path = it->path;
+            process.pathResolved = it->pathResolved;
+        }
+        updated.insert(process.processId, process);
+    }
+
+    // 已退出或被复用的进程ID
+    for (auto it = m_processes.constBegin(); it != m_processes.constEnd(); ++it) {
+        auto found = updated.constFind(it.key());
+        if (found == updated.constEnd() || found->startTime != it->startTime) {
+            ++m_stats.evictions;
+            m_source->release(it.key());
+        }
+    }
+
+    m_processes = std::move(updated);
+    m_failed.clear();
+    ++m_stats.refreshes;
+}
+
+ProcessInfo* ProcessInfoCache::findLocked(DWORD processId)
+{
+    auto it = m_processes.find(processId);
+    if (it != m_processes.end()) {
+        // 快照之后进程可能已退出、ID被新进程复用，命中时确认仍是同一进程
+        if (m_source && m_source->isRunning(processId, it->startTime)) {
+            ++m_stats.hits;
+            return &it.value();
+        }
+        evictLocked(processId);
+    }
+
+    if (m_failed.contains(processId)) {
+        ++m_stats.negativeHits;
+        return nullptr;
+    }
+
+    ++m_stats.misses;
+
+    // 快照之后新启动的进程，单独查询
+    ProcessInfo info;
+    if (!m_source || !m_source->queryProcess(processId, info)) {
+        // 无权限或已退出的进程，下一次快照之前不再查询
+        m_failed.insert(processId);
+        return nullptr;
+    }
+    return &m_processes.insert(processId, info).value();
+}
+
+void ProcessInfoCache::evictLocked(DWORD processId)
+{
+    if (m_processes.remove(processId) > 0) {
+        ++m_stats.evictions;
+        if (m_source) {
+            m_source->release(processId);
+        }
+    }
+}
+
+ProcessInfo ProcessInfoCache::lookup(DWORD processId)
+{
+    QMutexLocker locker(&m_mutex);
+    ProcessInfo* info = findLocked(processId);
+    return info ? *info : ProcessInfo();
+}
+
+QString ProcessInfoCache::processName(DWORD processId)
+{
+    QMutexLocker locker(&m_mutex);
+    ProcessInfo* info = findLocked(processId);
+    return info ? info->name : QString();
+}
+
+QString ProcessInfoCache::processPath(DWORD processId)
+{
+    QMutexLocker locker(&m_mutex);
+    ProcessInfo* info = findLocked(processId);
+    if (!info) {
+        return {};
+    }
+
+    if (!info->pathResolved && m_source) {
+        QString path = m_source->queryPath(processId, info->startTime);
+
+        // 确认之后到查询路径之间进程退出、ID被复用：丢弃旧条目，按新进程重新查询（会同时解析路径）
+        if (path.isEmpty() && !m_source->isRunning(processId, info->startTime)) {
+            evictLocked(processId);
+            info = findLocked(processId);
+            if (!info) {
+                return {};
+            }
+            if (!info->pathResolved) {
+                info->path = m_source->queryPath(processId, info->startTime);
+                info->pathResolved = true;
+            }
+        }
+        else {
+            info->path = path;
+            info->pathResolved = true;
+        }
+    }
+    return info->path;
+}
+
+ProcessInfoCache::Stats ProcessInfoCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats result = m_stats;
+    result.size = m_processes.size();
+    result.failed = m_failed.size();
+    return result;
+}
+
+QString ProcessInfoCache::statsString() const
+{
+    Stats s = stats();
+    return QString("entries=%1 failed=%2 hits=%3 misses=%4 negative hits=%5 refreshes=%6 evictions=%7")
+        .arg(s.size).arg(s.failed).arg(s.hits).arg(s.misses).arg(s.negativeHits)
+        .arg(s.refreshes).arg(s.evictions);
+}
\ No newline at end of file
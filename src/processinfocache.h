@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "platformtypes.h"
+
+// 进程元数据
+struct ProcessInfo {
+    DWORD processId = 0;
+    quint64 startTime = 0;   // 进程创建时间（FILETIME 100ns）
+    QString name;            // 可执行文件名
+    QString path;            // 完整路径，按需解析
+    bool pathResolved = false;
+};
+
+// 进程表数据源接口，便于用模拟进程表替换系统实现
+class ProcessTableSource
+{
+public:
+    virtual ~ProcessTableSource() = default;
+
+    // 一次性获取所有进程（进程ID、启动时间、文件名）
+    virtual bool snapshot(QVector<ProcessInfo>& processes) = 0;
+
+    // 查询单个进程（快照之后新启动的进程）
+    virtual bool queryProcess(DWORD processId, ProcessInfo& info) = 0;
+
+    // 解析完整路径，启动时间不匹配时返回空
+    virtual QString queryPath(DWORD processId, quint64 startTime) = 0;
+
+    // 该进程ID当前是否仍是这个启动时间的进程（进程已退出或ID被复用时返回 false）。
+    // 每次命中缓存都会调用，实现应当足够便宜
+    virtual bool isRunning(DWORD processId, quint64 startTime) = 0;
+
+    // 缓存不再引用该进程，可以释放为它保留的资源
+    virtual void release(DWORD processId) { Q_UNUSED(processId); }
+};
+
+// 进程信息缓存
+// 条目以 (进程ID, 启动时间) 识别：每次命中都向数据源确认该进程ID仍属于同一启动时间的进程，
+// 进程已退出或ID被复用时丢弃旧条目重新查询，不会返回过期数据。
+// 单独查询失败的进程ID记为失败，直到下一次快照之前不再重复查询系统
+class ProcessInfoCache
+{
+public:
+    static ProcessInfoCache& instance();
+
+    void setSource(std::unique_ptr<ProcessTableSource> source);
+
+    // 从一次进程快照批量刷新
+    void refresh();
+
+    ProcessInfo lookup(DWORD processId);
+    QString processName(DWORD processId);
+    QString processPath(DWORD processId);
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 negativeHits = 0;    // 命中查询失败的记录，未再查询系统
+        quint64 refreshes = 0;
+        quint64 evictions = 0;
+        int size = 0;
+        int failed = 0;
+    };
+    Stats stats() const;
+    QString statsString() const;
+
+private:
+    ProcessInfoCache();
+
+    // 调用方需持有锁
+    ProcessInfo* findLocked(DWORD processId);
+    void evictLocked(DWORD processId);
+
+    mutable QMutex m_mutex;
+    std::unique_ptr<ProcessTableSource> m_source;
+    QHash<DWORD, ProcessInfo> m_processes;
+    QSet<DWORD> m_failed;              // 自上次快照以来查询失败的进程ID
+    Stats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "refreshscheduler.h"
+#include "diagnostics.h"
+#include <QStringList>
+
+RefreshPolicy::RefreshPolicy(int minIntervalMs, int maxIntervalMs, int settleMs)
+    : m_minInterval(minIntervalMs)
+    , m_maxInterval(qMax(minIntervalMs, maxIntervalMs))
+    , m_settle(settleMs)
+    , m_interval(minIntervalMs)
+    , m_lastActivity(0)
+{
+}
+
+void RefreshPolicy::setMinInterval(int ms)
+{
+    m_minInterval = qMax(1, ms);
+    m_maxInterval = qMax(m_maxInterval, m_minInterval);
+    m_interval = qBound(m_minInterval, m_interval, m_maxInterval);
+}
+
+void RefreshPolicy::noteActivity(qint64 now)
+{
+    m_lastActivity = now;
+    m_hasActivity = true;
+    m_interval = m_minInterval;
+}
+
+int RefreshPolicy::next(qint64 now)
+{
+    if (m_hasActivity && now - m_lastActivity < m_settle) {
+        m_interval = m_minInterval;
+    }
+    else {
+        m_interval = qMin(m_interval * 2, m_maxInterval);
+    }
+    return m_interval;
+}
+
+RefreshScheduler::RefreshScheduler(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_clock.start();
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &RefreshScheduler::onTimeout);
+
+    m_diagnostics = Diagnostics::instance().registerSource("Refresh scheduler", [this]() {
+        return statsString();
+        });
+}
+
+RefreshScheduler::~RefreshScheduler()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+}
+
+void RefreshScheduler::setMinInterval(int ms)
+{
+    m_policy.setMinInterval(ms);
+    if (!isPaused() && m_timer->remainingTime() > m_policy.interval()) {
+        schedule(m_policy.interval());
+    }
+}
+
+void RefreshScheduler::setPaused(PauseReason reason, bool paused)
+{
+    bool wasPaused = isPaused();
+    if (paused) {
+        m_pauseReasons |= reason;
+    }
+    else {
+        m_pauseReasons &= ~reason;
+    }
+
+    if (!wasPaused && isPaused()) {
+        m_timer->stop();
+        emit intervalChanged(0);
+    }
+    else if (wasPaused && !isPaused()) {
+        // 恢复后先刷新一次，补上暂停期间的变化
+        wake();
+    }
+}
+
+int RefreshScheduler::currentInterval() const
+{
+    return isPaused() ? 0 : m_policy.interval();
+}
+
+void RefreshScheduler::noteChange()
+{
+    ++m_changes;
+    m_policy.noteActivity(m_clock.elapsed());
+
+    // 退避中的长延迟缩短到最短间隔
+    if (!isPaused() && m_timer->remainingTime() > m_policy.interval()) {
+        schedule(m_policy.interval());
+    }
+}
+
+void RefreshScheduler::wake()
+{
+    ++m_wakes;
+    m_policy.noteActivity(m_clock.elapsed());
+    if (!isPaused()) {
+        schedule(0);
+    }
+}
+
+void RefreshScheduler::onTimeout()
+{
+    ++m_ticks;
+    emit tick();
+
+    if (!isPaused()) {
+        schedule(m_policy.next(m_clock.elapsed()));
+    }
+}
+
+void RefreshScheduler::schedule(int delay)
+{
+    int previous = m_timer->isActive() ? m_timer->interval() : -1;
+    m_timer->start(delay);
+
+    // 立即刷新不算作间隔变化
+    if (delay > 0 && delay != previous) {
+        emit intervalChanged(delay);
+    }
+}
+
+QString RefreshScheduler::statsString() const
+{
+    QString state = "running";
+    if (isPaused()) {
+        QStringList reasons;
+        if (m_pauseReasons & Disabled) reasons << "disabled";
+        if (m_pauseReasons & SessionLocked) reasons << "locked";
+        if (m_pauseReasons & NoConsumers) reasons << "hidden";
+        if (m_pauseReasons & MenuOpen) reasons << "menu";
+        state = QString("paused(%1)").arg(reasons.join(','));
+    }
+
+    return QString("interval=%1ms range=%2-%3ms state=%4 ticks=%5 changes=%6 wakes=%7")
+        .arg(currentInterval())
+        .arg(m_policy.minInterval())
+        .arg(m_policy.maxInterval())
+        .arg(state)
+        .arg(m_ticks).arg(m_changes).arg(m_wakes);
+}
\ No newline at end of file
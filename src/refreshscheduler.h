@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// 自适应刷新策略
+// 只做计算，当前时间由调用方传入，可以用模拟时钟驱动
+class RefreshPolicy
+{
+public:
+    static constexpr int DefaultMinIntervalMs = 500;
+    static constexpr int DefaultMaxIntervalMs = 60000;
+    static constexpr int DefaultSettleMs = 5000;
+
+    RefreshPolicy(int minIntervalMs = DefaultMinIntervalMs,
+        int maxIntervalMs = DefaultMaxIntervalMs,
+        int settleMs = DefaultSettleMs);
+
+    void setMinInterval(int ms);
+    int minInterval() const { return m_minInterval; }
+    int maxInterval() const { return m_maxInterval; }
+
+    // 观察到窗口变化或用户交互：恢复最短间隔
+    void noteActivity(qint64 now);
+
+    // 一次刷新完成后计算下一次延迟：
+    // 最近 settleMs 内有活动时保持最短间隔，否则指数退避直到最长间隔
+    int next(qint64 now);
+
+    int interval() const { return m_interval; }
+
+private:
+    int m_minInterval;
+    int m_maxInterval;
+    int m_settle;
+    int m_interval;
+    qint64 m_lastActivity;
+    bool m_hasActivity = false;
+};
+
+// 自适应刷新调度器
+// 按 RefreshPolicy 发出 tick，会话锁定、主窗口隐藏或关闭自动刷新时完全停止
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum PauseReason {
+        Disabled = 0x1,        // 关闭了自动刷新
+        SessionLocked = 0x2,   // 会话已锁定
+        NoConsumers = 0x4,     // 主窗口隐藏，没有人查看窗口列表
+        MenuOpen = 0x8         // 右键菜单打开期间
+    };
+
+    explicit RefreshScheduler(QObject* parent = nullptr);
+    ~RefreshScheduler();
+
+    void setMinInterval(int ms);
+    void setPaused(PauseReason reason, bool paused);
+
+    bool isPaused() const { return m_pauseReasons != 0; }
+
+    // 当前间隔（毫秒），暂停时为 0
+    int currentInterval() const;
+
+    QString statsString() const;
+
+public slots:
+    // 对账发现了事件遗漏的窗口变化
+    void noteChange();
+
+    // 托盘、热键等用户交互：立即刷新
+    void wake();
+
+signals:
+    void tick();
+    void intervalChanged(int ms);
+
+private slots:
+    void onTimeout();
+
+private:
+    void schedule(int delay);
+
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    RefreshPolicy m_policy;
+    int m_pauseReasons = 0;
+    quint64 m_ticks = 0;
+    quint64 m_changes = 0;
+    quint64 m_wakes = 0;
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "sessionmonitor.h"
+#include <QDebug>
+#include <wtsapi32.h>
+
+SessionMonitor* SessionMonitor::s_instance = nullptr;
+
+SessionMonitor& SessionMonitor::instance()
+{
+    if (!s_instance) {
+        s_instance = new SessionMonitor();
+    }
+    return *s_instance;
+}
+
+SessionMonitor::SessionMonitor(QObject* parent)
+    : QObject(parent)
+{
+    createSessionWindow();
+}
+
+SessionMonitor::~SessionMonitor()
+{
+    destroySessionWindow();
+}
+
+bool SessionMonitor::createSessionWindow()
+{
+    // 注册窗口类
+    WNDCLASS wc = {};
+    wc.lpfnWndProc = sessionWndProc;
+    wc.hInstance = GetModuleHandle(nullptr);
+    wc.lpszClassName = L"SessionMonitorWindowClass";
+
+    if (!RegisterClass(&wc)) {
+        qWarning() << "Failed to register session window class";
+        return false;
+    }
+
+    // 创建消息窗口
+    m_sessionWindow = CreateWindow(
+        wc.lpszClassName,
+        L"Session Monitor",
+        0, 0, 0, 0, 0,
+        HWND_MESSAGE,
+        nullptr,
+        GetModuleHandle(nullptr),
+        this
+    );
+
+    if (!m_sessionWindow) {
+        qWarning() << "Failed to create session window";
+        return false;
+    }
+
+    if (!WTSRegisterSessionNotification(m_sessionWindow, NOTIFY_FOR_THIS_SESSION)) {
+        qWarning() << "Failed to register session notification";
+        return false;
+    }
+
+    return true;
+}
+
+void SessionMonitor::destroySessionWindow()
+{
+    if (m_sessionWindow) {
+        WTSUnRegisterSessionNotification(m_sessionWindow);
+        DestroyWindow(m_sessionWindow);
+        m_sessionWindow = nullptr;
+    }
+}
+
+LRESULT CALLBACK SessionMonitor::sessionWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+    SessionMonitor* monitor = nullptr;
+
+    if (uMsg == WM_NCCREATE) {
+        CREATESTRUCT* createStruct = reinterpret_cast<CREATESTRUCT*>(lParam);
+        monitor = reinterpret_cast<SessionMonitor*>(createStruct->lpCreateParams);
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(monitor));
+    }
+    else {
+        monitor = reinterpret_cast<SessionMonitor*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    }
+
+    if (monitor && uMsg == WM_WTSSESSION_CHANGE) {
+        bool locked = monitor->m_locked;
+        if (wParam == WTS_SESSION_LOCK) {
+            locked = true;
+        }
+        else if (wParam == WTS_SESSION_UNLOCK) {
+            locked = false;
+        }
+
+        if (locked != monitor->m_locked) {
+            monitor->m_locked = locked;
+            emit monitor->lockChanged(locked);
+        }
+        return 0;
+    }
+
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QObject>
+#include <windows.h>
+
+// 会话状态监视
+// 通过 WTS 会话通知得知锁屏/解锁
+class SessionMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SessionMonitor& instance();
+
+    bool isLocked() const { return m_locked; }
+
+signals:
+    void lockChanged(bool locked);
+
+private:
+    SessionMonitor(QObject* parent = nullptr);
+    ~SessionMonitor();
+
+    static LRESULT CALLBACK sessionWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+    bool createSessionWindow();
+    void destroySessionWindow();
+
+private:
+    HWND m_sessionWindow = nullptr;
+    bool m_locked = false;
+
+    static SessionMonitor* s_instance;
+};
\ No newline at end of file
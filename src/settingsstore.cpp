@@ -0,0 +1,185 @@
+#include "settingsstore.h"
+#include "diagnostics.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+#include <windows.h>
+
+SettingsStore::SettingsStore(const QString& path, QObject* parent)
+    : QObject(parent)
+    , m_path(path)
+{
+    load();
+
+    // 拖动数值框等连续修改只在停下来之后写一次
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(DefaultFlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SettingsStore::startFlush);
+
+    m_diagnostics = Diagnostics::instance().registerSource("Settings", [this]() {
+        return statsString();
+        });
+}
+
+SettingsStore::~SettingsStore()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+    flush();
+}
+
+void SettingsStore::load()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QSettings settings(m_path, QSettings::IniFormat);
+    const QStringList keys = settings.allKeys();
+    for (const QString& key : keys) {
+        m_values.insert(key, settings.value(key));
+    }
+
+    m_stats.loadMicros = timer.nsecsElapsed() / 1000;
+    qDebug() << "Loaded" << m_values.size() << "settings from" << m_path << "in" << m_stats.loadMicros << "us";
+}
+
+QVariant SettingsStore::value(const QString& key, const QVariant& defaultValue) const
+{
+    auto it = m_values.constFind(key);
+    return it != m_values.constEnd() ? it.value() : defaultValue;
+}
+
+void SettingsStore::setValue(const QString& key, const QVariant& value)
+{
+    auto it = m_values.find(key);
+    if (it != m_values.end() && it.value() == value) {
+        return;
+    }
+    m_values.insert(key, value);
+
+    ++m_stats.changes;
+    m_dirty = true;
+    m_flushTimer.start();
+
+    emit valueChanged(key, value);
+}
+
+void SettingsStore::startFlush()
+{
+    if (!m_dirty) {
+        return;
+    }
+    if (m_writer) {
+        // 上一次写入还没完成，完成后再写
+        m_flushPending = true;
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 隐式共享，这里只增加引用计数；之后的修改会在 GUI 线程复制，不影响写入中的快照
+    const QHash<QString, QVariant> snapshot = m_values;
+    const QString path = m_path;
+    m_dirty = false;
+    m_flushPending = false;
+
+    QThread* thread = QThread::create([this, path, snapshot]() {
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+        const bool ok = write(path, snapshot);
+        const qint64 micros = writeTimer.nsecsElapsed() / 1000;
+        if (!ok) {
+            m_writeFailed.store(true);
+        }
+
+        QMetaObject::invokeMethod(this, [this, ok, micros]() {
+            // 写入已结束，线程随后自行退出，不必等它销毁
+            m_writer = nullptr;
+            m_stats.lastWriteMicros = micros;
+            if (ok) {
+                ++m_stats.writes;
+            }
+            else if (m_writeFailed.exchange(false)) {
+                // 失败还没有被 flush() 处理过
+                ++m_stats.failedWrites;
+                qWarning() << "Failed to write settings:" << m_path;
+                m_dirty = true;
+            }
+            if (m_flushPending || !ok) {
+                m_flushTimer.start();
+            }
+            }, Qt::QueuedConnection);
+        });
+    thread->setObjectName("SettingsWriter");
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    m_writer = thread;
+    thread->start(QThread::LowPriority);
+
+    m_stats.lastGuiMicros = timer.nsecsElapsed() / 1000;
+    m_stats.guiMicros += m_stats.lastGuiMicros;
+}
+
+void SettingsStore::flush()
+{
+    m_flushTimer.stop();
+    if (m_writer) {
+        m_writer->wait();
+    }
+    if (m_writeFailed.exchange(false)) {
+        // 后台写入失败而完成回调尚未执行，快照中的修改仍未保存，下面同步重写
+        ++m_stats.failedWrites;
+        qWarning() << "Failed to write settings:" << m_path;
+        m_dirty = true;
+    }
+    if (!m_dirty) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    m_dirty = false;
+    if (write(m_path, m_values)) {
+        ++m_stats.writes;
+    }
+    else {
+        ++m_stats.failedWrites;
+        qWarning() << "Failed to write settings:" << m_path;
+    }
+    m_stats.lastWriteMicros = m_stats.lastGuiMicros = timer.nsecsElapsed() / 1000;
+    m_stats.guiMicros += m_stats.lastGuiMicros;
+}
+
+bool SettingsStore::write(const QString& path, const QHash<QString, QVariant>& values)
+{
+    // 完整写入临时文件后再替换，写到一半崩溃也不会留下残缺的配置文件
+    const QString tempPath = path + ".tmp";
+    QFile::remove(tempPath);
+    {
+        QSettings settings(tempPath, QSettings::IniFormat);
+        settings.clear();
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+            settings.setValue(it.key(), it.value());
+        }
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            QFile::remove(tempPath);
+            return false;
+        }
+    }
+
+    const std::wstring from = QDir::toNativeSeparators(tempPath).toStdWString();
+    const std::wstring to = QDir::toNativeSeparators(path).toStdWString();
+    return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+QString SettingsStore::statsString() const
+{
+    return QString("keys=%1 changes=%2 writes=%3 failed=%4 gui=%5us last gui=%6us last write=%7us load=%8us")
+        .arg(m_values.size()).arg(m_stats.changes)
+        .arg(m_stats.writes).arg(m_stats.failedWrites)
+        .arg(m_stats.guiMicros).arg(m_stats.lastGuiMicros)
+        .arg(m_stats.lastWriteMicros).arg(m_stats.loadMicros);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <atomic>
+
+class QThread;
+
+// 带类型和默认值的设置项
+template <typename T>
+struct Setting
+{
+    const char* key;        // "分组/键"，与 INI 中的写法一致
+    T defaultValue;
+};
+
+// 内存中的设置存储
+// 启动时读取一次配置文件，之后的读写都只访问内存；修改后发出 valueChanged，
+// 安静 flushDelay 毫秒后把完整快照交给后台线程写入临时文件，再原子替换配置文件。
+// 写入期间的新修改在写完后合并为下一次写入。只在 GUI 线程使用。
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsStore(const QString& path, QObject* parent = nullptr);
+    ~SettingsStore();
+
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    // 值未变化时不通知也不写盘
+    void setValue(const QString& key, const QVariant& value);
+
+    template <typename T>
+    T get(const Setting<T>& setting) const
+    {
+        return value(setting.key, QVariant::fromValue(setting.defaultValue)).template value<T>();
+    }
+
+    template <typename T>
+    void set(const Setting<T>& setting, const T& value)
+    {
+        if (get(setting) != value) {
+            setValue(setting.key, QVariant::fromValue(value));
+        }
+    }
+
+    void setFlushDelay(int ms) { m_flushTimer.setInterval(qMax(0, ms)); }
+
+    // 等待正在进行的写入，然后在当前线程立即写入未保存的修改（退出时调用）
+    void flush();
+
+    const QString& path() const { return m_path; }
+
+    struct Stats {
+        quint64 changes = 0;          // 实际改变了值的 setValue 次数
+        quint64 writes = 0;           // 写盘次数
+        quint64 failedWrites = 0;
+        qint64 guiMicros = 0;         // GUI 线程上花在发起写入上的累计时间
+        qint64 lastGuiMicros = 0;
+        qint64 lastWriteMicros = 0;   // 最近一次写盘耗时（后台线程）
+        qint64 loadMicros = 0;
+    };
+    Stats stats() const { return m_stats; }
+    QString statsString() const;
+
+signals:
+    void valueChanged(const QString& key, const QVariant& value);
+
+private:
+    void load();
+    void startFlush();
+
+    // 可在任意线程调用
+    static bool write(const QString& path, const QHash<QString, QVariant>& values);
+
+    static constexpr int DefaultFlushDelayMs = 500;
+
+    QString m_path;
+    QHash<QString, QVariant> m_values;
+    QTimer m_flushTimer;
+    QPointer<QThread> m_writer;
+    bool m_dirty = false;
+    bool m_flushPending = false;
+    // 后台写入失败时由写入线程置位；退出时排队的完成回调可能来不及执行，flush() 等待线程后直接读取
+    std::atomic<bool> m_writeFailed{ false };
+
+    Stats m_stats;
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
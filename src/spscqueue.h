@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// 单生产者单消费者无锁环形队列
+// 生产者只写 m_tail，消费者只写 m_head，两端各自读取对方的索引即可判断空满。
+// 容量必须是 2 的幂，实际可用 Capacity - 1 个位置。
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // 仅生产者线程调用；队列已满时返回 false
+    bool push(const T& value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & Mask;
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_items[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用；队列为空时返回 false
+    bool pop(T& value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_items[head];
+        m_head.store((head + 1) & Mask, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t Mask = Capacity - 1;
+
+    T m_items[Capacity] = {};
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include "stringpool.h"
+
+StringPool::StringPool()
+    : m_table(std::make_shared<const QVector<QString>>())
+{
+}
+
+quint32 StringPool::intern(const QString& s)
+{
+    auto it = m_ids.constFind(s);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    // 写时复制：新字符串很少出现（新的窗口类或进程）
+    auto table = std::make_shared<QVector<QString>>(*m_table);
+    quint32 id = static_cast<quint32>(table->size());
+    table->append(s);
+    m_table = std::move(table);
+    m_ids.insert(s, id);
+    return id;
+}
\ No newline at end of file
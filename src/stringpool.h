@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+// 字符串驻留池
+// 类名、进程名等重复度很高的字符串只保存一份，以编号引用
+// 字符串表只增不改，新增时整体复制，已发布的快照持有的旧表不受影响
+class StringPool
+{
+public:
+    using Table = std::shared_ptr<const QVector<QString>>;
+
+    StringPool();
+
+    quint32 intern(const QString& s);
+
+    // 当前字符串表，可跨线程只读共享
+    Table table() const { return m_table; }
+    int size() const { return m_table->size(); }
+
+private:
+    QHash<QString, quint32> m_ids;
+    Table m_table;
+};
\ No newline at end of file
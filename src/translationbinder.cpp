@@ -0,0 +1,73 @@
+#include "translationbinder.h"
+#include "translator.h"
+#include "diagnostics.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+TranslationBinder::TranslationBinder(QObject* parent)
+    : QObject(parent)
+{
+    m_diagnostics = Diagnostics::instance().registerSource("Translation bindings", [this]() {
+        return statsString();
+        });
+}
+
+TranslationBinder::~TranslationBinder()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+}
+
+void TranslationBinder::bind(QObject* target, Apply apply, quint64 key, const char* source)
+{
+    apply(Translator::instance().translate(key, source));
+
+    Binding binding;
+    binding.target = target;
+    binding.key = key;
+    binding.source = source;
+    binding.apply = std::move(apply);
+    m_bindings.push_back(std::move(binding));
+}
+
+void TranslationBinder::bindComputed(QObject* target, std::function<void()> update)
+{
+    update();
+
+    Binding binding;
+    binding.target = target;
+    binding.update = std::move(update);
+    m_bindings.push_back(std::move(binding));
+}
+
+void TranslationBinder::retranslate()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 先清除目标已销毁的绑定，剩下的一次遍历完成
+    m_bindings.erase(std::remove_if(m_bindings.begin(), m_bindings.end(),
+        [](const Binding& binding) { return binding.target.isNull(); }),
+        m_bindings.end());
+
+    const Translator& translator = Translator::instance();
+    for (const Binding& binding : m_bindings) {
+        if (binding.key != 0) {
+            binding.apply(translator.translate(binding.key, binding.source));
+        }
+        else {
+            binding.update();
+        }
+    }
+
+    ++m_passes;
+    m_lastUpdated = static_cast<int>(m_bindings.size());
+    m_lastMicros = timer.nsecsElapsed() / 1000;
+    m_maxMicros = qMax(m_maxMicros, m_lastMicros);
+}
+
+QString TranslationBinder::statsString() const
+{
+    return QString("bindings=%1 passes=%2 last updated=%3 last=%4us max=%5us")
+        .arg(m_bindings.size()).arg(m_passes).arg(m_lastUpdated)
+        .arg(m_lastMicros).arg(m_maxMicros);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <functional>
+#include <vector>
+
+// 可翻译字符串绑定
+// 每个控件属性在创建时登记一次（翻译键 + 设置函数），切换语言时按登记顺序逐项重新赋值，
+// 不查找控件树，也不重建表格。目标对象销毁后对应的绑定在下次切换时清除。
+// 依赖多个译文或运行时参数的文本用计算绑定登记，切换时整体重新生成。
+class TranslationBinder : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Apply = std::function<void(const QString&)>;
+
+    explicit TranslationBinder(QObject* parent = nullptr);
+    ~TranslationBinder();
+
+    // 登记后立即按当前语言赋值一次
+    void bind(QObject* target, Apply apply, quint64 key, const char* source);
+    void bindComputed(QObject* target, std::function<void()> update);
+
+    // 例如 bind(label, &QLabel::setText, key, source)
+    template <typename T, typename Class>
+    void bind(T* target, void (Class::*setter)(const QString&), quint64 key, const char* source)
+    {
+        bind(target, [target, setter](const QString& text) { (target->*setter)(text); }, key, source);
+    }
+
+    // 以当前语言更新所有绑定
+    void retranslate();
+
+    int size() const { return static_cast<int>(m_bindings.size()); }
+    QString statsString() const;
+
+private:
+    struct Binding {
+        QPointer<QObject> target;
+        quint64 key = 0;                  // 0 表示计算绑定
+        const char* source = nullptr;     // 字面量，生命周期与程序相同
+        Apply apply;
+        std::function<void()> update;
+    };
+
+    std::vector<Binding> m_bindings;
+
+    quint64 m_passes = 0;
+    qint64 m_lastMicros = 0;
+    qint64 m_maxMicros = 0;
+    int m_lastUpdated = 0;
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
@@ -1,7 +1,106 @@
 #include "translator.h"
+#include "diagnostics.h"
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QTextStream>
+#include <QThread>
 #include <QDebug>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// 读者登记期间，GUI 线程不会释放任何已替换的表
+class ReadGuard
+{
+public:
+    explicit ReadGuard(std::atomic<int>& readers) : m_readers(readers) { m_readers.fetch_add(1); }
+    ~ReadGuard() { m_readers.fetch_sub(1); }
+
+private:
+    std::atomic<int>& m_readers;
+};
+
+} // namespace
+
+// 不可变翻译表，发布后只读
+struct Translator::Table
+{
+    struct Slot {
+        quint64 key = 0;          // 0 表示空
+        int value = -1;           // values 下标
+    };
+
+    std::vector<Slot> buckets;
+    std::vector<QString> values;
+    quint64 revision = 0;
+    bool fromCatalog = false;
+    qint64 loadMicros = 0;
+
+    const QString* find(quint64 key) const
+    {
+        if (buckets.empty()) {
+            return nullptr;
+        }
+        // 负载因子保证有空槽位，探测次数仍以槽位数为上限，损坏的表也不会死循环
+        const size_t mask = buckets.size() - 1;
+        size_t i = key & mask;
+        for (size_t probes = 0; probes < buckets.size(); ++probes, i = (i + 1) & mask) {
+            if (buckets[i].key == key) {
+                return &values[buckets[i].value];
+            }
+            if (buckets[i].key == 0) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // 只在构建阶段调用
+    void insert(quint64 key, const QString& value)
+    {
+        // 负载因子不超过 1/2，探测链保持很短
+        if ((values.size() + 1) * 2 > buckets.size()) {
+            grow();
+        }
+
+        const size_t mask = buckets.size() - 1;
+        size_t i = key & mask;
+        while (buckets[i].key != 0) {
+            if (buckets[i].key == key) {
+                values[buckets[i].value] = value;   // 重复的键以最后一次为准
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+        values.push_back(value);
+        buckets[i].key = key;
+        buckets[i].value = static_cast<int>(values.size()) - 1;
+    }
+
+    void grow()
+    {
+        std::vector<Slot> old;
+        old.swap(buckets);
+        buckets.assign(old.empty() ? InitialCapacity : old.size() * 2, Slot());
+
+        const size_t mask = buckets.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.key == 0) {
+                continue;
+            }
+            size_t i = slot.key & mask;
+            while (buckets[i].key != 0) {
+                i = (i + 1) & mask;
+            }
+            buckets[i] = slot;
+        }
+    }
+
+    static constexpr size_t InitialCapacity = 256;
+};
 
 Translator& Translator::instance()
 {
@@ -9,7 +108,135 @@ Translator& Translator::instance()
     return inst;
 }
 
+Translator::Translator(QObject* parent)
+    : QObject(parent)
+{
+    m_reclaimTimer.setSingleShot(true);
+    m_reclaimTimer.setInterval(ReclaimRetryMs);
+    connect(&m_reclaimTimer, &QTimer::timeout, this, &Translator::reclaimRetired);
+
+    // 启动时先发布一张空表，读者无需判空
+    publish(std::make_shared<Table>());
+
+    // 编辑器保存时往往连续触发多次，合并后再重建
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(ReloadDelayMs);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &Translator::startReload);
+
+    Diagnostics::instance().registerSource("Translations", [this]() {
+        return statsString();
+        });
+}
+
+Translator::~Translator()
+{
+    m_current.store(nullptr);
+}
+
 bool Translator::loadLanguage(const QString& langFile)
+{
+    std::unique_ptr<Table> table = build(langFile);
+    if (!table) {
+        return false;
+    }
+
+    publish(std::move(table));
+    watch(langFile);
+    return true;
+}
+
+std::unique_ptr<Translator::Table> Translator::build(const QString& langFile)
+{
+    auto table = std::make_unique<Table>();
+
+    // 构建时生成的目录与文本文件同名；文本文件比目录新说明被用户改过，以文本为准
+    QFileInfo textInfo(langFile);
+    QFileInfo catalogInfo(textInfo.path() + '/' + textInfo.completeBaseName() + LanguageCatalog::FileSuffix);
+    if (catalogInfo.exists()
+        && (!textInfo.exists() || catalogInfo.lastModified() >= textInfo.lastModified())) {
+        QElapsedTimer timer;
+        timer.start();
+        if (buildFromCatalog(catalogInfo.filePath(), *table)) {
+            table->fromCatalog = true;
+            table->loadMicros = timer.nsecsElapsed() / 1000;
+            qDebug() << "Loaded" << table->values.size() << "translations from catalog" << catalogInfo.filePath()
+                << "in" << table->loadMicros << "us";
+            return table;
+        }
+        qWarning() << "Invalid language catalog, falling back to text:" << catalogInfo.filePath();
+        table = std::make_unique<Table>();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!buildFromText(langFile, *table)) {
+        return nullptr;
+    }
+    table->loadMicros = timer.nsecsElapsed() / 1000;
+    qDebug() << "Loaded" << table->values.size() << "translations from" << langFile
+        << "in" << table->loadMicros << "us";
+    return table;
+}
+
+bool Translator::buildFromCatalog(const QString& catalogFile, Table& table)
+{
+    QFile file(catalogFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < static_cast<qint64>(sizeof(LanguageCatalog::Header))) {
+        return false;
+    }
+
+    const uchar* data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    // 只校验文件头、各区段的边界和负载因子
+    LanguageCatalog::Header header;
+    memcpy(&header, data, sizeof(header));
+    const quint64 slotsEnd = sizeof(header) + quint64(header.slotCount) * sizeof(LanguageCatalog::Slot);
+    if (header.magic != LanguageCatalog::Magic || header.version != LanguageCatalog::Version
+        || header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0
+        || quint64(header.entryCount) * 2 > header.slotCount
+        || header.stringsOffset < slotsEnd || header.stringsOffset % 8 != 0
+        || quint64(header.stringsOffset) + header.stringsSize > quint64(size)) {
+        file.unmap(const_cast<uchar*>(data));
+        return false;
+    }
+
+    // 目录与运行时表使用同样的哈希和探测方式，槽位按原位置复制即可，无需重新插入；
+    // 译文按 UTF-16 原样复制，不解码。复制完成后立即卸载，不占用文件
+    const auto* catalogSlots = reinterpret_cast<const LanguageCatalog::Slot*>(data + sizeof(header));
+    const auto* strings = reinterpret_cast<const QChar*>(data + header.stringsOffset);
+    const quint32 chars = header.stringsSize / sizeof(QChar);
+
+    table.buckets.assign(header.slotCount, Table::Slot());
+    table.values.reserve(header.entryCount);
+    bool valid = true;
+    for (quint32 i = 0; i < header.slotCount; ++i) {
+        const LanguageCatalog::Slot& slot = catalogSlots[i];
+        if (slot.key == 0) {
+            continue;
+        }
+        // 占用的槽位不能多于文件头声明的条目数，否则负载因子的校验没有意义
+        if (table.values.size() >= header.entryCount || quint64(slot.offset) + slot.length > chars) {
+            valid = false;
+            break;
+        }
+        table.values.emplace_back(strings + slot.offset, static_cast<int>(slot.length));
+        table.buckets[i].key = slot.key;
+        table.buckets[i].value = static_cast<int>(table.values.size()) - 1;
+    }
+
+    file.unmap(const_cast<uchar*>(data));
+    return valid;
+}
+
+bool Translator::buildFromText(const QString& langFile, Table& table)
 {
     QFile file(langFile);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -17,9 +244,8 @@ bool Translator::loadLanguage(const QString& langFile)
         return false;
     }
 
-    translations.clear();
     QTextStream in(&file);
-    QString currentSection;
+    QByteArray currentSection;
     QString line;
 
     while (!in.atEnd()) {
@@ -27,33 +253,180 @@ bool Translator::loadLanguage(const QString& langFile)
         if (line.isEmpty() || line.startsWith('#') || line.startsWith(';')) continue;
 
         if (line.startsWith('[') && line.endsWith(']')) {
-            currentSection = line.mid(1, line.length() - 2);
+            currentSection = line.mid(1, line.length() - 2).toUtf8();
         }
         else if (line.contains('=')) {
             int eq = line.indexOf('=');
-            QString key = line.left(eq).trimmed();
+            QByteArray key = line.left(eq).trimmed().toUtf8();
             QString value = line.mid(eq + 1).trimmed();
 
             // 支持带引号的值（可选）
             if (value.length() >= 2 && value.startsWith('"') && value.endsWith('"'))
                 value = value.mid(1, value.length() - 2);
 
-            QString fullKey = currentSection + '|' + key;
-            translations[fullKey] = value;
+            table.insert(hashKey(currentSection.constData(), key.constData()), value);
         }
     }
 
     file.close();
-    qDebug() << "Loaded" << translations.size() << "translations from" << langFile;
     return true;
 }
 
-QString Translator::translate(const QString& context, const QString& sourceText) const
+void Translator::publish(std::shared_ptr<Table> table)
 {
-    QString key = context + '|' + sourceText;
-    auto it = translations.find(key);
-    if (it != translations.end()) {
-        return *it;
+    table->revision = ++m_revision;
+    if (table->revision > 1) {
+        m_stats.fromCatalog = table->fromCatalog;
+        if (table->fromCatalog) {
+            ++m_stats.catalogLoads;
+            m_stats.lastCatalogMicros = table->loadMicros;
+        }
+        else {
+            ++m_stats.textLoads;
+            m_stats.lastTextMicros = table->loadMicros;
+        }
     }
-    return sourceText; // fallback
+
+    // 写完整张表后再发布；旧表先放入待释放列表，仍在读取它的线程不受影响
+    m_current.store(table.get());
+    if (m_table) {
+        m_retired.push_back(std::move(m_table));
+    }
+    m_table = std::move(table);
+    reclaimRetired();
+}
+
+void Translator::reclaimRetired()
+{
+    // 指针替换之后读者计数为 0：之前读到旧表的读者都已复制完译文，之后的读者只能读到新表
+    if (!m_retired.empty() && m_readers.load() == 0) {
+        m_stats.reclaimed += m_retired.size();
+        m_retired.clear();
+    }
+    if (!m_retired.empty() && !m_reclaimTimer.isActive()) {
+        m_reclaimTimer.start();
+    }
+    m_stats.tables = 1 + static_cast<int>(m_retired.size());
+}
+
+void Translator::watch(const QString& langFile)
+{
+    m_langFile = langFile;
+    m_reloadTimer.stop();
+
+    if (!m_watcher) {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &Translator::onFileChanged);
+    }
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+
+    QFileInfo textInfo(langFile);
+    QStringList paths{ langFile };
+    QString catalogFile = textInfo.path() + '/' + textInfo.completeBaseName() + LanguageCatalog::FileSuffix;
+    if (QFileInfo::exists(catalogFile)) {
+        paths << catalogFile;
+    }
+    m_watcher->addPaths(paths);
+}
+
+void Translator::onFileChanged(const QString& path)
+{
+    // 编辑器常以"写临时文件再替换"的方式保存，原路径会从监视列表中移除，需要重新加入
+    if (!m_watcher->files().contains(path) && QFileInfo::exists(path)) {
+        m_watcher->addPath(path);
+    }
+    m_reloadTimer.start();
+}
+
+void Translator::startReload()
+{
+    if (m_reloading) {
+        m_reloadPending = true;
+        return;
+    }
+    m_reloading = true;
+    m_reloadPending = false;
+
+    // 在后台线程解析，结果回到 GUI 线程发布；期间切换了语言则丢弃
+    const QString langFile = m_langFile;
+    QThread* thread = QThread::create([this, langFile]() {
+        std::shared_ptr<Table> table(build(langFile));
+        QMetaObject::invokeMethod(this, [this, langFile, table]() mutable {
+            m_reloading = false;
+            if (langFile == m_langFile) {
+                if (table) {
+                    publish(std::move(table));
+                    ++m_stats.hotReloads;
+                    emit languageReloaded();
+                }
+                else {
+                    ++m_stats.failedReloads;
+                    qWarning() << "Failed to reload language file:" << langFile;
+                }
+            }
+            if (m_reloadPending) {
+                startReload();
+            }
+            }, Qt::QueuedConnection);
+        });
+    thread->setObjectName("TranslatorReload");
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start(QThread::LowPriority);
+}
+
+const QString& Translator::fallback(quint64 key, const char* sourceText)
+{
+    // 原文与语言无关，缓存无需随语言失效；每个线程一份，不需要同步。
+    // unordered_map 的节点在扩容时不移动，返回的引用保持有效
+    thread_local std::unordered_map<quint64, QString> cache;
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, QString::fromUtf8(sourceText)).first;
+    }
+    return it->second;
+}
+
+QString Translator::translate(quint64 key, const char* sourceText) const
+{
+    ReadGuard guard(m_readers);
+    const Table* table = m_current.load();
+    if (table) {
+        if (const QString* translated = table->find(key)) {
+            return *translated;
+        }
+    }
+    return fallback(key, sourceText);
+}
+
+QString Translator::translate(const QString& context, const QString& sourceText) const
+{
+    QByteArray source = sourceText.toUtf8();
+    return translate(hashKey(context.toUtf8().constData(), source.constData()), source.constData());
+}
+
+int Translator::size() const
+{
+    ReadGuard guard(m_readers);
+    const Table* table = m_current.load();
+    return table ? static_cast<int>(table->values.size()) : 0;
+}
+
+quint64 Translator::revision() const
+{
+    ReadGuard guard(m_readers);
+    const Table* table = m_current.load();
+    return table ? table->revision : 0;
+}
+
+QString Translator::statsString() const
+{
+    return QString("source=%1 entries=%2 revision=%3 tables=%4 reclaimed=%5 catalog loads=%6 last=%7us "
+        "text loads=%8 last=%9us hot reloads=%10 failed=%11")
+        .arg(m_stats.fromCatalog ? "catalog" : "text")
+        .arg(size()).arg(revision()).arg(m_stats.tables).arg(m_stats.reclaimed)
+        .arg(m_stats.catalogLoads).arg(m_stats.lastCatalogMicros)
+        .arg(m_stats.textLoads).arg(m_stats.lastTextMicros)
+        .arg(m_stats.hotReloads).arg(m_stats.failedReloads);
 }
\ No newline at end of file
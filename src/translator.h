@@ -1,19 +1,105 @@
 #pragma once
 
 #include <QObject>
-#include <QMap>
 #include <QString>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "languagecatalog.h"
 
+class QFileSystemWatcher;
+
+// 在编译期计算翻译键的哈希：std::integral_constant 强制常量求值
+#define TRANSLATION_KEY(context, source) \
+    (std::integral_constant<quint64, Translator::hashKey(context, source)>::value)
+
+// 翻译表
+// 键为 "上下文|原文" 的 64 位 FNV-1a 哈希，存放在开放寻址的扁平表中（线性探测）。
+// 每次加载构建一张新表，建好后不再修改，通过原子指针发布（RCU 方式）：
+// 读者登记到读者计数后读取当前表并复制译文（隐式共享，只是一次引用计数递增），不加锁，
+// 可在任意线程调用 translate。被替换的旧表在观察到没有读者时释放，有读者时稍后重试，
+// 反复切换语言不会让旧表一直累积。
+// 优先使用构建时由 langc 生成的二进制目录（.langc），没有目录或文本文件更新时解析文本。
+// 当前语言文件变化时在后台线程重建并替换，完成后发出 languageReloaded。
 class Translator : public QObject
 {
     Q_OBJECT
 
 public:
     static Translator& instance();
+    ~Translator();
+
+    // 同步加载并发布，只在 GUI 线程调用
     bool loadLanguage(const QString& langFile);
+
+    // 以下接口可在任意线程调用
+    // 未翻译时返回原文（每个线程各自缓存原文，首次之后不再分配）
+    QString translate(quint64 key, const char* sourceText) const;
     QString translate(const QString& context, const QString& sourceText) const;
 
+    int size() const;
+    quint64 revision() const;
+
+    // 0 保留给空槽位
+    static constexpr quint64 hashKey(const char* context, const char* source)
+    {
+        return LanguageCatalog::hashKey(context, source);
+    }
+
+    struct Stats {
+        bool fromCatalog = false;      // 当前语言来自二进制目录
+        quint64 catalogLoads = 0;
+        quint64 textLoads = 0;
+        quint64 hotReloads = 0;
+        quint64 failedReloads = 0;
+        qint64 lastCatalogMicros = 0;
+        qint64 lastTextMicros = 0;
+        int tables = 0;                // 当前表和等待释放的旧表
+        quint64 reclaimed = 0;         // 已释放的旧表
+    };
+    Stats stats() const { return m_stats; }
+    QString statsString() const;
+
+signals:
+    // 文件变化触发的重新加载已发布（GUI 线程）
+    void languageReloaded();
+
 private:
-    explicit Translator(QObject* parent = nullptr) : QObject(parent) {}
-    QMap<QString, QString> translations; // key: "Context|Source"
+    explicit Translator(QObject* parent = nullptr);
+
+    struct Table;
+
+    // 纯函数，可在任意线程调用
+    static std::unique_ptr<Table> build(const QString& langFile);
+    static bool buildFromCatalog(const QString& catalogFile, Table& table);
+    static bool buildFromText(const QString& langFile, Table& table);
+
+    void publish(std::shared_ptr<Table> table);
+    void reclaimRetired();
+    void watch(const QString& langFile);
+    void onFileChanged(const QString& path);
+    void startReload();
+
+    static const QString& fallback(quint64 key, const char* sourceText);
+
+    static constexpr int ReloadDelayMs = 300;
+    static constexpr int ReclaimRetryMs = 1000;
+
+    std::atomic<const Table*> m_current{ nullptr };
+    mutable std::atomic<int> m_readers{ 0 };
+
+    // 以下成员只在 GUI 线程访问
+    std::shared_ptr<const Table> m_table;                  // 当前表
+    std::vector<std::shared_ptr<const Table>> m_retired;  // 已替换、等待没有读者时释放
+    QTimer m_reclaimTimer;
+    quint64 m_revision = 0;
+    QString m_langFile;
+    QFileSystemWatcher* m_watcher = nullptr;
+    QTimer m_reloadTimer;
+    bool m_reloading = false;
+    bool m_reloadPending = false;
+
+    Stats m_stats;
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "traymenuplatform.h"
+#include "iconcache.h"
+#include "processinfocache.h"
+
+bool Win32TrayMenuPlatform::isWindow(HWND hwnd)
+{
+    return IsWindow(hwnd) != FALSE;
+}
+
+QIcon Win32TrayMenuPlatform::icon(quint64 iconKey)
+{
+    // 图标来自共享缓存，相同图标只转换一次
+    return iconKey ? IconCache::instance().icon(iconKey) : QIcon();
+}
+
+QString Win32TrayMenuPlatform::processName(DWORD processId)
+{
+    return ProcessInfoCache::instance().processName(processId);
+}
\ No newline at end of file
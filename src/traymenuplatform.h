@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QIcon>
+#include <QString>
+#include "platformtypes.h"
+
+// 托盘菜单依赖的平台查询接口
+// 真实实现使用 Win32 API、图标缓存和进程信息缓存，测试和基准测试可以替换为模拟实现
+class TrayMenuPlatform
+{
+public:
+    virtual ~TrayMenuPlatform() = default;
+
+    // 窗口句柄是否仍然有效（定时清理和触发菜单项时检查）
+    virtual bool isWindow(HWND hwnd) = 0;
+
+    // 图标键对应的图标，没有时返回空图标（菜单显示默认图标）
+    virtual QIcon icon(quint64 iconKey) = 0;
+
+    // 进程名，用于分组标题和工具提示
+    virtual QString processName(DWORD processId) = 0;
+};
+
+#ifdef _WIN32
+// 基于 Win32 API 和共享缓存的实现
+class Win32TrayMenuPlatform : public TrayMenuPlatform
+{
+public:
+    bool isWindow(HWND hwnd) override;
+    QIcon icon(quint64 iconKey) override;
+    QString processName(DWORD processId) override;
+};
+#endif
\ No newline at end of file
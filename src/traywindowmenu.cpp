@@ -0,0 +1,387 @@
+#include "traywindowmenu.h"
+#include "diagnostics.h"
+#include <QApplication>
+#include <QStyle>
+#include <algorithm>
+
+namespace {
+
+constexpr int MaxTitleLength = 40;
+
+} // namespace
+
+TrayWindowMenu::TrayWindowMenu(QMenu* menu, QAction* anchor, std::unique_ptr<TrayMenuPlatform> platform, QObject* parent)
+    : QObject(parent)
+    , m_menu(menu)
+    , m_anchor(anchor)
+    , m_platform(std::move(platform))
+    , m_sweepTimer(new QTimer(this))
+    , m_unknownTitle("Unknown Window")
+    , m_defaultIcon(QApplication::style()->standardIcon(QStyle::SP_ComputerIcon))
+{
+    connect(m_menu, &QMenu::aboutToShow, this, &TrayWindowMenu::onAboutToShow);
+
+    m_sweepTimer->setInterval(SweepIntervalMs);
+    connect(m_sweepTimer, &QTimer::timeout, this, &TrayWindowMenu::sweep);
+
+    m_diagnostics = Diagnostics::instance().registerSource("Tray menu", [this]() {
+        return statsString();
+        });
+}
+
+TrayWindowMenu::~TrayWindowMenu()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+}
+
+void TrayWindowMenu::insert(const Item& item)
+{
+    // 最近隐藏的窗口总在顶层最前面，新窗口插在它之前
+    QAction* front = m_order.isEmpty() ? nullptr : m_topLevel.value(m_order.last());
+
+    auto it = m_entries.find(item.hwnd);
+    if (it == m_entries.end()) {
+        it = m_entries.insert(item.hwnd, Entry());
+    }
+    else {
+        if (!it->topLevel) {
+            removeFromGroup(it->item);
+        }
+        m_order.remove(it->sequence);
+    }
+    it->item = item;
+    it->sequence = m_nextSequence++;
+    m_order.insert(it->sequence, item.hwnd);
+
+    if (it->topLevel) {
+        QAction* action = m_topLevel.value(item.hwnd);
+        updateAction(action, item);
+        if (action != front) {
+            m_menu->removeAction(action);
+            m_menu->insertAction(front, action);
+        }
+    }
+    else {
+        addTopLevel(*it, front ? front : groupsBegin());
+    }
+    balance();
+
+    if (!m_sweepTimer->isActive()) {
+        m_sweepTimer->start();
+    }
+}
+
+bool TrayWindowMenu::remove(HWND hwnd)
+{
+    auto it = m_entries.find(hwnd);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    if (it->topLevel) {
+        removeTopLevel(*it);
+    }
+    else {
+        removeFromGroup(it->item);
+    }
+    m_order.remove(it->sequence);
+    m_entries.erase(it);
+    balance();
+
+    if (m_entries.isEmpty()) {
+        m_sweepTimer->stop();
+    }
+    return true;
+}
+
+void TrayWindowMenu::setTitle(HWND hwnd, const QString& title)
+{
+    auto it = m_entries.find(hwnd);
+    if (it == m_entries.end() || it->item.title == title) {
+        return;
+    }
+    it->item.title = title;
+    if (it->topLevel) {
+        updateAction(m_topLevel.value(hwnd), it->item);
+    }
+    else {
+        markGroupDirty(it->item.processId);
+    }
+}
+
+void TrayWindowMenu::setUnknownTitle(const QString& text)
+{
+    if (m_unknownTitle == text) {
+        return;
+    }
+    m_unknownTitle = text;
+
+    // 只有没有标题的顶层动作显示这段文本；分组内容在下次展开时使用新文本
+    for (auto it = m_topLevel.constBegin(); it != m_topLevel.constEnd(); ++it) {
+        const Item& item = m_entries.value(it.key()).item;
+        if (item.title.isEmpty()) {
+            updateAction(it.value(), item);
+        }
+    }
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it) {
+        it->dirty = true;
+    }
+}
+
+void TrayWindowMenu::setTopLevelCap(int cap)
+{
+    cap = qMax(1, cap);
+    if (m_topLevelCap != cap) {
+        m_topLevelCap = cap;
+        balance();
+    }
+}
+
+void TrayWindowMenu::sweep()
+{
+    if (m_order.isEmpty()) {
+        m_sweepTimer->stop();
+        return;
+    }
+
+    // 按隐藏序号循环检查，每次只检查一批
+    QList<HWND> removed;
+    auto it = m_order.lowerBound(m_sweepCursor);
+    if (it == m_order.end()) {
+        it = m_order.begin();
+    }
+    for (int checked = 0; checked < SweepBatch && it != m_order.end(); ++checked, ++it) {
+        if (!m_platform->isWindow(it.value())) {
+            removed.append(it.value());
+        }
+    }
+    m_sweepCursor = it == m_order.end() ? 0 : it.key();
+    ++m_swept;
+
+    if (removed.isEmpty()) {
+        return;
+    }
+    for (HWND hwnd : removed) {
+        remove(hwnd);
+    }
+    m_pruned += removed.size();
+    emit windowsPruned(removed);
+}
+
+QList<HWND> TrayWindowMenu::windows() const
+{
+    QList<HWND> result;
+    result.reserve(m_order.size());
+    for (auto it = m_order.constEnd(); it != m_order.constBegin();) {
+        --it;
+        result.append(it.value());
+    }
+    return result;
+}
+
+void TrayWindowMenu::onAboutToShow()
+{
+    // 菜单内容随每次变化即时维护，打开时无需重建
+    ++m_opens;
+}
+
+void TrayWindowMenu::addTopLevel(Entry& entry, QAction* before)
+{
+    QAction* action = createAction(entry.item, m_menu);
+    m_menu->insertAction(before, action);
+    m_topLevel.insert(entry.item.hwnd, action);
+    entry.topLevel = true;
+}
+
+void TrayWindowMenu::removeTopLevel(Entry& entry)
+{
+    // 动作可能正在触发（恢复窗口时移除自身），延迟删除
+    QAction* action = m_topLevel.take(entry.item.hwnd);
+    m_menu->removeAction(action);
+    action->deleteLater();
+    entry.topLevel = false;
+}
+
+void TrayWindowMenu::balance()
+{
+    // 从最近隐藏往前数第 n 个窗口（n 从 0 开始）
+    auto newest = [this](int n) {
+        auto it = m_order.constEnd();
+        for (int i = 0; i <= n; ++i) {
+            --it;
+        }
+        return it.value();
+    };
+
+    while (m_topLevel.size() > m_topLevelCap) {
+        Entry& entry = m_entries[newest(int(m_topLevel.size()) - 1)];
+        removeTopLevel(entry);
+        addToGroup(entry.item);
+        ++m_moves;
+    }
+
+    while (m_topLevel.size() < m_topLevelCap && m_topLevel.size() < m_entries.size()) {
+        Entry& entry = m_entries[newest(int(m_topLevel.size()))];
+        removeFromGroup(entry.item);
+        addTopLevel(entry, groupsBegin());
+        ++m_moves;
+    }
+}
+
+void TrayWindowMenu::addToGroup(const Item& item)
+{
+    auto it = m_groups.find(item.processId);
+    if (it == m_groups.end()) {
+        Group group;
+        group.name = m_platform->processName(item.processId);
+        if (group.name.isEmpty()) {
+            group.name = QString::number(item.processId);
+        }
+        group.menu = new QMenu(m_menu);
+        group.menu->setIcon(iconFor(item));
+        const DWORD processId = item.processId;
+        connect(group.menu, &QMenu::aboutToShow, this, [this, processId]() {
+            buildGroup(processId);
+            });
+
+        // 按进程名插入到有序位置
+        auto position = std::lower_bound(m_groupOrder.begin(), m_groupOrder.end(), group.name,
+            [this](DWORD other, const QString& name) {
+                return m_groups.constFind(other)->name.compare(name, Qt::CaseInsensitive) < 0;
+            });
+        QAction* before = position == m_groupOrder.end() ? m_anchor : m_groups.constFind(*position)->menu->menuAction();
+        m_menu->insertAction(before, group.menu->menuAction());
+        m_groupOrder.insert(position, processId);
+        it = m_groups.insert(processId, group);
+    }
+    it->windows.insert(item.hwnd);
+    it->dirty = true;
+    updateGroupTitle(*it);
+}
+
+void TrayWindowMenu::removeFromGroup(const Item& item)
+{
+    auto it = m_groups.find(item.processId);
+    if (it == m_groups.end()) {
+        return;
+    }
+    it->windows.remove(item.hwnd);
+    it->dirty = true;
+
+    // 空分组连同子菜单一起释放
+    if (it->windows.isEmpty()) {
+        m_menu->removeAction(it->menu->menuAction());
+        it->menu->deleteLater();
+        m_groupOrder.removeOne(item.processId);
+        m_groups.erase(it);
+        return;
+    }
+    updateGroupTitle(*it);
+}
+
+void TrayWindowMenu::markGroupDirty(DWORD processId)
+{
+    auto it = m_groups.find(processId);
+    if (it != m_groups.end()) {
+        it->dirty = true;
+    }
+}
+
+void TrayWindowMenu::updateGroupTitle(const Group& group)
+{
+    group.menu->setTitle(QString("%1 (%2)").arg(group.name).arg(group.windows.size()));
+}
+
+QAction* TrayWindowMenu::groupsBegin() const
+{
+    return m_groupOrder.isEmpty() ? m_anchor : m_groups.constFind(m_groupOrder.first())->menu->menuAction();
+}
+
+void TrayWindowMenu::buildGroup(DWORD processId)
+{
+    auto it = m_groups.find(processId);
+    if (it == m_groups.end() || !it->dirty) {
+        return;
+    }
+    it->dirty = false;
+    ++m_groupBuilds;
+
+    // 分组内同样按最近隐藏排序
+    QList<const Entry*> entries;
+    entries.reserve(it->windows.size());
+    for (HWND hwnd : it->windows) {
+        entries.append(&m_entries[hwnd]);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->sequence > b->sequence;
+        });
+
+    QMenu* menu = it->menu;
+    qDeleteAll(menu->actions());
+    for (const Entry* entry : entries) {
+        menu->addAction(createAction(entry->item, menu));
+    }
+}
+
+QAction* TrayWindowMenu::createAction(const Item& item, QWidget* parent)
+{
+    ++m_actionsBuilt;
+
+    HWND hwnd = item.hwnd;
+    QAction* action = new QAction(iconFor(item), displayText(item), parent);
+    action->setData(reinterpret_cast<qulonglong>(hwnd));
+    action->setToolTip(toolTip(item));
+
+    connect(action, &QAction::triggered, this, [this, hwnd]() {
+        // 窗口可能在两次定时检查之间被销毁
+        if (!m_platform->isWindow(hwnd)) {
+            remove(hwnd);
+            ++m_pruned;
+            emit windowsPruned({ hwnd });
+            return;
+        }
+        emit restoreRequested(hwnd);
+        });
+    return action;
+}
+
+void TrayWindowMenu::updateAction(QAction* action, const Item& item)
+{
+    ++m_actionUpdates;
+    action->setText(displayText(item));
+    action->setToolTip(toolTip(item));
+    action->setIcon(iconFor(item));
+}
+
+QString TrayWindowMenu::displayText(const Item& item) const
+{
+    QString text = item.title.isEmpty() ? m_unknownTitle : item.title;
+
+    // 限制标题长度
+    if (text.length() > MaxTitleLength) {
+        text = text.left(MaxTitleLength - 3) + "...";
+    }
+    return text;
+}
+
+QString TrayWindowMenu::toolTip(const Item& item) const
+{
+    // 工具提示显示更详细的信息
+    return QString("%1\nProcess: %2\nHandle: 0x%3")
+        .arg(item.title)
+        .arg(m_platform->processName(item.processId))
+        .arg(QString::number(reinterpret_cast<qulonglong>(item.hwnd), 16).toUpper());
+}
+
+QIcon TrayWindowMenu::iconFor(const Item& item) const
+{
+    QIcon icon = m_platform->icon(item.iconKey);
+    return icon.isNull() ? m_defaultIcon : icon;
+}
+
+QString TrayWindowMenu::statsString() const
+{
+    return QString("entries=%1 groups=%2 top=%3 opens=%4 actions=%5 updates=%6 moves=%7 groupBuilds=%8 sweeps=%9 pruned=%10")
+        .arg(m_entries.size()).arg(m_groups.size()).arg(m_topLevelCap).arg(m_opens)
+        .arg(m_actionsBuilt).arg(m_actionUpdates).arg(m_moves)
+        .arg(m_groupBuilds).arg(m_swept).arg(m_pruned);
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QAction>
+#include <QHash>
+#include <QIcon>
+#include <QList>
+#include <QMap>
+#include <QMenu>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include "platformtypes.h"
+#include "traymenuplatform.h"
+
+// 托盘菜单中隐藏到应用托盘的窗口
+// 菜单作为按窗口句柄索引的集合维护：每次插入、移除或改名只增删或修改受影响的那一个动作。
+// 最近隐藏的若干窗口直接放在顶层，窗口较多时其余按进程分组到子菜单（顶层已有的窗口不再出现在分组中），
+// 超出上限时只有越过边界的那个窗口在顶层和分组之间移动；子菜单的内容在子菜单展开时才生成。
+// 打开菜单时不做任何重建。
+// 已销毁的窗口由后台定时分批检查清理，打开菜单时不逐个检查。
+// 所有条目插在固定的锚点动作之前，不再通过查找分隔符定位。
+// 窗口有效性、图标和进程名都通过 TrayMenuPlatform 查询，不直接调用 Win32 API。
+class TrayWindowMenu : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        HWND hwnd = nullptr;
+        QString title;
+        DWORD processId = 0;
+        quint64 iconKey = 0;     // 图标键，由 TrayMenuPlatform::icon 解析
+    };
+
+    static constexpr int DefaultTopLevelCap = 10;
+    static constexpr int SweepIntervalMs = 2000;
+    static constexpr int SweepBatch = 64;
+
+    TrayWindowMenu(QMenu* menu, QAction* anchor, std::unique_ptr<TrayMenuPlatform> platform, QObject* parent = nullptr);
+    ~TrayWindowMenu();
+
+    // 插入窗口项（移到最近使用的位置），已存在时更新
+    void insert(const Item& item);
+    bool remove(HWND hwnd);
+    void setTitle(HWND hwnd, const QString& title);
+
+    // 标题为空时显示的文本，切换语言时更新
+    void setUnknownTitle(const QString& text);
+
+    // 顶层最多显示的窗口数
+    void setTopLevelCap(int cap);
+    int topLevelCap() const { return m_topLevelCap; }
+
+    bool contains(HWND hwnd) const { return m_entries.contains(hwnd); }
+    int count() const { return m_entries.size(); }
+    // 按最近隐藏在前的顺序
+    QList<HWND> windows() const;
+
+    QString statsString() const;
+
+signals:
+    void restoreRequested(HWND hwnd);
+    // 清理掉的已销毁窗口
+    void windowsPruned(const QList<HWND>& windows);
+
+private slots:
+    void onAboutToShow();
+
+    // 每次检查最多 SweepBatch 个窗口，从上次停下的位置继续
+    void sweep();
+
+private:
+    struct Entry {
+        Item item;
+        quint64 sequence = 0;
+        bool topLevel = false;   // 显示在顶层，不属于任何分组
+    };
+
+    struct Group {
+        QString name;            // 进程名，创建分组时取一次，用于排序和标题
+        QSet<HWND> windows;
+        QMenu* menu = nullptr;
+        bool dirty = true;       // 子菜单内容需要在下次展开时重新生成
+    };
+
+    // 顶层动作按最近隐藏在前排列，之后是按进程名排序的分组子菜单，最后是锚点
+    void addTopLevel(Entry& entry, QAction* before);
+    void removeTopLevel(Entry& entry);
+
+    // 顶层窗口总是 m_order 的一个后缀：超出上限时把最旧的顶层窗口移入分组，
+    // 有空位时把最近的分组窗口提升到顶层末尾
+    void balance();
+
+    void addToGroup(const Item& item);
+    void removeFromGroup(const Item& item);
+    void markGroupDirty(DWORD processId);
+    void updateGroupTitle(const Group& group);
+    void buildGroup(DWORD processId);
+
+    // 第一个分组的子菜单动作，没有分组时为锚点
+    QAction* groupsBegin() const;
+
+    QAction* createAction(const Item& item, QWidget* parent);
+    void updateAction(QAction* action, const Item& item);
+    QString displayText(const Item& item) const;
+    QString toolTip(const Item& item) const;
+    QIcon iconFor(const Item& item) const;
+
+    QMenu* m_menu;
+    QAction* m_anchor;
+    std::unique_ptr<TrayMenuPlatform> m_platform;
+    QHash<HWND, Entry> m_entries;
+    QMap<quint64, HWND> m_order;          // 隐藏序号 -> 窗口，末尾为最近隐藏
+    QHash<HWND, QAction*> m_topLevel;     // 顶层窗口 -> 菜单动作
+    QHash<DWORD, Group> m_groups;         // 进程ID -> 分组
+    QList<DWORD> m_groupOrder;            // 分组在菜单中的顺序（按进程名）
+    QTimer* m_sweepTimer;
+    quint64 m_sweepCursor = 0;            // 下一次检查的起始隐藏序号
+    quint64 m_nextSequence = 0;
+    int m_topLevelCap = DefaultTopLevelCap;
+    QString m_unknownTitle;
+    QIcon m_defaultIcon;
+
+    quint64 m_opens = 0;
+    quint64 m_groupBuilds = 0;
+    quint64 m_actionsBuilt = 0;
+    quint64 m_actionUpdates = 0;
+    quint64 m_moves = 0;                  // 顶层与分组之间的移动
+    quint64 m_swept = 0;
+    quint64 m_pruned = 0;
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
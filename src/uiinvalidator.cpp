@@ -0,0 +1,139 @@
+#include "uiinvalidator.h"
+#include "diagnostics.h"
+#include <QStringList>
+
+namespace {
+
+const char* const RegionNames[UiInvalidator::RegionCount] = {
+    "windows", "hidden", "tray"
+};
+
+} // namespace
+
+UiInvalidator::UiInvalidator(QObject* parent)
+    : QObject(parent)
+{
+    for (Slot& slot : m_slots) {
+        slot.timer = new QTimer(this);
+        slot.timer->setSingleShot(true);
+        connect(slot.timer, &QTimer::timeout, this, &UiInvalidator::onTimeout);
+    }
+
+    m_diagnostics = Diagnostics::instance().registerSource("UI invalidation", [this]() {
+        return statsString();
+        });
+}
+
+UiInvalidator::~UiInvalidator()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+}
+
+void UiInvalidator::setHandler(Region region, std::function<void()> handler)
+{
+    m_slots[indexOf(region)].handler = std::move(handler);
+}
+
+void UiInvalidator::setDelay(Region region, int ms)
+{
+    m_slots[indexOf(region)].delay = qMax(0, ms);
+}
+
+void UiInvalidator::invalidate(int regions)
+{
+    for (int i = 0; i < RegionCount; ++i) {
+        int region = 1 << i;
+        if (!(regions & region)) {
+            continue;
+        }
+
+        ++m_slots[i].invalidations;
+        if (m_dirty & region) {
+            // 已经排队，合并到同一次刷新
+            continue;
+        }
+        m_dirty |= region;
+        schedule(i);
+    }
+}
+
+void UiInvalidator::flush(int regions)
+{
+    // 刷新过程中再次失效的区域留到下一轮，避免递归
+    if (m_flushing) {
+        return;
+    }
+    m_flushing = true;
+
+    for (int i = 0; i < RegionCount; ++i) {
+        int region = 1 << i;
+        if (!(regions & region) || !(m_dirty & region)) {
+            continue;
+        }
+
+        // 先清除标记，处理函数中再次标记时重新排队
+        m_dirty &= ~region;
+        Slot& slot = m_slots[i];
+        slot.timer->stop();
+        ++slot.flushes;
+        if (slot.handler) {
+            slot.handler();
+        }
+    }
+
+    m_flushing = false;
+
+    // 刷新期间产生的失效
+    for (int i = 0; i < RegionCount; ++i) {
+        if ((m_dirty & (1 << i)) && !m_slots[i].timer->isActive()) {
+            schedule(i);
+        }
+    }
+}
+
+void UiInvalidator::onTimeout()
+{
+    // 只刷新到期的区域
+    int due = 0;
+    for (int i = 0; i < RegionCount; ++i) {
+        if (!m_slots[i].timer->isActive()) {
+            due |= 1 << i;
+        }
+    }
+    flush(due);
+}
+
+void UiInvalidator::schedule(int index)
+{
+    Slot& slot = m_slots[index];
+    if (m_flushing) {
+        return;
+    }
+    slot.timer->start(slot.delay);
+}
+
+int UiInvalidator::indexOf(int region)
+{
+    for (int i = 0; i < RegionCount; ++i) {
+        if (region == (1 << i)) {
+            return i;
+        }
+    }
+    Q_ASSERT(false);
+    return 0;
+}
+
+QString UiInvalidator::statsString() const
+{
+    QStringList parts;
+    quint64 invalidations = 0;
+    quint64 flushes = 0;
+    for (int i = 0; i < RegionCount; ++i) {
+        const Slot& slot = m_slots[i];
+        invalidations += slot.invalidations;
+        flushes += slot.flushes;
+        parts.append(QString("%1=%2/%3").arg(RegionNames[i]).arg(slot.flushes).arg(slot.invalidations));
+    }
+    return QString("invalidations=%1 flushes=%2 avoided=%3\nflushes/invalidations: %4")
+        .arg(invalidations).arg(flushes).arg(invalidations - flushes).arg(parts.join(" "));
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+// 界面失效调度器
+// 各组件只标记区域失效，同一事件循环轮次内的重复标记合并，
+// 每个区域在下一轮最多刷新一次；也可以为区域设置额外的合并延迟
+class UiInvalidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Region {
+        WindowTable = 0x1,     // 窗口列表
+        HiddenTable = 0x2,     // 隐藏窗口列表
+        TrayMenu = 0x4         // 托盘菜单
+    };
+    static constexpr int RegionCount = 3;
+    static constexpr int AllRegions = WindowTable | HiddenTable | TrayMenu;
+
+    explicit UiInvalidator(QObject* parent = nullptr);
+    ~UiInvalidator();
+
+    // 区域失效时调用的刷新函数
+    void setHandler(Region region, std::function<void()> handler);
+
+    // 区域的合并延迟（毫秒），0 表示下一轮事件循环
+    void setDelay(Region region, int ms);
+
+    // 标记区域失效
+    void invalidate(int regions);
+
+    // 立即刷新已失效的区域
+    void flush(int regions = AllRegions);
+
+    bool isDirty(int regions) const { return (m_dirty & regions) != 0; }
+
+    QString statsString() const;
+
+private slots:
+    void onTimeout();
+
+private:
+    static int indexOf(int region);
+    void schedule(int index);
+
+    struct Slot {
+        std::function<void()> handler;
+        QTimer* timer = nullptr;
+        int delay = 0;
+        quint64 invalidations = 0;
+        quint64 flushes = 0;
+    };
+
+    Slot m_slots[RegionCount];
+    int m_dirty = 0;
+    bool m_flushing = false;
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
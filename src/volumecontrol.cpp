@@ -1,4 +1,5 @@
 #include "volumecontrol.h"
+#include "processinfocache.h"
 #include <QDebug>
 #include <thread>
 #include <atomic>
@@ -9,14 +10,7 @@
 
 QString VolumeControl::GetExeName(DWORD pid)
 {
-    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-    if (!h) return {};
-    wchar_t path[MAX_PATH]{};
-    DWORD len = MAX_PATH;
-    QueryFullProcessImageNameW(h, 0, path, &len);
-    CloseHandle(h);
-    const wchar_t* name = wcsrchr(path, L'\\');
-    return QString::fromWCharArray(name ? name + 1 : path).toLower();
+    return ProcessInfoCache::instance().processName(pid).toLower();
 }
 
 bool VolumeControl::SetProcessMute(DWORD processId, bool mute)
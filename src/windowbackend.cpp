@@ -0,0 +1,54 @@
+#include "windowbackend.h"
+#include "processinfocache.h"
+#include "iconcache.h"
+#include "windowfilter.h"
+
+void Win32WindowBackend::beginReconcile()
+{
+    // 每轮对账只取一次进程快照
+    ProcessInfoCache::instance().refresh();
+}
+
+QList<HWND> Win32WindowBackend::enumerate()
+{
+    QList<HWND> order;
+    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
+        reinterpret_cast<QList<HWND>*>(lParam)->append(hwnd);
+        return TRUE;
+        }, reinterpret_cast<LPARAM>(&order));
+    return order;
+}
+
+bool Win32WindowBackend::query(HWND hwnd, WindowInfo& info)
+{
+    // 过滤条件（可见性、样式、所有者、进程、类名）
+    WindowCandidate candidate(hwnd);
+    if (!WindowFilter::instance().accept(candidate)) {
+        return false;
+    }
+
+    // 以下只对通过过滤的窗口执行
+    wchar_t title[256];
+    int length = GetWindowText(hwnd, title, 256);
+    QString windowTitle = QString::fromWCharArray(title, length);
+
+    // 获取进程名
+    QString processNameStr = ProcessInfoCache::instance().processName(candidate.processId);
+    if (processNameStr.isEmpty()) {
+        processNameStr = "Unknown";
+    }
+
+    // 获取窗口图标键，转换为 QIcon 的工作留给 GUI 线程
+    quint64 iconKey = IconCache::instance().resolve(hwnd, candidate.processId);
+
+    info.title = windowTitle;
+    info.processName = processNameStr;
+    info.className = candidate.className;
+    info.processId = candidate.processId;
+    info.hwnd = hwnd;
+    info.isVisible = true;
+    info.isHidden = false; // 会在外部设置
+    info.iconKey = iconKey;
+
+    return true;
+}
\ No newline at end of file
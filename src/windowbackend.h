@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QList>
+#include "windowinfo.h"
+
+// 窗口查询后端接口
+// 真实实现调用 Win32 API，也可以替换为合成的窗口数据用于基准测试
+class WindowBackend
+{
+public:
+    virtual ~WindowBackend() = default;
+
+    // 每轮全量对账开始时调用
+    virtual void beginReconcile() {}
+
+    // 按 Z 序枚举所有顶层窗口
+    virtual QList<HWND> enumerate() = 0;
+
+    // 判断窗口是否应列出，并填充信息
+    virtual bool query(HWND hwnd, WindowInfo& info) = 0;
+};
+
+#ifdef _WIN32
+// 基于 Win32 API 的窗口查询后端
+class Win32WindowBackend : public WindowBackend
+{
+public:
+    void beginReconcile() override;
+    QList<HWND> enumerate() override;
+    bool query(HWND hwnd, WindowInfo& info) override;
+};
+#endif
\ No newline at end of file
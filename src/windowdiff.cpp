@@ -0,0 +1,191 @@
+#include "windowdiff.h"
+#include "windowsnapshot.h"
+
+namespace {
+
+// FNV-1a 64 位
+constexpr quint64 FnvOffset = 14695981039346656037ull;
+constexpr quint64 FnvPrime = 1099511628211ull;
+
+quint64 mixBytes(quint64 h, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= FnvPrime;
+    }
+    return h;
+}
+
+quint64 mixString(quint64 h, const QString& s)
+{
+    h = mixBytes(h, s.constData(), s.size() * sizeof(QChar));
+    // 分隔符，避免 "ab"+"c" 与 "a"+"bc" 得到相同指纹
+    return mixBytes(h, "\0", 1);
+}
+
+template <typename T>
+quint64 mixValue(quint64 h, const T& value)
+{
+    return mixBytes(h, &value, sizeof(value));
+}
+
+// 差异计算的数据来源：窗口列表
+class ListSource
+{
+public:
+    explicit ListSource(const QList<QPair<HWND, WindowInfo>>& windows) : m_windows(windows) {}
+
+    int size() const { return m_windows.size(); }
+    HWND hwnd(int i) const { return m_windows[i].first; }
+    quint64 fingerprint(int i) const { return WindowDiff::fingerprint(m_windows[i].second); }
+    WindowInfo info(int i) const { return m_windows[i].second; }
+
+private:
+    const QList<QPair<HWND, WindowInfo>>& m_windows;
+};
+
+// 差异计算的数据来源：列式快照 + 隐藏窗口集合
+class SnapshotSource
+{
+public:
+    SnapshotSource(const WindowSnapshot& snapshot, const QSet<HWND>& hidden)
+        : m_snapshot(snapshot), m_hidden(hidden) {}
+
+    int size() const { return m_snapshot.size(); }
+    HWND hwnd(int i) const { return m_snapshot.hwnds[i]; }
+
+    quint64 fingerprint(int i) const
+    {
+        return WindowDiff::withHidden(m_snapshot.fingerprints[i], m_hidden.contains(m_snapshot.hwnds[i]));
+    }
+
+    WindowInfo info(int i) const
+    {
+        WindowInfo result = m_snapshot.info(i);
+        result.isHidden = m_hidden.contains(result.hwnd);
+        return result;
+    }
+
+private:
+    const WindowSnapshot& m_snapshot;
+    const QSet<HWND>& m_hidden;
+};
+
+}
+
+WindowDelta WindowDiff::update(const QList<QPair<HWND, WindowInfo>>& windows)
+{
+    return apply(ListSource(windows));
+}
+
+WindowDelta WindowDiff::update(const WindowSnapshot& snapshot, const QSet<HWND>& hidden)
+{
+    return apply(SnapshotSource(snapshot, hidden));
+}
+
+template <typename Source>
+WindowDelta WindowDiff::apply(const Source& source)
+{
+    WindowDelta delta;
+    const int count = source.size();
+
+    QVector<Entry> entries;
+    entries.reserve(count);
+    QHash<HWND, int> index;
+    index.reserve(count);
+
+    // 保留下来的窗口在旧列表中的位置应当递增，否则说明顺序变化
+    int lastOldPos = -1;
+
+    for (int i = 0; i < count; ++i) {
+        HWND hwnd = source.hwnd(i);
+        quint64 fp = source.fingerprint(i);
+        index.insert(hwnd, i);
+
+        auto it = m_index.constFind(hwnd);
+        if (it == m_index.constEnd()) {
+            entries.append({ hwnd, fp, source.info(i) });
+            delta.added.append(hwnd);
+            continue;
+        }
+
+        int oldPos = it.value();
+        if (oldPos < lastOldPos) {
+            delta.reordered = true;
+        }
+        lastOldPos = oldPos;
+
+        const Entry& old = m_entries[oldPos];
+        if (old.fingerprint == fp) {
+            // 未变化：沿用旧内容，不构造新字符串
+            entries.append(old);
+            continue;
+        }
+
+        WindowInfo info = source.info(i);
+        quint32 mask = changedFields(old.info, info);
+        if (mask) {
+            delta.changed.append(qMakePair(hwnd, mask));
+        }
+        entries.append({ hwnd, fp, std::move(info) });
+    }
+
+    for (const Entry& entry : m_entries) {
+        if (!index.contains(entry.hwnd)) {
+            delta.removed.append(entry.hwnd);
+        }
+    }
+
+    m_entries = std::move(entries);
+    m_index = std::move(index);
+    return delta;
+}
+
+void WindowDiff::reset()
+{
+    m_entries.clear();
+    m_index.clear();
+}
+
+const WindowInfo* WindowDiff::find(HWND hwnd) const
+{
+    auto it = m_index.constFind(hwnd);
+    return it == m_index.constEnd() ? nullptr : &m_entries[it.value()].info;
+}
+
+quint64 WindowDiff::contentFingerprint(const WindowInfo& info)
+{
+    quint64 h = FnvOffset;
+    h = mixString(h, info.title);
+    h = mixString(h, info.processName);
+    h = mixString(h, info.className);
+    h = mixValue(h, info.processId);
+    h = mixValue(h, info.iconKey);
+    quint8 visible = info.isVisible ? 1 : 0;
+    return mixValue(h, visible);
+}
+
+quint64 WindowDiff::withHidden(quint64 fingerprint, bool hidden)
+{
+    quint8 flag = hidden ? 1 : 0;
+    return mixValue(fingerprint, flag);
+}
+
+quint64 WindowDiff::fingerprint(const WindowInfo& info)
+{
+    return withHidden(contentFingerprint(info), info.isHidden);
+}
+
+quint32 WindowDiff::changedFields(const WindowInfo& a, const WindowInfo& b)
+{
+    quint32 mask = 0;
+    if (a.title != b.title) mask |= TitleField;
+    if (a.processName != b.processName) mask |= ProcessNameField;
+    if (a.className != b.className) mask |= ClassNameField;
+    if (a.processId != b.processId) mask |= ProcessIdField;
+    if (a.isVisible != b.isVisible) mask |= VisibleField;
+    if (a.isHidden != b.isHidden) mask |= HiddenField;
+    if (a.iconKey != b.iconKey) mask |= IconField;
+    return mask;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+#include "windowinfo.h"
+
+struct WindowSnapshot;
+
+// 窗口字段，用于标记变化的内容
+enum WindowField : quint32 {
+    TitleField       = 1u << 0,
+    ProcessNameField = 1u << 1,
+    ClassNameField   = 1u << 2,
+    ProcessIdField   = 1u << 3,
+    VisibleField     = 1u << 4,
+    HiddenField      = 1u << 5,
+    IconField        = 1u << 6
+};
+
+// 两次窗口列表之间的增量，与顺序无关
+struct WindowDelta {
+    QVector<HWND> added;                     // 按新列表顺序
+    QVector<HWND> removed;
+    QVector<QPair<HWND, quint32>> changed;   // 窗口句柄 + WindowField 掩码
+    bool reordered = false;                  // 保留下来的窗口相对顺序发生变化
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty() && !reordered; }
+};
+
+// 基于指纹的窗口差异计算
+// 每个窗口的相关字段散列为 64 位指纹，指纹相同即视为未变化，
+// 只有指纹不同时才逐字段比较以得到变化掩码
+class WindowDiff
+{
+public:
+    // 与上一次的列表比较，返回增量，并以 windows 作为新的基准
+    WindowDelta update(const QList<QPair<HWND, WindowInfo>>& windows);
+
+    // 直接对列式快照求差异，只为新增和变化的窗口构造 WindowInfo
+    WindowDelta update(const WindowSnapshot& snapshot, const QSet<HWND>& hidden);
+
+    void reset();
+
+    const WindowInfo* find(HWND hwnd) const;
+
+    // 内容指纹不含隐藏标记，可以在快照构建时预先计算
+    static quint64 contentFingerprint(const WindowInfo& info);
+    static quint64 withHidden(quint64 fingerprint, bool hidden);
+    static quint64 fingerprint(const WindowInfo& info);
+
+    static quint32 changedFields(const WindowInfo& a, const WindowInfo& b);
+
+private:
+    struct Entry {
+        HWND hwnd;
+        quint64 fingerprint;
+        WindowInfo info;
+    };
+
+    template <typename Source>
+    WindowDelta apply(const Source& source);
+
+    QVector<Entry> m_entries;
+    QHash<HWND, int> m_index;   // 窗口句柄 -> m_entries 中的位置
+};
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "windoweventsource.h"
+#include <QDebug>
+
+// 静态成员初始化
+WinEventHookSource* WinEventHookSource::s_instance = nullptr;
+
+WinEventHookSource::WinEventHookSource(QObject* parent)
+    : WindowEventSource(parent)
+{
+}
+
+WinEventHookSource::~WinEventHookSource()
+{
+    stop();
+}
+
+bool WinEventHookSource::start()
+{
+    if (isRunning()) {
+        return true;
+    }
+
+    // 系统回调不携带上下文，同一时间只允许一个钩子事件源
+    if (s_instance && s_instance != this) {
+        qWarning() << "Another window event hook source is already running";
+        return false;
+    }
+
+    const DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+
+    // 创建/销毁/显示/隐藏 是连续的事件区间
+    const DWORD ranges[][2] = {
+        { EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE },
+        { EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE },
+        { EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND }
+    };
+
+    s_instance = this;
+    for (const auto& range : ranges) {
+        HWINEVENTHOOK hook = SetWinEventHook(range[0], range[1], nullptr,
+            winEventProc, 0, 0, flags);
+        if (!hook) {
+            qWarning() << "Failed to install window event hook:" << GetLastError();
+            stop();
+            return false;
+        }
+        m_hooks.append(hook);
+    }
+
+    return true;
+}
+
+void WinEventHookSource::stop()
+{
+    for (HWINEVENTHOOK hook : m_hooks) {
+        UnhookWinEvent(hook);
+    }
+    m_hooks.clear();
+
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+void CALLBACK WinEventHookSource::winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+    LONG idObject, LONG idChild, DWORD idEventThread, DWORD eventTime)
+{
+    Q_UNUSED(hook);
+    Q_UNUSED(idEventThread);
+    Q_UNUSED(eventTime);
+
+    // 只关心窗口本身的事件，忽略光标、插入符等子对象
+    if (!s_instance || !hwnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) {
+        return;
+    }
+
+    // 过滤子窗口（销毁事件时窗口已不存在，交由注册表按句柄判断）
+    if (event != EVENT_OBJECT_DESTROY && GetAncestor(hwnd, GA_PARENT) != GetDesktopWindow()) {
+        return;
+    }
+
+    WindowEventType type;
+    switch (event) {
+    case EVENT_OBJECT_CREATE:     type = WindowEventType::Created; break;
+    case EVENT_OBJECT_DESTROY:    type = WindowEventType::Destroyed; break;
+    case EVENT_OBJECT_SHOW:       type = WindowEventType::Shown; break;
+    case EVENT_OBJECT_HIDE:       type = WindowEventType::Hidden; break;
+    case EVENT_OBJECT_NAMECHANGE: type = WindowEventType::NameChanged; break;
+    case EVENT_SYSTEM_FOREGROUND: type = WindowEventType::Foreground; break;
+    default:
+        return;
+    }
+
+    emit s_instance->windowEvent(hwnd, type);
+}
\ No newline at end of file
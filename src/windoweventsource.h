@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include "platformtypes.h"
+
+// 窗口事件类型
+enum class WindowEventType {
+    Created,
+    Destroyed,
+    Shown,
+    Hidden,
+    NameChanged,
+    Foreground
+};
+
+// 窗口事件源接口
+// 真实实现基于系统事件钩子，也可以由脚本化的模拟事件驱动
+class WindowEventSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowEventSource(QObject* parent = nullptr) : QObject(parent) {}
+    virtual ~WindowEventSource() = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+
+signals:
+    void windowEvent(HWND hwnd, WindowEventType type);
+};
+
+#ifdef _WIN32
+// 基于 SetWinEventHook 的窗口事件源
+// 回调在安装钩子的线程上分发，该线程需要运行消息循环
+class WinEventHookSource : public WindowEventSource
+{
+    Q_OBJECT
+
+public:
+    explicit WinEventHookSource(QObject* parent = nullptr);
+    ~WinEventHookSource() override;
+
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override { return !m_hooks.isEmpty(); }
+
+private:
+    static void CALLBACK winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+        LONG idObject, LONG idChild, DWORD idEventThread, DWORD eventTime);
+
+    QVector<HWINEVENTHOOK> m_hooks;
+
+    static WinEventHookSource* s_instance;
+};
+#endif
\ No newline at end of file
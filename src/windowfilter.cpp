@@ -0,0 +1,169 @@
+#include "windowfilter.h"
+#include "diagnostics.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+WindowFilter& WindowFilter::instance()
+{
+    static WindowFilter inst;
+    return inst;
+}
+
+WindowFilter::WindowFilter()
+    : m_currentProcessId(GetCurrentProcessId())
+{
+    // 执行顺序：只读窗口状态的检查在前，需要字符串拷贝的类名检查在最后
+    m_stages[VisibleStage] = &WindowFilter::isVisible;
+    m_stages[ToolWindowStage] = &WindowFilter::isNotToolWindow;
+    m_stages[NoActivateStage] = &WindowFilter::isActivatable;
+    m_stages[OwnerStage] = &WindowFilter::isUnowned;
+    m_stages[OwnProcessStage] = &WindowFilter::isOtherProcess;
+    m_stages[DeletedStage] = &WindowFilter::isNotDeleted;
+    m_stages[ExcludedClassStage] = &WindowFilter::isAllowedClass;
+
+    setExcludedClasses(defaultExcludedClasses());
+
+    Diagnostics::instance().registerSource("Window filter", [this]() {
+        return statsString();
+        });
+}
+
+QStringList WindowFilter::defaultExcludedClasses()
+{
+    return {
+        "ApplicationFrameWindow",
+        "Windows.UI.Core.CoreWindow",
+        "StartMenuSizingFrame",
+        "Shell_LightDismissOverlay"
+    };
+}
+
+void WindowFilter::setExcludedClasses(const QStringList& classes)
+{
+    QSet<QString> excluded;
+    for (const QString& name : classes) {
+        QString trimmed = name.trimmed();
+        if (!trimmed.isEmpty()) {
+            excluded.insert(trimmed);
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_excludedClasses = excluded;
+}
+
+bool WindowFilter::accept(WindowCandidate& candidate)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.evaluated;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 last = 0;
+
+    for (int stage = 0; stage < StageCount; ++stage) {
+        bool passed = (this->*m_stages[stage])(candidate);
+
+        qint64 now = timer.nsecsElapsed();
+        m_stats.nsecs[stage] += now - last;
+        last = now;
+
+        if (!passed) {
+            ++m_stats.rejected[stage];
+            return false;
+        }
+    }
+
+    ++m_stats.accepted;
+    return true;
+}
+
+void WindowFilter::loadStyle(WindowCandidate& c)
+{
+    if (!c.styleLoaded) {
+        c.exStyle = GetWindowLongPtr(c.hwnd, GWL_EXSTYLE);
+        c.styleLoaded = true;
+    }
+}
+
+bool WindowFilter::isVisible(WindowCandidate& c) const
+{
+    return IsWindow(c.hwnd) && IsWindowVisible(c.hwnd);
+}
+
+bool WindowFilter::isNotToolWindow(WindowCandidate& c) const
+{
+    loadStyle(c);
+    return !(c.exStyle & WS_EX_TOOLWINDOW);
+}
+
+bool WindowFilter::isActivatable(WindowCandidate& c) const
+{
+    loadStyle(c);
+    return !(c.exStyle & WS_EX_NOACTIVATE) || (c.exStyle & WS_EX_APPWINDOW);
+}
+
+bool WindowFilter::isUnowned(WindowCandidate& c) const
+{
+    // 有所有者的窗口只有显式声明 WS_EX_APPWINDOW 才列出
+    loadStyle(c);
+    return !GetWindow(c.hwnd, GW_OWNER) || (c.exStyle & WS_EX_APPWINDOW);
+}
+
+bool WindowFilter::isOtherProcess(WindowCandidate& c) const
+{
+    if (!c.processLoaded) {
+        GetWindowThreadProcessId(c.hwnd, &c.processId);
+        c.processLoaded = true;
+    }
+    return c.processId != m_currentProcessId;
+}
+
+bool WindowFilter::isNotDeleted(WindowCandidate& c) const
+{
+    return !GetProp(c.hwnd, L"ITaskList_Deleted");
+}
+
+bool WindowFilter::isAllowedClass(WindowCandidate& c) const
+{
+    if (!c.classLoaded) {
+        wchar_t className[256];
+        int length = GetClassName(c.hwnd, className, 256);
+        c.className = QString::fromWCharArray(className, length);
+        c.classLoaded = true;
+    }
+    return !m_excludedClasses.contains(c.className);
+}
+
+const char* WindowFilter::stageName(Stage stage)
+{
+    switch (stage) {
+    case VisibleStage:       return "visible";
+    case ToolWindowStage:    return "tool-window";
+    case NoActivateStage:    return "no-activate";
+    case OwnerStage:         return "owned";
+    case OwnProcessStage:    return "own-process";
+    case DeletedStage:       return "deleted";
+    case ExcludedClassStage: return "excluded-class";
+    default:                 return "?";
+    }
+}
+
+WindowFilter::Stats WindowFilter::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+QString WindowFilter::statsString() const
+{
+    Stats s = stats();
+    QString text = QString("evaluated=%1 accepted=%2").arg(s.evaluated).arg(s.accepted);
+    for (int stage = 0; stage < StageCount; ++stage) {
+        text += QString("\n%1: rejected=%2 time=%3us")
+            .arg(stageName(static_cast<Stage>(stage)))
+            .arg(s.rejected[stage])
+            .arg(s.nsecs[stage] / 1000);
+    }
+    return text;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <windows.h>
+
+// 过滤过程中按需获取的窗口属性，通过过滤后可直接复用
+struct WindowCandidate {
+    HWND hwnd = nullptr;
+    DWORD processId = 0;
+    LONG_PTR exStyle = 0;
+    QString className;
+    bool processLoaded = false;
+    bool styleLoaded = false;
+    bool classLoaded = false;
+
+    explicit WindowCandidate(HWND h) : hwnd(h) {}
+};
+
+// 窗口过滤管线
+// 各阶段按开销从低到高排列，任一阶段拒绝即停止；
+// 标题、进程信息和图标只对通过的窗口获取
+class WindowFilter
+{
+public:
+    enum Stage {
+        VisibleStage,
+        ToolWindowStage,
+        NoActivateStage,
+        OwnerStage,
+        OwnProcessStage,
+        DeletedStage,
+        ExcludedClassStage,
+        StageCount
+    };
+
+    static WindowFilter& instance();
+
+    // 排除的窗口类名，来自配置 filter/excluded_classes
+    static QStringList defaultExcludedClasses();
+    void setExcludedClasses(const QStringList& classes);
+
+    bool accept(WindowCandidate& candidate);
+
+    struct Stats {
+        quint64 evaluated = 0;
+        quint64 accepted = 0;
+        quint64 rejected[StageCount] = {};
+        qint64 nsecs[StageCount] = {};   // 各阶段累计耗时
+    };
+    Stats stats() const;
+    QString statsString() const;
+
+    static const char* stageName(Stage stage);
+
+private:
+    WindowFilter();
+
+    typedef bool (WindowFilter::*StageFn)(WindowCandidate&) const;
+
+    // 各阶段，返回 true 表示通过
+    bool isVisible(WindowCandidate& c) const;
+    bool isNotToolWindow(WindowCandidate& c) const;
+    bool isActivatable(WindowCandidate& c) const;
+    bool isUnowned(WindowCandidate& c) const;
+    bool isOtherProcess(WindowCandidate& c) const;
+    bool isNotDeleted(WindowCandidate& c) const;
+    bool isAllowedClass(WindowCandidate& c) const;
+
+    static void loadStyle(WindowCandidate& c);
+
+    StageFn m_stages[StageCount];
+    DWORD m_currentProcessId;
+
+    mutable QMutex m_mutex;
+    QSet<QString> m_excludedClasses;
+    Stats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QString>
+#include "platformtypes.h"
+
+// 顶层窗口的展示信息
+struct WindowInfo {
+    QString title;
+    QString processName;
+    QString className;
+    DWORD processId = 0;
+    HWND hwnd = nullptr;
+    bool isHidden = false;
+    bool isVisible = false;
+    quint64 iconKey = 0;     // 图标缓存键，见 IconCache
+};
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "windowquery.h"
+#include "processinfocache.h"
+#include "diagnostics.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+
+#ifdef _WIN32
+namespace {
+
+class Win32WindowMessenger : public WindowMessenger
+{
+public:
+    SendResult send(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT timeoutMs, DWORD_PTR* result) override
+    {
+        DWORD_PTR value = 0;
+        SetLastError(ERROR_SUCCESS);
+        LRESULT ok = SendMessageTimeout(hwnd, msg, wParam, lParam,
+            SMTO_ABORTIFHUNG | SMTO_BLOCK, timeoutMs, &value);
+        if (result) {
+            *result = value;
+        }
+        if (ok) {
+            return SendResult::Ok;
+        }
+
+        // 超时与 SMTO_ABORTIFHUNG 提前返回都视为无响应
+        DWORD error = GetLastError();
+        if (error == ERROR_TIMEOUT || error == ERROR_SUCCESS) {
+            return SendResult::Timeout;
+        }
+        return SendResult::Failed;
+    }
+
+    DWORD processIdOf(HWND hwnd) override
+    {
+        DWORD processId = 0;
+        GetWindowThreadProcessId(hwnd, &processId);
+        return processId;
+    }
+};
+
+}
+#endif
+
+WindowQuery& WindowQuery::instance()
+{
+    static WindowQuery inst;
+    return inst;
+}
+
+WindowQuery::WindowQuery()
+#ifdef _WIN32
+    : m_messenger(new Win32WindowMessenger())
+#endif
+{
+    m_clock.start();
+
+    Diagnostics::instance().registerSource("Window queries", [this]() {
+        return statsString();
+        });
+}
+
+void WindowQuery::setMessenger(std::unique_ptr<WindowMessenger> messenger)
+{
+    QMutexLocker locker(&m_mutex);
+    m_messenger = std::move(messenger);
+    m_hungUntil.clear();
+}
+
+void WindowQuery::setTimeout(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_timeoutMs = ms;
+}
+
+void WindowQuery::setHangCooldown(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cooldownMs = ms;
+}
+
+bool WindowQuery::sendMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, DWORD_PTR* result)
+{
+    if (result) {
+        *result = 0;
+    }
+    if (!hwnd) {
+        return false;
+    }
+
+    // 持有引用直到调用结束，期间 setMessenger 替换实现不会释放正在使用的对象
+    std::shared_ptr<WindowMessenger> messenger;
+    UINT timeoutMs;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (isHungLocked(hwnd, m_clock.elapsed())) {
+            ++m_stats.skipped;
+            return false;
+        }
+        ++m_stats.sent;
+        messenger = m_messenger;
+        timeoutMs = static_cast<UINT>(m_timeoutMs);
+    }
+
+    if (!messenger) {
+        return false;
+    }
+
+    // 发送期间不持有锁，其他线程的查询不受影响
+    SendResult sent = messenger->send(hwnd, msg, wParam, lParam, timeoutMs, result);
+    if (sent == SendResult::Timeout) {
+        markHung(hwnd, messenger.get());
+    }
+    return sent == SendResult::Ok;
+}
+
+#ifdef _WIN32
+HICON WindowQuery::windowIcon(HWND hwnd, WPARAM type)
+{
+    DWORD_PTR result = 0;
+    if (!sendMessage(hwnd, WM_GETICON, type, 0, &result)) {
+        return nullptr;
+    }
+    return reinterpret_cast<HICON>(result);
+}
+#endif
+
+bool WindowQuery::isRecentlyHung(HWND hwnd)
+{
+    QMutexLocker locker(&m_mutex);
+    return isHungLocked(hwnd, m_clock.elapsed());
+}
+
+bool WindowQuery::isHungLocked(HWND hwnd, qint64 now)
+{
+    auto it = m_hungUntil.find(hwnd);
+    if (it == m_hungUntil.end()) {
+        return false;
+    }
+    if (now < it.value()) {
+        return true;
+    }
+
+    // 冷却结束，重新尝试
+    m_hungUntil.erase(it);
+    return false;
+}
+
+void WindowQuery::markHung(HWND hwnd, WindowMessenger* messenger)
+{
+    // 使用发送消息时的同一个实现，调用方持有其引用
+    DWORD processId = messenger->processIdOf(hwnd);
+
+    // 进程缓存有自己的锁，在本锁之外查询
+    QString processName = ProcessInfoCache::instance().processName(processId);
+    if (processName.isEmpty()) {
+        processName = QString("pid %1").arg(processId);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    qint64 now = m_clock.elapsed();
+
+    // 顺便清理冷却已结束的窗口
+    for (auto it = m_hungUntil.begin(); it != m_hungUntil.end(); ) {
+        if (it.value() <= now) {
+            it = m_hungUntil.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    m_hungUntil.insert(hwnd, now + m_cooldownMs);
+    ++m_hangsByProcess[processName];
+    ++m_stats.timeouts;
+}
+
+WindowQuery::Stats WindowQuery::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats s = m_stats;
+    s.hungWindows = m_hungUntil.size();
+    return s;
+}
+
+QString WindowQuery::statsString() const
+{
+    Stats s = stats();
+    QString text = QString("sent=%1 timeouts=%2 skipped=%3 hung=%4")
+        .arg(s.sent).arg(s.timeouts).arg(s.skipped).arg(s.hungWindows);
+
+    QList<QPair<quint64, QString>> processes;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_hangsByProcess.constBegin(); it != m_hangsByProcess.constEnd(); ++it) {
+            processes.append(qMakePair(it.value(), it.key()));
+        }
+    }
+    if (processes.isEmpty()) {
+        return text;
+    }
+
+    // 无响应次数最多的进程
+    std::sort(processes.begin(), processes.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+        });
+    QStringList top;
+    for (int i = 0; i < processes.size() && i < 5; ++i) {
+        top.append(QString("%1(%2)").arg(processes[i].second).arg(processes[i].first));
+    }
+    return text + "\nhanging: " + top.join(", ");
+}
\ No newline at end of file
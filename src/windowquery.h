@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include "platformtypes.h"
+
+// 跨进程窗口消息的发送结果
+enum class SendResult {
+    Ok,
+    Timeout,   // 超时或目标线程无响应
+    Failed     // 窗口无效等其他错误
+};
+
+// 窗口消息传输接口，便于用模拟实现替换（例如模拟无响应的窗口）
+class WindowMessenger
+{
+public:
+    virtual ~WindowMessenger() = default;
+
+    virtual SendResult send(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT timeoutMs, DWORD_PTR* result) = 0;
+    virtual DWORD processIdOf(HWND hwnd) = 0;
+};
+
+// 有界延迟的窗口查询
+// 所有跨进程消息都带超时发送；超时的窗口在冷却期内跳过昂贵查询，
+// 并按进程统计无响应次数
+class WindowQuery
+{
+public:
+    static WindowQuery& instance();
+
+    // 正在进行的查询持有旧实现的引用，替换后旧实现在其返回后才释放
+    void setMessenger(std::unique_ptr<WindowMessenger> messenger);
+
+    static constexpr int DefaultTimeoutMs = 200;
+    static constexpr int DefaultHangCooldownMs = 30000;
+
+    void setTimeout(int ms);
+    void setHangCooldown(int ms);
+
+    // 发送消息；窗口近期无响应时直接返回 false，不再等待
+    bool sendMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, DWORD_PTR* result);
+
+#ifdef _WIN32
+    // WM_GETICON，失败时返回空
+    HICON windowIcon(HWND hwnd, WPARAM type);
+#endif
+
+    bool isRecentlyHung(HWND hwnd);
+
+    struct Stats {
+        quint64 sent = 0;
+        quint64 timeouts = 0;
+        quint64 skipped = 0;
+        int hungWindows = 0;
+    };
+    Stats stats() const;
+    QString statsString() const;
+
+private:
+    WindowQuery();
+
+    // 调用方需持有锁
+    bool isHungLocked(HWND hwnd, qint64 now);
+    void markHung(HWND hwnd, WindowMessenger* messenger);
+
+    mutable QMutex m_mutex;
+    std::shared_ptr<WindowMessenger> m_messenger;
+    QElapsedTimer m_clock;
+    int m_timeoutMs = DefaultTimeoutMs;
+    int m_cooldownMs = DefaultHangCooldownMs;
+    QHash<HWND, qint64> m_hungUntil;          // 冷却截止时间（m_clock 毫秒）
+    QHash<QString, quint64> m_hangsByProcess; // 进程名 -> 超时次数
+    Stats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "windowregistry.h"
+#include "windowdiff.h"
+#include <QDebug>
+
+WindowRegistry::WindowRegistry(std::unique_ptr<WindowBackend> backend, WindowEventSource* source, QObject* parent)
+    : QObject(parent)
+    , m_backend(std::move(backend))
+    , m_source(source)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(100);
+    connect(m_flushTimer, &QTimer::timeout, this, &WindowRegistry::flushPending);
+
+    if (m_source) {
+        connect(m_source, &WindowEventSource::windowEvent, this, &WindowRegistry::onWindowEvent);
+    }
+}
+
+bool WindowRegistry::start()
+{
+    if (m_running) {
+        return true;
+    }
+
+    // 事件源不可用时仍可依靠定期对账工作
+    if (m_source && !m_source->start()) {
+        qWarning() << "Window event source unavailable, falling back to polling only";
+    }
+
+    m_running = true;
+    reconcile();
+    return true;
+}
+
+void WindowRegistry::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    if (m_source) {
+        m_source->stop();
+    }
+    m_flushTimer->stop();
+    m_pending.clear();
+    m_running = false;
+}
+
+void WindowRegistry::setCoalesceInterval(int ms)
+{
+    m_flushTimer->setInterval(ms);
+}
+
+void WindowRegistry::onWindowEvent(HWND hwnd, WindowEventType type)
+{
+    if (!m_running) {
+        return;
+    }
+
+    // 销毁事件只对已知窗口有意义
+    if (type == WindowEventType::Destroyed && !m_windows.contains(hwnd)) {
+        return;
+    }
+
+    m_pending.insert(hwnd);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void WindowRegistry::flushPending()
+{
+    bool changed = false;
+    const QSet<HWND> pending = std::move(m_pending);
+    m_pending.clear();
+
+    for (HWND hwnd : pending) {
+        changed |= updateWindow(hwnd);
+    }
+
+    if (changed) {
+        ++m_revision;
+        emit windowsChanged();
+    }
+}
+
+bool WindowRegistry::updateWindow(HWND hwnd)
+{
+    WindowInfo info;
+    auto it = m_windows.find(hwnd);
+
+    if (!m_backend->query(hwnd, info)) {
+        // 窗口已销毁或不再符合条件
+        if (it == m_windows.end()) {
+            return false;
+        }
+        m_windows.erase(it);
+        m_order.removeOne(hwnd);
+        return true;
+    }
+
+    if (it == m_windows.end()) {
+        // 新窗口通常位于 Z 序顶端
+        m_windows.insert(hwnd, Entry{ info, m_generation });
+        m_order.prepend(hwnd);
+        return true;
+    }
+
+    if (sameContent(it->info, info)) {
+        return false;
+    }
+
+    it->info = info;
+    return true;
+}
+
+void WindowRegistry::reconcile()
+{
+    m_backend->beginReconcile();
+    const QList<HWND> order = m_backend->enumerate();
+
+    // 原地更新：内容未变的窗口只打上本轮标记，不重建整个表
+    const quint64 generation = ++m_generation;
+    QList<HWND> listed;
+    listed.reserve(order.size());
+
+    bool changed = false;
+    int drift = 0;
+    for (HWND hwnd : order) {
+        if (!m_backend->query(hwnd, m_scratch)) {
+            continue;
+        }
+        listed.append(hwnd);
+
+        auto it = m_windows.find(hwnd);
+        if (it == m_windows.end()) {
+            m_windows.insert(hwnd, Entry{ m_scratch, generation });
+        }
+        else {
+            it->seen = generation;
+            if (sameContent(it->info, m_scratch)) {
+                continue;
+            }
+            it->info = m_scratch;
+        }
+
+        changed = true;
+        if (!m_pending.contains(hwnd)) {
+            ++drift;
+        }
+    }
+
+    // 本轮没有出现的窗口已消失；没有收到事件的算作遗漏
+    for (auto it = m_windows.begin(); it != m_windows.end(); ) {
+        if (it->seen == generation) {
+            ++it;
+            continue;
+        }
+        if (!m_pending.contains(it.key())) {
+            ++drift;
+        }
+        it = m_windows.erase(it);
+        changed = true;
+    }
+
+    if (listed != m_order) {
+        changed = true;
+        m_order = std::move(listed);
+    }
+
+    // 对账结果已包含所有待处理事件
+    m_pending.clear();
+    m_flushTimer->stop();
+
+    if (changed) {
+        ++m_revision;
+        emit windowsChanged();
+    }
+    if (drift > 0) {
+        emit driftDetected(drift);
+    }
+}
+
+const WindowInfo* WindowRegistry::find(HWND hwnd) const
+{
+    auto it = m_windows.constFind(hwnd);
+    return it == m_windows.constEnd() ? nullptr : &it->info;
+}
+
+bool WindowRegistry::sameContent(const WindowInfo& a, const WindowInfo& b)
+{
+    return WindowDiff::changedFields(a, b) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QTimer>
+#include <memory>
+#include "windowinfo.h"
+#include "windowbackend.h"
+#include "windoweventsource.h"
+
+// 实时窗口注册表
+// 由窗口事件增量更新，定期全量对账作为兜底
+class WindowRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    WindowRegistry(std::unique_ptr<WindowBackend> backend, WindowEventSource* source, QObject* parent = nullptr);
+
+    // 启动/停止事件跟踪
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    // 事件合并延迟（毫秒）
+    void setCoalesceInterval(int ms);
+
+    // 全量枚举并与注册表对账
+    void reconcile();
+
+    // 当前窗口（按 Z 序）
+    const QList<HWND>& order() const { return m_order; }
+    const WindowInfo* find(HWND hwnd) const;
+
+    // 每次内容变化递增
+    quint64 revision() const { return m_revision; }
+
+signals:
+    void windowsChanged();
+
+    // 对账发现了事件没有报告的变化（新增、移除或内容变化且不在待处理集合中）
+    void driftDetected(int windows);
+
+private slots:
+    void onWindowEvent(HWND hwnd, WindowEventType type);
+    void flushPending();
+
+private:
+    static bool sameContent(const WindowInfo& a, const WindowInfo& b);
+
+    bool updateWindow(HWND hwnd);
+
+    struct Entry {
+        WindowInfo info;
+        quint64 seen = 0;   // 最近一次在对账中出现的轮次
+    };
+
+    std::unique_ptr<WindowBackend> m_backend;
+    WindowEventSource* m_source;
+    QHash<HWND, Entry> m_windows;
+    WindowInfo m_scratch;        // 对账时查询结果的临时存放，内容未变时不复制
+    quint64 m_generation = 0;
+    QList<HWND> m_order;
+    QSet<HWND> m_pending;
+    QTimer* m_flushTimer;
+    quint64 m_revision = 0;
+    bool m_running = false;
+};
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "windowsnapshot.h"
+#include "windowregistry.h"
+#include "windoweventsource.h"
+#include "windowdiff.h"
+#include "diagnostics.h"
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <atomic>
+
+// 快照缓冲区回收队列，删除器可能在任意线程调用 give()
+class SnapshotBufferPool
+{
+public:
+    static constexpr int MaxFree = 3;
+
+    ~SnapshotBufferPool()
+    {
+        for (WindowSnapshot* buffer : m_free) {
+            delete buffer;
+        }
+    }
+
+    WindowSnapshot* take()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_free.empty()) {
+            return nullptr;
+        }
+        WindowSnapshot* buffer = m_free.back();
+        m_free.pop_back();
+        return buffer;
+    }
+
+    void give(WindowSnapshot* buffer)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (int(m_free.size()) < MaxFree) {
+                m_free.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    }
+
+private:
+    QMutex m_mutex;
+    std::vector<WindowSnapshot*> m_free;
+};
+
+QString WindowSnapshot::title(int i) const
+{
+    int begin = titleOffsets[i];
+    return QString(titleArena.constData() + begin, titleOffsets[i + 1] - begin);
+}
+
+WindowInfo WindowSnapshot::info(int i) const
+{
+    WindowInfo result;
+    result.title = title(i);
+    result.processName = processName(i);
+    result.className = className(i);
+    result.processId = processIds[i];
+    result.hwnd = hwnds[i];
+    result.isVisible = flags[i] & VisibleFlag;
+    result.iconKey = iconKeys[i];
+    return result;
+}
+
+void WindowSnapshot::clear()
+{
+    revision = 0;
+    hwnds.clear();
+    processIds.clear();
+    iconKeys.clear();
+    fingerprints.clear();
+    classIds.clear();
+    processNameIds.clear();
+    flags.clear();
+    titleArena.clear();
+    titleOffsets.clear();
+    titleOffsets.append(0);
+    strings.reset();
+}
+
+void WindowSnapshot::append(const WindowInfo& info, StringPool& pool)
+{
+    hwnds.append(info.hwnd);
+    processIds.append(info.processId);
+    iconKeys.append(info.iconKey);
+    fingerprints.append(WindowDiff::contentFingerprint(info));
+    classIds.append(pool.intern(info.className));
+    processNameIds.append(pool.intern(info.processName));
+    flags.append(info.isVisible ? VisibleFlag : 0);
+    int offset = titleArena.size();
+    titleArena.resize(offset + info.title.size());
+    std::copy(info.title.constBegin(), info.title.constEnd(), titleArena.begin() + offset);
+    titleOffsets.append(titleArena.size());
+}
+
+qint64 WindowSnapshot::capacityBytes() const
+{
+    return qint64(hwnds.capacity()) * sizeof(HWND)
+        + qint64(processIds.capacity()) * sizeof(DWORD)
+        + qint64(iconKeys.capacity()) * sizeof(quint64)
+        + qint64(fingerprints.capacity()) * sizeof(quint64)
+        + qint64(classIds.capacity()) * sizeof(quint32)
+        + qint64(processNameIds.capacity()) * sizeof(quint32)
+        + qint64(flags.capacity()) * sizeof(quint8)
+        + qint64(titleArena.capacity()) * sizeof(QChar)
+        + qint64(titleOffsets.capacity()) * sizeof(int);
+}
+
+std::array<int, WindowSnapshot::ColumnCount> WindowSnapshot::columnCapacities() const
+{
+    return { int(hwnds.capacity()), int(processIds.capacity()), int(iconKeys.capacity()),
+        int(fingerprints.capacity()), int(classIds.capacity()), int(processNameIds.capacity()),
+        int(flags.capacity()), int(titleArena.capacity()), int(titleOffsets.capacity()) };
+}
+
+WindowSnapshotWorker::WindowSnapshotWorker(std::unique_ptr<WindowBackend> backend, WindowEventSource* source)
+    : QObject(nullptr)
+    , m_registry(new WindowRegistry(std::move(backend), source, this))
+    , m_pool(std::make_shared<SnapshotBufferPool>())
+{
+    // 事件源随工作对象一起移到后台线程
+    if (source) {
+        source->setParent(this);
+    }
+    connect(m_registry, &WindowRegistry::windowsChanged, this, &WindowSnapshotWorker::buildSnapshot);
+    connect(m_registry, &WindowRegistry::driftDetected, this, &WindowSnapshotWorker::driftDetected);
+}
+
+WindowSnapshotWorker::~WindowSnapshotWorker() = default;
+
+void WindowSnapshotWorker::start()
+{
+    // 事件钩子绑定到调用线程，必须在后台线程中安装
+    m_registry->start();
+}
+
+void WindowSnapshotWorker::stop()
+{
+    m_registry->stop();
+}
+
+void WindowSnapshotWorker::reconcile()
+{
+    if (m_registry->isRunning()) {
+        m_registry->reconcile();
+    }
+}
+
+void WindowSnapshotWorker::setCoalesceInterval(int ms)
+{
+    m_registry->setCoalesceInterval(ms);
+}
+
+void WindowSnapshotWorker::buildSnapshot()
+{
+    std::shared_ptr<WindowSnapshot> snapshot = acquireBuffer();
+    snapshot->clear();
+    const auto capacities = snapshot->columnCapacities();
+    const qint64 capacityBefore = snapshot->capacityBytes();
+    snapshot->revision = m_registry->revision();
+
+    const QList<HWND>& order = m_registry->order();
+    snapshot->hwnds.reserve(order.size());
+    for (HWND hwnd : order) {
+        if (const WindowInfo* info = m_registry->find(hwnd)) {
+            snapshot->append(*info, m_strings);
+        }
+    }
+    snapshot->strings = m_strings.table();
+
+    const auto grown = snapshot->columnCapacities();
+    int reallocations = 0;
+    for (int i = 0; i < WindowSnapshot::ColumnCount; ++i) {
+        reallocations += grown[i] != capacities[i];
+    }
+
+    {
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.built;
+        m_stats.grown += reallocations;
+        m_stats.capacity = snapshot->capacityBytes();
+        m_stats.grownBytes += m_stats.capacity - capacityBefore;
+        m_stats.strings = m_strings.size();
+    }
+
+    emit snapshotReady(std::move(snapshot));
+}
+
+std::shared_ptr<WindowSnapshot> WindowSnapshotWorker::acquireBuffer()
+{
+    WindowSnapshot* buffer = m_pool->take();
+    {
+        QMutexLocker locker(&m_statsMutex);
+        if (buffer) {
+            ++m_stats.reused;
+        }
+        else {
+            ++m_stats.buffers;
+        }
+    }
+    if (!buffer) {
+        buffer = new WindowSnapshot();
+    }
+
+    std::shared_ptr<SnapshotBufferPool> pool = m_pool;
+    return std::shared_ptr<WindowSnapshot>(buffer, [pool](WindowSnapshot* released) {
+        pool->give(released);
+        });
+}
+
+WindowSnapshotWorker::Stats WindowSnapshotWorker::stats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
+}
+
+WindowSnapshotProducer::WindowSnapshotProducer(std::unique_ptr<WindowBackend> backend, WindowEventSource* source, QObject* parent)
+    : QObject(parent)
+    , m_worker(new WindowSnapshotWorker(std::move(backend), source))
+{
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    // 直接连接：在后台线程中发布，UI 通过 snapshotPublished 得到通知
+    connect(m_worker, &WindowSnapshotWorker::snapshotReady, this,
+        [this](WindowSnapshotPtr snapshot) { publish(std::move(snapshot)); },
+        Qt::DirectConnection);
+    connect(m_worker, &WindowSnapshotWorker::driftDetected, this, &WindowSnapshotProducer::driftDetected);
+
+    m_thread.setObjectName("WindowSnapshotProducer");
+    m_thread.start();
+
+    m_diagnostics = Diagnostics::instance().registerSource("Window snapshots", [this]() {
+        return statsString();
+        });
+}
+
+WindowSnapshotProducer::~WindowSnapshotProducer()
+{
+    Diagnostics::instance().unregisterSource(m_diagnostics);
+
+    // 事件钩子必须在安装它的线程中卸载
+    WindowSnapshotWorker* worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->stop(); }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+
+    // 后台线程已结束，不再有写者；析构时也不再有读者
+    for (const auto& retired : m_retired) {
+        for (PublishedSnapshot* node : retired) {
+            delete node;
+        }
+    }
+    delete m_current.load();
+}
+
+void WindowSnapshotProducer::start()
+{
+    WindowSnapshotWorker* worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->start(); });
+}
+
+void WindowSnapshotProducer::stop()
+{
+    WindowSnapshotWorker* worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->stop(); });
+}
+
+void WindowSnapshotProducer::requestReconcile()
+{
+    WindowSnapshotWorker* worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() { worker->reconcile(); });
+}
+
+void WindowSnapshotProducer::setCoalesceInterval(int ms)
+{
+    WindowSnapshotWorker* worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, ms]() { worker->setCoalesceInterval(ms); });
+}
+
+QString WindowSnapshotProducer::statsString() const
+{
+    WindowSnapshotWorker::Stats s = m_worker->stats();
+    WindowSnapshotPtr snapshot = latest();
+    return QString("built=%1 reused=%2 buffers=%3 grown=%4 grownBytes=%5 windows=%6 capacity=%7 strings=%8")
+        .arg(s.built).arg(s.reused).arg(s.buffers).arg(s.grown).arg(s.grownBytes)
+        .arg(snapshot ? snapshot->size() : 0)
+        .arg(s.capacity).arg(s.strings);
+}
+
+WindowSnapshotPtr WindowSnapshotProducer::latest() const
+{
+    // 登记后确认纪元没有变化，否则写者可能已经在等待这个计数归零，换到新纪元重新登记
+    unsigned epoch;
+    while (true) {
+        epoch = m_epoch.load();
+        m_readers[epoch & 1].fetch_add(1);
+        if (m_epoch.load() == epoch) {
+            break;
+        }
+        m_readers[epoch & 1].fetch_sub(1);
+    }
+
+    // 登记期间读到的节点在复制完成前不会被释放
+    PublishedSnapshot* node = m_current.load();
+    WindowSnapshotPtr snapshot = node ? node->snapshot : WindowSnapshotPtr();
+    m_readers[epoch & 1].fetch_sub(1);
+    return snapshot;
+}
+
+void WindowSnapshotProducer::publish(WindowSnapshotPtr snapshot)
+{
+    quint64 revision = snapshot->revision;
+    PublishedSnapshot* previous = m_current.exchange(new PublishedSnapshot{ std::move(snapshot) });
+    if (previous) {
+        m_retired[m_epoch.load() & 1].push_back(previous);
+    }
+    reclaimRetired();
+
+    // 跨线程发射，UI 端按排队连接接收
+    emit snapshotPublished(revision);
+}
+
+void WindowSnapshotProducer::reclaimRetired()
+{
+    // 上一纪元替换下的节点只可能被上一纪元及更早登记的读者持有：
+    // 更早的读者在进入当前纪元时已经离开，上一纪元的计数归零后这些节点不再被引用。
+    // 当前纪元登记的读者在进入纪元之后才读取指针，只能读到更新的节点。
+    // 计数未归零时留到下一次发布再试
+    const unsigned epoch = m_epoch.load();
+    const unsigned previous = (epoch + 1) & 1;
+    if (m_readers[previous].load() != 0) {
+        return;
+    }
+    for (PublishedSnapshot* node : m_retired[previous]) {
+        delete node;
+    }
+    m_retired[previous].clear();
+    m_epoch.store(epoch + 1);
+}
\ No newline at end of file
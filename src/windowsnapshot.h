@@ -0,0 +1,161 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "windowinfo.h"
+#include "windowbackend.h"
+#include "stringpool.h"
+
+class WindowRegistry;
+class WindowEventSource;
+class SnapshotBufferPool;
+
+// 不可变的窗口快照，发布后只读
+// 列式存储：每列下标一致，按 Z 序；类名和进程名为驻留池编号，标题存放在连续缓冲区
+struct WindowSnapshot {
+    enum Flag : quint8 {
+        VisibleFlag = 0x1
+    };
+
+    quint64 revision = 0;
+
+    QVector<HWND> hwnds;
+    QVector<DWORD> processIds;
+    QVector<quint64> iconKeys;
+    QVector<quint64> fingerprints;   // WindowDiff::contentFingerprint
+    QVector<quint32> classIds;
+    QVector<quint32> processNameIds;
+    QVector<quint8> flags;
+    QVector<QChar> titleArena;
+    QVector<int> titleOffsets;       // size() + 1 项，第 i 个标题为 [offsets[i], offsets[i+1])
+    StringPool::Table strings;
+
+    int size() const { return hwnds.size(); }
+
+    QString title(int i) const;
+    const QString& className(int i) const { return strings->at(classIds[i]); }
+    const QString& processName(int i) const { return strings->at(processNameIds[i]); }
+
+    // 构造单个窗口的完整信息（isHidden 由调用方设置）
+    WindowInfo info(int i) const;
+
+    // 清空内容但保留容量，供下一次构建复用
+    void clear();
+    void append(const WindowInfo& info, StringPool& pool);
+
+    // 各列已分配的字节数
+    qint64 capacityBytes() const;
+
+    // 各列的容量（元素数），构建前后比较即可得知哪些列重新分配了内存
+    static constexpr int ColumnCount = 9;
+    std::array<int, ColumnCount> columnCapacities() const;
+};
+
+using WindowSnapshotPtr = std::shared_ptr<const WindowSnapshot>;
+
+// 后台线程中的快照构建者，持有窗口注册表和事件钩子
+class WindowSnapshotWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 取得事件源的所有权，source 为空时只靠对账
+    WindowSnapshotWorker(std::unique_ptr<WindowBackend> backend, WindowEventSource* source);
+    ~WindowSnapshotWorker();
+
+    void start();
+    void stop();
+    void reconcile();
+    void setCoalesceInterval(int ms);
+
+    // 实际发生的分配，而不只是占用的容量：
+    // 稳定状态下每次构建只有 shared_ptr 控制块一次小分配，buffers 与 grown 不再增长
+    struct Stats {
+        quint64 built = 0;
+        quint64 reused = 0;       // 从回收队列取回缓冲区的次数
+        quint64 buffers = 0;      // 新分配的快照缓冲区
+        quint64 grown = 0;        // 列重新分配的次数
+        qint64 grownBytes = 0;    // 重新分配新增的字节数
+        qint64 capacity = 0;      // 最近一次快照各列的容量（字节）
+        int strings = 0;          // 驻留池中的字符串数
+    };
+    Stats stats() const;
+
+signals:
+    void snapshotReady(WindowSnapshotPtr snapshot);
+    void driftDetected();
+
+private:
+    void buildSnapshot();
+    std::shared_ptr<WindowSnapshot> acquireBuffer();
+
+    WindowRegistry* m_registry;
+    StringPool m_strings;
+
+    // 快照的最后一个引用释放时由删除器把缓冲区交还回收队列，不依赖 use_count 判断；
+    // 队列由删除器共同持有，UI 在工作线程结束后才释放快照也安全
+    std::shared_ptr<SnapshotBufferPool> m_pool;
+
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+};
+
+// 窗口快照生产者
+// 枚举和元数据获取都在后台线程完成，最新快照通过原子指针发布给 UI。
+// std::atomic_load/atomic_store(shared_ptr) 在常见标准库中用全局自旋锁表实现，并不是无锁的，
+// 因此发布的是指向不可变节点的原子裸指针，节点内保存 shared_ptr：
+// 读者登记到当前纪元的读者计数后读取指针并复制 shared_ptr（只是一次原子引用计数递增）；
+// 唯一的写者（后台线程）交换指针后把旧节点记在当前纪元下，
+// 上一纪元的读者全部离开时释放上一纪元替换下的节点并进入下一纪元。
+// 读者持续不断时新读者都计入新纪元，旧纪元的计数仍会归零，回收不会被饿死
+class WindowSnapshotProducer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 后端和事件源都通过接口传入（真实的 Win32 实现，或者测试用的合成后端和脚本化事件源）；
+    // 事件源归生产者所有，在后台线程中启动和停止，可以为空
+    WindowSnapshotProducer(std::unique_ptr<WindowBackend> backend, WindowEventSource* source, QObject* parent = nullptr);
+    ~WindowSnapshotProducer();
+
+    // 以下接口均可在任意线程调用，实际工作在后台线程执行
+    void start();
+    void stop();
+    void requestReconcile();
+    void setCoalesceInterval(int ms);
+
+    // 获取最新发布的快照，不加锁，任意线程可调用
+    WindowSnapshotPtr latest() const;
+
+    QString statsString() const;
+
+signals:
+    void snapshotPublished(quint64 revision);
+
+    // 对账发现了事件钩子遗漏的变化，调度器据此保持短间隔
+    void driftDetected();
+
+private:
+    struct PublishedSnapshot {
+        WindowSnapshotPtr snapshot;
+    };
+
+    // 只在后台线程调用
+    void publish(WindowSnapshotPtr snapshot);
+    void reclaimRetired();
+
+    QThread m_thread;
+    WindowSnapshotWorker* m_worker;
+    std::atomic<PublishedSnapshot*> m_current{ nullptr };
+    std::atomic<unsigned> m_epoch{ 0 };
+    mutable std::atomic<int> m_readers[2] = {};   // 按纪元奇偶分别计数
+    std::vector<PublishedSnapshot*> m_retired[2]; // 各纪元中被替换、等待释放的节点
+    quint64 m_diagnostics = 0;
+};
\ No newline at end of file
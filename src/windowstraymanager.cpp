@@ -1,4 +1,8 @@
 #include "windowstraymanager.h"
+#include "windowquery.h"
+#include "processinfocache.h"
+#include "diagnostics.h"
+#include "nativemessagethread.h"
 #include <stdexcept>
 #include <sstream>
 #include <fstream>
@@ -22,7 +26,11 @@ WindowsTrayManager::WindowsTrayManager()
     , m_initialized(false)
     , m_saveFile(INVALID_HANDLE_VALUE)
     , m_mutex(nullptr)
+    , m_journal(L"traymond_state.dat", L"traymond_journal.dat")
 {
+    Diagnostics::instance().registerSource("Hidden window journal", [this]() {
+        return journalStatsString();
+        });
 }
 
 WindowsTrayManager::~WindowsTrayManager()
@@ -42,29 +50,43 @@ bool WindowsTrayManager::initialize()
         return false;
     }
 
-    // 注册窗口类
-    WNDCLASS wc = {};
-    wc.lpfnWndProc = windowProc;
-    wc.hInstance = GetModuleHandle(NULL);
-    wc.lpszClassName = L"WindowsTrayManagerClass";
+    // 托盘消息窗口建在原生消息线程上，图标事件经队列转给 GUI 线程处理
+    NativeMessageThread& thread = NativeMessageThread::instance();
+    thread.startThread();
+    thread.setHandler(NativeMessageThread::Event::TrayIcon, [this](const NativeMessageThread::Event& event) {
+        if (event.code == WM_LBUTTONDBLCLK) {
+            // 双击恢复窗口
+            showWindowFromTray(event.iconId);
+        }
+        });
 
-    if (!RegisterClass(&wc)) {
-        return false;
-    }
+    bool registered = false;
+    thread.invoke([this, &registered]() {
+        // 注册窗口类
+        WNDCLASS wc = {};
+        wc.lpfnWndProc = windowProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = L"WindowsTrayManagerClass";
 
-    // 创建消息窗口
-    m_mainWindow = CreateWindow(
-        wc.lpszClassName,
-        L"Windows Tray Manager",
-        0,  // 不需要样式
-        0, 0, 0, 0,
-        HWND_MESSAGE,
-        NULL,
-        GetModuleHandle(NULL),
-        this
-    );
+        if (!RegisterClass(&wc)) {
+            return;
+        }
+        registered = true;
+
+        // 创建消息窗口
+        m_mainWindow = CreateWindow(
+            wc.lpszClassName,
+            L"Windows Tray Manager",
+            0,  // 不需要样式
+            0, 0, 0, 0,
+            HWND_MESSAGE,
+            NULL,
+            GetModuleHandle(NULL),
+            this
+        );
+        });
 
-    if (!m_mainWindow) {
+    if (!registered || !m_mainWindow) {
         return false;
     }
 
@@ -85,7 +107,11 @@ void WindowsTrayManager::shutdown()
     restoreAllWindows();
 
     if (m_mainWindow) {
-        DestroyWindow(m_mainWindow);
+        HWND window = m_mainWindow;
+        NativeMessageThread::instance().invoke([window]() {
+            DestroyWindow(window);
+            });
+        m_mainWindow = nullptr;
     }
 
     if (m_mutex) {
@@ -100,18 +126,6 @@ void WindowsTrayManager::shutdown()
     m_initialized = false;
 }
 
-std::vector<std::pair<HWND, std::wstring>> WindowsTrayManager::getHiddenWindows() const
-{
-    std::vector<std::pair<HWND, std::wstring>> result;
-    for (const auto& hiddenWindow : m_hiddenWindows) {
-        if (hiddenWindow.hwnd && IsWindow(hiddenWindow.hwnd)) {
-            std::wstring title = getWindowTitle(hiddenWindow.hwnd);
-            result.emplace_back(hiddenWindow.hwnd, title);
-        }
-    }
-    return result;
-}
-
 std::wstring WindowsTrayManager::getWindowTitle(HWND hwnd) const
 {
     wchar_t title[256];
@@ -123,13 +137,29 @@ std::wstring WindowsTrayManager::getWindowTitle(HWND hwnd) const
 
 bool WindowsTrayManager::minimizeWindowToTray(HWND hwnd)
 {
-    if (!hwnd || m_hiddenWindows.size() >= MAX_WINDOWS) {
-        return false;
+    beginBatch();
+    bool success = hideOne(hwnd);
+    commitBatch();
+    return success;
+}
+
+int WindowsTrayManager::minimizeWindowsToTray(const std::vector<HWND>& windows)
+{
+    int count = 0;
+    beginBatch();
+    for (HWND hwnd : windows) {
+        if (hideOne(hwnd)) {
+            ++count;
+        }
     }
+    commitBatch();
+    return count;
+}
 
-    // 检查是否是受保护的窗口
+bool WindowsTrayManager::canHide(HWND hwnd)
+{
     wchar_t className[256];
-    if (!GetClassName(hwnd, className, 256)) {
+    if (!hwnd || !GetClassName(hwnd, className, 256)) {
         return false;
     }
 
@@ -146,9 +176,40 @@ bool WindowsTrayManager::minimizeWindowToTray(HWND hwnd)
             return false;
         }
     }
+    return true;
+}
+
+bool WindowsTrayManager::hideImmediately(HWND hwnd)
+{
+    // 不隐藏本进程的窗口
+    DWORD processId = 0;
+    if (!hwnd || !GetWindowThreadProcessId(hwnd, &processId) || processId == GetCurrentProcessId()) {
+        return false;
+    }
+    if (!canHide(hwnd)) {
+        return false;
+    }
+
+    // 异步调用，目标窗口无响应时也不会阻塞消息线程
+    return ShowWindowAsync(hwnd, SW_HIDE) != FALSE;
+}
+
+bool WindowsTrayManager::hideOne(HWND hwnd)
+{
+    if (!hwnd || m_hiddenWindows.size() >= m_maxWindows || m_store.contains(hwnd)) {
+        return false;
+    }
+
+    // 检查是否是受保护的窗口
+    if (!canHide(hwnd)) {
+        return false;
+    }
+
+    // 展示信息只在隐藏时采集一次
+    WindowInfo info = HiddenWindowStore::capture(hwnd);
 
     // 获取窗口图标
-    HICON icon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
+    HICON icon = WindowQuery::instance().windowIcon(hwnd, ICON_SMALL);
     if (!icon) {
         icon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
     }
@@ -156,21 +217,26 @@ bool WindowsTrayManager::minimizeWindowToTray(HWND hwnd)
         icon = LoadIcon(NULL, IDI_APPLICATION);
     }
 
+    // 登记并分配托盘图标 ID
+    HiddenWindowRegistry::Entry* entry = m_hiddenWindows.insert(hwnd);
+    if (!entry) {
+        return false;
+    }
+
     // 创建托盘图标
     NOTIFYICONDATA nid = {};
     nid.cbSize = sizeof(NOTIFYICONDATA);
     nid.hWnd = m_mainWindow;
-    nid.uID = 1000 + (UINT)m_hiddenWindows.size() + 1;
+    nid.uID = entry->iconData.uID;
     nid.uFlags = NIF_ICON | NIF_MESSAGE | NIF_TIP | NIF_SHOWTIP;
     nid.uCallbackMessage = WM_TRAYICON;
     nid.hIcon = icon;
 
-    wchar_t windowTitle[128];
-    GetWindowText(hwnd, windowTitle, 128);
-    wcscpy_s(nid.szTip, windowTitle);
+    wcsncpy_s(nid.szTip, info.title.toStdWString().c_str(), _TRUNCATE);
 
     bool success = Shell_NotifyIcon(NIM_ADD, &nid);
     if (!success) {
+        m_hiddenWindows.remove(hwnd);
         return false;
     }
 
@@ -179,53 +245,200 @@ bool WindowsTrayManager::minimizeWindowToTray(HWND hwnd)
     Shell_NotifyIcon(NIM_SETVERSION, &nid);
 
     // 保存隐藏窗口信息
-    HiddenWindow hiddenWindow;
-    hiddenWindow.iconData = nid;
-    hiddenWindow.hwnd = hwnd;
-    m_hiddenWindows.push_back(hiddenWindow);
+    entry->iconData = nid;
 
     // 隐藏窗口
     ShowWindow(hwnd, SW_HIDE);
 
-    // 保存状态
-    saveHiddenWindows();
+    m_store.insert(hwnd, HiddenWindowRecord::SystemTray, info);
+    m_pendingChange.hidden.push_back(hwnd);
+    m_pendingRecords.push_back(makeRecord(hwnd, HiddenWindowRecord::Hide, HiddenWindowRecord::SystemTray));
+    return true;
+}
 
-    emit trayWindowsChanged();
+int WindowsTrayManager::restoreAllWindows()
+{
+    std::vector<HWND> windows;
+    windows.reserve(m_hiddenWindows.size());
+    m_hiddenWindows.forEach([&windows](const HiddenWindowRegistry::Entry& hiddenWindow) {
+        windows.push_back(hiddenWindow.hwnd);
+        });
 
-    return true;
+    beginBatch();
+    for (HWND hwnd : windows) {
+        restoreOne(hwnd);
+    }
+    commitBatch();
+    return static_cast<int>(windows.size());
 }
 
-void WindowsTrayManager::restoreAllWindows()
+void WindowsTrayManager::beginBatch()
 {
-    for (auto& hiddenWindow : m_hiddenWindows) {
-        ShowWindow(hiddenWindow.hwnd, SW_SHOW);
-        SetForegroundWindow(hiddenWindow.hwnd);
-        Shell_NotifyIcon(NIM_DELETE, &hiddenWindow.iconData);
+    ++m_batchDepth;
+}
+
+void WindowsTrayManager::commitBatch()
+{
+    if (m_batchDepth == 0 || --m_batchDepth > 0) {
+        return;
     }
-    m_hiddenWindows.clear();
 
-    // 清理保存文件
-    DeleteFile(L"traymond_save.dat");
+    // 整个批次只追加一次日志
+    if (!m_pendingRecords.empty()) {
+        std::vector<HiddenWindowRecord> records;
+        std::swap(records, m_pendingRecords);
+        m_journal.append(records);
+    }
+
+    // 只激活一个窗口：指定的目标（可能是应用托盘窗口，批次里未必有系统托盘变化），
+    // 否则最后一个恢复且仍然可见的窗口
+    HWND focusTarget = m_focusTarget;
+    m_focusTarget = nullptr;
+    const bool focused = focusTarget && IsWindow(focusTarget) && !m_hiddenWindows.contains(focusTarget);
+    if (focused) {
+        SetForegroundWindow(focusTarget);
+    }
+
+    if (m_pendingChange.isEmpty()) {
+        return;
+    }
 
-    emit trayWindowsChanged();
+    TrayChange change;
+    std::swap(change, m_pendingChange);
+
+    if (!focused) {
+        for (auto it = change.restored.rbegin(); it != change.restored.rend(); ++it) {
+            if (IsWindow(*it) && !m_hiddenWindows.contains(*it)) {
+                SetForegroundWindow(*it);
+                break;
+            }
+        }
+    }
+
+    emit trayWindowsChanged(change);
 }
 
-void WindowsTrayManager::saveHiddenWindows()
+void WindowsTrayManager::recordAppTrayChange(HWND hwnd, bool hidden)
 {
-    std::wofstream file("traymond_save.dat");
-    if (file.is_open()) {
-        for (const auto& hiddenWindow : m_hiddenWindows) {
-            file << reinterpret_cast<uintptr_t>(hiddenWindow.hwnd) << std::endl;
+    // 已登记的窗口（例如启动时从日志恢复）不重复记录
+    if (hidden) {
+        if (m_store.contains(hwnd)) {
+            return;
         }
-        file.close();
+        m_store.insert(hwnd, HiddenWindowRecord::AppTray, HiddenWindowStore::capture(hwnd));
+    }
+    else if (!m_store.contains(hwnd, HiddenWindowRecord::AppTray) || !m_store.remove(hwnd)) {
+        return;
+    }
+
+    beginBatch();
+    m_pendingRecords.push_back(makeRecord(hwnd,
+        hidden ? HiddenWindowRecord::Hide : HiddenWindowRecord::Restore, HiddenWindowRecord::AppTray));
+    commitBatch();
+}
+
+HiddenWindowRecord WindowsTrayManager::makeRecord(HWND hwnd, HiddenWindowRecord::Kind kind, HiddenWindowRecord::Store store) const
+{
+    HiddenWindowRecord record;
+    record.kind = kind;
+    record.store = store;
+    record.hwnd = reinterpret_cast<uintptr_t>(hwnd);
+    if (kind == HiddenWindowRecord::Restore) {
+        return record;
+    }
+
+    // 隐藏记录带上进程身份，重启后用来确认句柄没有被复用
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    ProcessInfo info = ProcessInfoCache::instance().lookup(processId);
+    record.processId = processId;
+    record.processStartTime = info.startTime;
+    record.exePath = ProcessInfoCache::instance().processPath(processId).toStdWString();
+    record.title = getWindowTitle(hwnd);
+    return record;
+}
+
+bool WindowsTrayManager::isSameWindow(const HiddenWindowRecord& record) const
+{
+    HWND hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(record.hwnd));
+    if (!IsWindow(hwnd)) {
+        return false;
+    }
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    if (processId != record.processId) {
+        return false;
+    }
+
+    // 优先比较进程启动时间，未知时退回比较可执行文件路径
+    ProcessInfo info = ProcessInfoCache::instance().lookup(processId);
+    if (record.processStartTime != 0 && info.startTime != 0) {
+        return info.startTime == record.processStartTime;
     }
+    QString path = ProcessInfoCache::instance().processPath(processId);
+    return record.exePath.empty() || path.isEmpty()
+        || path.compare(QString::fromStdWString(record.exePath), Qt::CaseInsensitive) == 0;
+}
+
+QString WindowsTrayManager::journalStatsString() const
+{
+    HiddenWindowJournal::Stats s = m_journal.stats();
+    return QString("hidden=%1 journal=%2 appended=%3 compactions=%4 replayed=%5 in %6us discarded=%7")
+        .arg(s.hidden).arg(s.journalRecords).arg(s.appended).arg(s.compactions)
+        .arg(s.replayed).arg(s.replayMicros).arg(s.discarded);
 }
 
 void WindowsTrayManager::restoreHiddenWindows()
 {
+    std::vector<HiddenWindowRecord> records = m_journal.replay();
+
+    // 只恢复仍属于同一进程实例的窗口；记录按隐藏先后排列
+    std::vector<HiddenWindowRecord> verified;
+    verified.reserve(records.size());
+    for (const HiddenWindowRecord& record : records) {
+        if (isSameWindow(record)) {
+            verified.push_back(record);
+        }
+    }
+
+    // 兼容旧版本的纯文本保存文件
+    if (records.empty()) {
+        for (HWND hwnd : readLegacySaveFile()) {
+            verified.push_back(makeRecord(hwnd, HiddenWindowRecord::Hide, HiddenWindowRecord::SystemTray));
+        }
+    }
+
+    // 按原顺序重新隐藏，同时重建最近隐藏顺序
+    std::vector<HiddenWindowRecord> live;
+    live.reserve(verified.size());
+    m_savedAppTrayWindows.clear();
+    beginBatch();
+    for (const HiddenWindowRecord& record : verified) {
+        HWND hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(record.hwnd));
+        if (record.store == HiddenWindowRecord::AppTray) {
+            m_savedAppTrayWindows.push_back(hwnd);
+            m_store.insert(hwnd, HiddenWindowRecord::AppTray, HiddenWindowStore::capture(hwnd));
+            live.push_back(record);
+        }
+        else if (hideOne(hwnd)) {
+            live.push_back(record);
+        }
+    }
+    // 状态由下面的快照整体重写，不必逐条追加
+    m_pendingRecords.clear();
+    commitBatch();
+
+    // 丢弃已失效的记录
+    m_journal.rewrite(live);
+}
+
+std::vector<HWND> WindowsTrayManager::readLegacySaveFile()
+{
+    std::vector<HWND> windows;
     std::wifstream file("traymond_save.dat");
     if (!file.is_open()) {
-        return;
+        return windows;
     }
 
     std::wstring line;
@@ -237,7 +450,7 @@ void WindowsTrayManager::restoreHiddenWindows()
 
                 // 验证窗口是否仍然存在
                 if (IsWindow(hwnd)) {
-                    minimizeWindowToTray(hwnd);
+                    windows.push_back(hwnd);
                 }
             }
             catch (const std::exception&) {
@@ -247,6 +460,8 @@ void WindowsTrayManager::restoreHiddenWindows()
     }
 
     file.close();
+    DeleteFile(L"traymond_save.dat");
+    return windows;
 }
 
 LRESULT CALLBACK WindowsTrayManager::windowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
@@ -266,11 +481,17 @@ LRESULT CALLBACK WindowsTrayManager::windowProc(HWND hwnd, UINT uMsg, WPARAM wPa
         return DefWindowProc(hwnd, uMsg, wParam, lParam);
     }
 
+    // 运行在原生消息线程：登记表只属于 GUI 线程，这里只转发事件
     switch (uMsg) {
         case WM_TRAYICON:
-            if (lParam == WM_LBUTTONDBLCLK) {
-                // 双击恢复窗口
-                manager->showWindowFromTray(static_cast<UINT>(wParam));
+            // NOTIFYICON_VERSION_4：LOWORD(lParam) 为事件，HIWORD(lParam) 为图标 ID
+            if (LOWORD(lParam) == WM_LBUTTONDBLCLK) {
+                NativeMessageThread::Event event;
+                event.type = NativeMessageThread::Event::TrayIcon;
+                event.code = LOWORD(lParam);
+                event.iconId = HIWORD(lParam);
+                event.timestampNs = NativeMessageThread::nowNs();
+                NativeMessageThread::instance().post(event);
             }
             break;
 
@@ -278,7 +499,7 @@ LRESULT CALLBACK WindowsTrayManager::windowProc(HWND hwnd, UINT uMsg, WPARAM wPa
             break;
 
         case WM_DESTROY:
-            PostQuitMessage(0);
+            // 线程的生命周期由 NativeMessageThread 管理，这里不再退出消息循环
             break;
 
         default:
@@ -290,46 +511,60 @@ LRESULT CALLBACK WindowsTrayManager::windowProc(HWND hwnd, UINT uMsg, WPARAM wPa
 
 bool WindowsTrayManager::restoreWindow(HWND hwnd)
 {
-    if (!hwnd || !IsWindow(hwnd)) {
-        return false;
+    beginBatch();
+    bool success = restoreOne(hwnd);
+    commitBatch();
+    return success;
+}
+
+int WindowsTrayManager::restoreWindows(const std::vector<HWND>& windows)
+{
+    int count = 0;
+    beginBatch();
+    for (HWND hwnd : windows) {
+        if (restoreOne(hwnd)) {
+            ++count;
+        }
     }
+    commitBatch();
+    return count;
+}
 
+bool WindowsTrayManager::restoreOne(HWND hwnd)
+{
     // 查找对应的托盘图标
-    auto it = std::find_if(m_hiddenWindows.begin(), m_hiddenWindows.end(),
-        [hwnd](const HiddenWindow& hiddenWindow) {
-            return hiddenWindow.hwnd == hwnd;
-        });
-
-    if (it == m_hiddenWindows.end()) {
+    HiddenWindowRegistry::Entry* entry = hwnd ? m_hiddenWindows.findByHwnd(hwnd) : nullptr;
+    if (!entry) {
         return false;
     }
 
-    // 恢复窗口显示
-    ShowWindow(hwnd, SW_SHOW);
-    SetForegroundWindow(hwnd);
+    // 恢复窗口显示，激活留到提交时；已销毁的窗口只清理托盘图标
+    bool alive = IsWindow(hwnd) != FALSE;
+    if (alive) {
+        ShowWindow(hwnd, SW_SHOW);
+    }
 
     // 移除托盘图标
-    Shell_NotifyIcon(NIM_DELETE, &it->iconData);
+    Shell_NotifyIcon(NIM_DELETE, &entry->iconData);
 
     // 从列表中移除
-    m_hiddenWindows.erase(it);
-
-    // 更新保存文件
-    saveHiddenWindows();
+    m_hiddenWindows.remove(hwnd);
+    m_store.remove(hwnd);
 
-    emit trayWindowsChanged();
-
-    return true;
+    m_pendingChange.restored.push_back(hwnd);
+    m_pendingRecords.push_back(makeRecord(hwnd, HiddenWindowRecord::Restore, HiddenWindowRecord::SystemTray));
+    return alive;
 }
 
 void WindowsTrayManager::showWindowFromTray(UINT iconId)
 {
-    auto it = std::find_if(m_hiddenWindows.begin(), m_hiddenWindows.end(),
-        [iconId](const HiddenWindow& hw) {
-            return hw.iconData.uID == iconId;
-        });
-
-    if (it != m_hiddenWindows.end()) {
-        restoreWindow(it->hwnd);
+    HiddenWindowRegistry::Entry* entry = m_hiddenWindows.findById(iconId);
+    if (entry) {
+        restoreWindow(entry->hwnd);
     }
+}
+
+void WindowsTrayManager::setMaxWindows(int maxWindows)
+{
+    m_maxWindows = std::max(1, std::min(maxWindows, HiddenWindowRegistry::MaxSlots));
 }
\ No newline at end of file
@@ -4,6 +4,18 @@
 #include <Windows.h>
 #include <string>
 #include <vector>
+#include "hiddenwindowregistry.h"
+#include "hiddenwindowjournal.h"
+#include "hiddenwindowstore.h"
+
+// 一次提交中隐藏/恢复的窗口
+struct TrayChange
+{
+    std::vector<HWND> hidden;
+    std::vector<HWND> restored;
+
+    bool isEmpty() const { return hidden.empty() && restored.empty(); }
+};
 
 class WindowsTrayManager : public QObject
 {
@@ -14,39 +26,96 @@ public:
     bool initialize();
     void shutdown();
     bool minimizeWindowToTray(HWND hwnd);
-    void restoreAllWindows();
+    int restoreAllWindows();
     bool isInitialized() const { return m_initialized; }
     bool restoreWindow(HWND hwnd);
+    // 两种方式隐藏的窗口都算
+    bool isHidden(HWND hwnd) const { return m_store.contains(hwnd); }
+    int hiddenCount() const { return m_store.size(); }
+
+    // 隐藏窗口及隐藏时采集的信息，只读
+    const HiddenWindowStore& hiddenWindows() const { return m_store; }
+    const HiddenWindow* hiddenWindow(HWND hwnd) const { return m_store.find(hwnd); }
+
+    // 受保护的系统窗口不允许隐藏；只做系统调用，可在任意线程调用
+    static bool canHide(HWND hwnd);
+    // 在原生消息线程上先把窗口藏起来，托盘图标和登记随后由 GUI 线程的
+    // minimizeWindowToTray 完成，热键到窗口消失的延迟不受 GUI 负载影响
+    static bool hideImmediately(HWND hwnd);
 
-    std::vector<std::pair<HWND, std::wstring>> getHiddenWindows() const;
+    // 批量操作：返回成功处理的窗口数
+    int minimizeWindowsToTray(const std::vector<HWND>& windows);
+    int restoreWindows(const std::vector<HWND>& windows);
+
+    // 批量事务：begin/commit 之间的操作只做系统调用，
+    // 提交时统一保存一次、只激活最后恢复的窗口、只发出一次变化通知。可嵌套
+    void beginBatch();
+    void commitBatch();
+
+    // 提交时激活指定窗口，而不是最后恢复的窗口
+    void setFocusTarget(HWND hwnd) { m_focusTarget = hwnd; }
+
+    class Batch
+    {
+    public:
+        Batch() { WindowsTrayManager::instance().beginBatch(); }
+        ~Batch() { WindowsTrayManager::instance().commitBatch(); }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+
+    // 最多可隐藏的窗口数，受托盘图标 ID 空间限制
+    void setMaxWindows(int maxWindows);
+    int maxWindows() const { return m_maxWindows; }
+
+    // 应用托盘菜单隐藏的窗口也写入状态日志，随批量事务一起提交
+    void recordAppTrayChange(HWND hwnd, bool hidden);
+    // 启动时从日志恢复、且确认仍是同一窗口的应用托盘隐藏窗口
+    const std::vector<HWND>& savedAppTrayWindows() const { return m_savedAppTrayWindows; }
+
+    // 最近隐藏的窗口（两种隐藏方式），最近的在前；随状态日志持久化
+    std::vector<HWND> recentlyHidden(int count = -1) const { return m_store.recent(count); }
+    HWND lastHidden() const { return m_store.front(); }
+
+    QString journalStatsString() const;
 
 signals:
-    void trayWindowsChanged();
+    void trayWindowsChanged(const TrayChange& change);
 
 private:
     WindowsTrayManager();
     ~WindowsTrayManager();
 
-    void saveHiddenWindows();
+    bool hideOne(HWND hwnd);
+    bool restoreOne(HWND hwnd);
     void restoreHiddenWindows();
+    std::vector<HWND> readLegacySaveFile();
+    HiddenWindowRecord makeRecord(HWND hwnd, HiddenWindowRecord::Kind kind, HiddenWindowRecord::Store store) const;
+    bool isSameWindow(const HiddenWindowRecord& record) const;
     void showWindowFromTray(UINT iconId);
     std::wstring getWindowTitle(HWND hwnd) const;
 
     static LRESULT CALLBACK windowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
-    struct HiddenWindow {
-        NOTIFYICONDATA iconData;
-        HWND hwnd;
-    };
-
     HWND m_mainWindow = nullptr;
-    std::vector<HiddenWindow> m_hiddenWindows;
+    HiddenWindowRegistry m_hiddenWindows;
+    int m_maxWindows = DefaultMaxWindows;
     bool m_initialized = false;
     HANDLE m_saveFile = INVALID_HANDLE_VALUE;
     HANDLE m_mutex = nullptr;
 
+    // 当前批量事务的状态
+    int m_batchDepth = 0;
+    TrayChange m_pendingChange;
+    std::vector<HiddenWindowRecord> m_pendingRecords;
+    HWND m_focusTarget = nullptr;
+
+    HiddenWindowJournal m_journal;
+    std::vector<HWND> m_savedAppTrayWindows;
+    HiddenWindowStore m_store;
+
     static WindowsTrayManager* s_instance;
 
     static constexpr UINT WM_TRAYICON = WM_USER + 101;
-    static constexpr int MAX_WINDOWS = 50;
+    static constexpr int DefaultMaxWindows = 50;
 };
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "windowtablemodel.h"
+#include "iconcache.h"
+#include <QColor>
+#include <algorithm>
+
+WindowTableModel::WindowTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int WindowTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int WindowTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant WindowTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const Row& row = m_rows[index.row()];
+    const WindowInfo& info = row.info;
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case TitleColumn:     return info.title;
+        case HandleColumn:    return row.handleText;
+        case ClassColumn:     return info.className;
+        case ProcessIdColumn: return QString::number(info.processId);
+        case ProcessColumn:   return info.processName;
+        default:              return QVariant();
+        }
+
+    case Qt::DecorationRole:
+        if (index.column() == IconColumn && !row.icon.isNull()) {
+            return row.icon;
+        }
+        return QVariant();
+
+    case Qt::ForegroundRole:
+        // 隐藏窗口显示为灰色
+        if (info.isHidden) {
+            return QColor(Qt::gray);
+        }
+        return QVariant();
+
+    case HwndRole:
+        return reinterpret_cast<qulonglong>(info.hwnd);
+
+    case SortRole:
+        switch (index.column()) {
+        case HandleColumn:    return reinterpret_cast<qulonglong>(info.hwnd);
+        case ProcessIdColumn: return static_cast<qulonglong>(info.processId);
+        default:              return data(index, Qt::DisplayRole);
+        }
+
+    default:
+        return QVariant();
+    }
+}
+
+QVariant WindowTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return m_headerLabels.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void WindowTableModel::setHeaderLabels(const QStringList& labels)
+{
+    if (m_headerLabels == labels) {
+        return;
+    }
+    m_headerLabels = labels;
+    emit headerDataChanged(Qt::Horizontal, 0, ColumnCount - 1);
+}
+
+void WindowTableModel::setWindows(const QList<QPair<HWND, WindowInfo>>& windows)
+{
+    applyDelta(m_diff.update(windows));
+}
+
+void WindowTableModel::setSnapshot(const WindowSnapshot& snapshot, const QSet<HWND>& hidden)
+{
+    applyDelta(m_diff.update(snapshot, hidden));
+}
+
+void WindowTableModel::applyDelta(const WindowDelta& delta)
+{
+    // 1. 移除已消失的行（从后往前，连续的行合并为一次通知）
+    if (!delta.removed.isEmpty()) {
+        QVector<int> rows;
+        rows.reserve(delta.removed.size());
+        for (HWND hwnd : delta.removed) {
+            rows.append(m_index.value(hwnd));
+        }
+        std::sort(rows.begin(), rows.end());
+
+        for (int i = rows.size() - 1; i >= 0; --i) {
+            int last = rows[i];
+            while (i > 0 && rows[i - 1] == rows[i] - 1) {
+                --i;
+            }
+            int first = rows[i];
+            beginRemoveRows(QModelIndex(), first, last);
+            m_rows.remove(first, last - first + 1);
+            endRemoveRows();
+        }
+        rebuildIndex();
+    }
+
+    // 2. 更新有变化的行，只通知受影响的列
+    for (const auto& change : delta.changed) {
+        int row = m_index.value(change.first, -1);
+        if (row < 0) {
+            continue;
+        }
+        m_rows[row] = makeRow(*m_diff.find(change.first));
+
+        int first = ColumnCount;
+        int last = -1;
+        columnSpan(change.second, first, last);
+        if (first <= last) {
+            emit dataChanged(index(row, first), index(row, last));
+        }
+    }
+
+    // 3. 追加新行；行顺序由代理模型的排序决定，Z 序变化无需通知
+    if (!delta.added.isEmpty()) {
+        int first = m_rows.size();
+        beginInsertRows(QModelIndex(), first, first + delta.added.size() - 1);
+        for (HWND hwnd : delta.added) {
+            m_rows.append(makeRow(*m_diff.find(hwnd)));
+        }
+        endInsertRows();
+        rebuildIndex();
+    }
+}
+
+HWND WindowTableModel::hwndAt(int row) const
+{
+    return (row >= 0 && row < m_rows.size()) ? m_rows[row].info.hwnd : nullptr;
+}
+
+int WindowTableModel::rowOf(HWND hwnd) const
+{
+    return m_index.value(hwnd, -1);
+}
+
+void WindowTableModel::columnSpan(quint32 fields, int& first, int& last)
+{
+    auto include = [&](int column) {
+        first = qMin(first, column);
+        last = qMax(last, column);
+    };
+
+    // 隐藏状态影响整行的前景色
+    if (fields & HiddenField) {
+        include(IconColumn);
+        include(ProcessColumn);
+    }
+    if (fields & IconField) include(IconColumn);
+    if (fields & TitleField) include(TitleColumn);
+    if (fields & ClassNameField) include(ClassColumn);
+    if (fields & ProcessIdField) include(ProcessIdColumn);
+    if (fields & ProcessNameField) include(ProcessColumn);
+}
+
+WindowTableModel::Row WindowTableModel::makeRow(const WindowInfo& info)
+{
+    Row row;
+    row.info = info;
+    row.icon = IconCache::instance().icon(info.iconKey);
+    row.handleText = QString::number(reinterpret_cast<qulonglong>(info.hwnd), 16).toUpper();
+    return row;
+}
+
+void WindowTableModel::rebuildIndex()
+{
+    m_index.clear();
+    m_index.reserve(m_rows.size());
+    for (int row = 0; row < m_rows.size(); ++row) {
+        m_index.insert(m_rows[row].info.hwnd, row);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QIcon>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include "windowinfo.h"
+#include "windowdiff.h"
+#include "windowsnapshot.h"
+
+// 窗口列表模型
+// 由 WindowDiff 的增量驱动：只对新增、移除、变化的行发出通知，
+// 视图的选中状态和滚动位置因此保持不变
+class WindowTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IconColumn,
+        TitleColumn,
+        HandleColumn,
+        ClassColumn,
+        ProcessIdColumn,
+        ProcessColumn,
+        ColumnCount
+    };
+
+    // 窗口句柄（所有列）
+    static constexpr int HwndRole = Qt::UserRole;
+    // 排序使用的原始值（进程ID、句柄按数值排序）
+    static constexpr int SortRole = Qt::UserRole + 1;
+
+    explicit WindowTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setHeaderLabels(const QStringList& labels);
+
+    // 与当前内容比较，只更新有变化的行
+    void setWindows(const QList<QPair<HWND, WindowInfo>>& windows);
+    void setSnapshot(const WindowSnapshot& snapshot, const QSet<HWND>& hidden);
+
+    HWND hwndAt(int row) const;
+    int rowOf(HWND hwnd) const;
+
+private:
+    struct Row {
+        WindowInfo info;
+        QIcon icon;
+        QString handleText;
+    };
+
+    void applyDelta(const WindowDelta& delta);
+    static void columnSpan(quint32 fields, int& first, int& last);
+    static Row makeRow(const WindowInfo& info);
+    void rebuildIndex();
+
+    QVector<Row> m_rows;
+    QHash<HWND, int> m_index;
+    QStringList m_headerLabels;
+    WindowDiff m_diff;
+};
\ No newline at end of file
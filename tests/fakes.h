@@ -0,0 +1,252 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "processinfocache.h"
+#include "traymenuplatform.h"
+#include "windowbackend.h"
+#include "windoweventsource.h"
+#include "windowquery.h"
+
+// 测试用的句柄值，不对应任何真实窗口
+inline HWND fakeWindow(quintptr id)
+{
+    return reinterpret_cast<HWND>(id);
+}
+
+// 脚本化的窗口事件源：测试直接调用 feed 发出事件
+class ScriptedEventSource : public WindowEventSource
+{
+public:
+    explicit ScriptedEventSource(QObject* parent = nullptr) : WindowEventSource(parent) {}
+
+    bool start() override { m_running = true; return true; }
+    void stop() override { m_running = false; }
+    bool isRunning() const override { return m_running; }
+
+    void feed(HWND hwnd, WindowEventType type) { emit windowEvent(hwnd, type); }
+
+private:
+    bool m_running = false;
+};
+
+// 合成的窗口后端：窗口列表完全由测试构造，记录查询次数
+class SyntheticBackend : public WindowBackend
+{
+public:
+    // 新窗口位于 Z 序顶端
+    void add(quintptr id, const QString& title, DWORD processId = 1)
+    {
+        WindowInfo info;
+        info.hwnd = fakeWindow(id);
+        info.title = title;
+        info.processName = QString("process%1.exe").arg(processId);
+        info.className = "SyntheticWindow";
+        info.processId = processId;
+        info.isVisible = true;
+        m_windows.insert(info.hwnd, info);
+        m_order.prepend(info.hwnd);
+    }
+
+    void setTitle(quintptr id, const QString& title) { m_windows[fakeWindow(id)].title = title; }
+
+    void remove(quintptr id)
+    {
+        m_windows.remove(fakeWindow(id));
+        m_order.removeOne(fakeWindow(id));
+    }
+
+    void beginReconcile() override { ++reconciles; }
+
+    QList<HWND> enumerate() override { return m_order; }
+
+    bool query(HWND hwnd, WindowInfo& info) override
+    {
+        ++queries[hwnd];
+        auto it = m_windows.constFind(hwnd);
+        if (it == m_windows.constEnd()) {
+            return false;
+        }
+        info = *it;
+        return true;
+    }
+
+    int reconciles = 0;
+    QHash<HWND, int> queries;
+
+private:
+    QHash<HWND, WindowInfo> m_windows;
+    QList<HWND> m_order;
+};
+
+// 每轮对账都改写所有标题的合成后端，保证每次对账都发布新快照。
+// 只在生产者的后台线程中访问
+class ChurningBackend : public SyntheticBackend
+{
+public:
+    explicit ChurningBackend(int windows, int processes = 7) : m_count(windows)
+    {
+        for (int i = 1; i <= windows; ++i) {
+            add(quintptr(i), QString("window %1").arg(i), DWORD(i % processes));
+        }
+    }
+
+    void beginReconcile() override
+    {
+        SyntheticBackend::beginReconcile();
+        for (int i = 1; i <= m_count; ++i) {
+            setTitle(quintptr(i), QString("window %1 pass %2").arg(i).arg(reconciles));
+        }
+    }
+
+private:
+    int m_count;
+};
+
+// 从 statsString() 这类 "name=value" 文本中取出计数，没有该项时返回 -1
+inline qint64 statValue(const QString& stats, const QString& name)
+{
+    QRegularExpressionMatch match = QRegularExpression(name + "=(\\d+)").match(stats);
+    return match.hasMatch() ? match.captured(1).toLongLong() : -1;
+}
+
+// 模拟进程表：进程的启动、退出和进程ID复用都由测试控制，记录每类查询的次数
+class FakeProcessTable : public ProcessTableSource
+{
+public:
+    void start(DWORD processId, quint64 startTime, const QString& path)
+    {
+        m_processes.insert(processId, Process{ startTime, path });
+    }
+
+    void exit(DWORD processId) { m_processes.remove(processId); }
+
+    bool snapshot(QVector<ProcessInfo>& processes) override
+    {
+        ++snapshots;
+        processes.clear();
+        for (auto it = m_processes.constBegin(); it != m_processes.constEnd(); ++it) {
+            // 与系统快照一样只有文件名，完整路径按需查询
+            ProcessInfo info;
+            info.processId = it.key();
+            info.startTime = it->startTime;
+            info.name = fileName(it->path);
+            processes.append(info);
+        }
+        return true;
+    }
+
+    bool queryProcess(DWORD processId, ProcessInfo& info) override
+    {
+        ++queries;
+        auto it = m_processes.constFind(processId);
+        if (it == m_processes.constEnd()) {
+            return false;
+        }
+        info.processId = processId;
+        info.startTime = it->startTime;
+        info.path = it->path;
+        info.name = fileName(it->path);
+        info.pathResolved = true;
+        return true;
+    }
+
+    QString queryPath(DWORD processId, quint64 startTime) override
+    {
+        ++pathQueries;
+        auto it = m_processes.constFind(processId);
+        return it != m_processes.constEnd() && it->startTime == startTime ? it->path : QString();
+    }
+
+    bool isRunning(DWORD processId, quint64 startTime) override
+    {
+        ++runningChecks;
+        auto it = m_processes.constFind(processId);
+        return it != m_processes.constEnd() && it->startTime == startTime;
+    }
+
+    void release(DWORD processId) override { released.append(processId); }
+
+    int snapshots = 0;
+    int queries = 0;
+    int pathQueries = 0;
+    int runningChecks = 0;
+    QList<DWORD> released;
+
+private:
+    struct Process {
+        quint64 startTime;
+        QString path;
+    };
+
+    static QString fileName(const QString& path) { return path.mid(path.lastIndexOf('\\') + 1); }
+
+    QHash<DWORD, Process> m_processes;
+};
+
+// 模拟窗口消息传输：标记为无响应的窗口每次发送都超时，其余窗口立即返回 result
+class FakeMessenger : public WindowMessenger
+{
+public:
+    void hang(HWND hwnd, DWORD processId)
+    {
+        m_hung.insert(hwnd);
+        m_owners.insert(hwnd, processId);
+    }
+
+    SendResult send(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT timeoutMs, DWORD_PTR* result) override
+    {
+        Q_UNUSED(msg);
+        Q_UNUSED(wParam);
+        Q_UNUSED(lParam);
+        Q_UNUSED(timeoutMs);
+        ++sends;
+        if (m_hung.contains(hwnd)) {
+            return SendResult::Timeout;
+        }
+        if (result) {
+            *result = ResultValue;
+        }
+        return SendResult::Ok;
+    }
+
+    DWORD processIdOf(HWND hwnd) override { return m_owners.value(hwnd); }
+
+    static constexpr DWORD_PTR ResultValue = 42;
+    std::atomic<int> sends{ 0 };
+
+private:
+    QSet<HWND> m_hung;
+    QHash<HWND, DWORD> m_owners;
+};
+
+// 模拟托盘菜单平台：窗口默认都有效，测试用 destroy 模拟窗口销毁；进程名由进程ID生成
+class FakeTrayMenuPlatform : public TrayMenuPlatform
+{
+public:
+    void destroy(HWND hwnd) { m_destroyed.insert(hwnd); }
+
+    bool isWindow(HWND hwnd) override
+    {
+        ++windowChecks;
+        return !m_destroyed.contains(hwnd);
+    }
+
+    QIcon icon(quint64 iconKey) override
+    {
+        Q_UNUSED(iconKey);
+        return QIcon();
+    }
+
+    QString processName(DWORD processId) override { return QString("process%1.exe").arg(processId); }
+
+    int windowChecks = 0;
+
+private:
+    QSet<HWND> m_destroyed;
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <QTest>
+#include "diagnostics.h"
+#include "fakes.h"
+#include "refreshscheduler.h"
+#include "windowsnapshot.h"
+
+// 诊断来源的注册与注销：组件销毁后报告不再调用它的回调
+class TestDiagnostics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unregisteredSourceIsNotReported()
+    {
+        int calls = 0;
+        const quint64 token = Diagnostics::instance().registerSource("Test source", [&calls]() {
+            ++calls;
+            return QString("value=1");
+            });
+        QVERIFY(token != 0);
+        QVERIFY(Diagnostics::instance().report().contains("[Test source]\nvalue=1"));
+        QCOMPARE(calls, 1);
+
+        Diagnostics::instance().unregisterSource(token);
+        QVERIFY(!Diagnostics::instance().report().contains("Test source"));
+        QCOMPARE(calls, 1);
+
+        // 重复注销或未知编号不影响其他来源
+        Diagnostics::instance().unregisterSource(token);
+        Diagnostics::instance().unregisterSource(0);
+    }
+
+    void destroyedComponentsLeaveReport()
+    {
+        for (int i = 0; i < 3; ++i) {
+            RefreshScheduler scheduler;
+            WindowSnapshotProducer producer(std::make_unique<SyntheticBackend>(), nullptr);
+            QVERIFY(Diagnostics::instance().report().contains("[Refresh scheduler]"));
+            QVERIFY(Diagnostics::instance().report().contains("[Window snapshots]"));
+        }
+        const QString report = Diagnostics::instance().report();
+        QVERIFY(!report.contains("[Refresh scheduler]"));
+        QVERIFY(!report.contains("[Window snapshots]"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestDiagnostics)
+#include "tst_diagnostics.moc"
\ No newline at end of file
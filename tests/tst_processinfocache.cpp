@@ -0,0 +1,132 @@
+#include <QTest>
+#include "fakes.h"
+#include "processinfocache.h"
+
+// 进程缓存在模拟进程表上的行为：进程ID复用、进程退出和查询失败的缓存
+class TestProcessInfoCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    // 缓存是单例，每个用例换上新的模拟进程表（同时清空缓存）
+    FakeProcessTable* install()
+    {
+        auto* table = new FakeProcessTable();
+        ProcessInfoCache::instance().setSource(std::unique_ptr<ProcessTableSource>(table));
+        return table;
+    }
+
+    ProcessInfoCache& cache() { return ProcessInfoCache::instance(); }
+
+private slots:
+    void snapshotServesLookups()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+
+        const ProcessInfo info = cache().lookup(10);
+        QCOMPARE(info.processId, DWORD(10));
+        QCOMPARE(info.startTime, quint64(100));
+        QCOMPARE(info.name, QString("alpha.exe"));
+        QCOMPARE(table->queries, 0);
+    }
+
+    void everyHitIsValidated()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+
+        cache().processName(10);
+        cache().processName(10);
+        QCOMPARE(table->runningChecks, 2);
+    }
+
+    void recycledProcessIdIsRequeried()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+        QCOMPARE(cache().processName(10), QString("alpha.exe"));
+
+        // 快照之后进程退出，同一个进程ID被新进程复用
+        const quint64 evictions = cache().stats().evictions;
+        table->exit(10);
+        table->start(10, 200, "C:\\Apps\\beta.exe");
+
+        const ProcessInfo info = cache().lookup(10);
+        QCOMPARE(info.startTime, quint64(200));
+        QCOMPARE(info.name, QString("beta.exe"));
+        QCOMPARE(cache().stats().evictions, evictions + 1);
+        QVERIFY(table->released.contains(10));
+    }
+
+    void exitedProcessIsNotReturned()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+        table->exit(10);
+
+        QCOMPARE(cache().lookup(10).processId, DWORD(0));
+        QVERIFY(cache().processName(10).isEmpty());
+    }
+
+    void failedLookupIsCachedUntilRefresh()
+    {
+        FakeProcessTable* table = install();
+        cache().refresh();
+
+        const quint64 negativeHits = cache().stats().negativeHits;
+        QVERIFY(cache().processName(42).isEmpty());
+        QVERIFY(cache().processName(42).isEmpty());
+        QVERIFY(cache().processPath(42).isEmpty());
+        QCOMPARE(table->queries, 1);
+        QCOMPARE(cache().stats().negativeHits, negativeHits + 2);
+        QCOMPARE(cache().stats().failed, 1);
+
+        // 下一次快照之后重新查询
+        table->start(42, 300, "C:\\Apps\\gamma.exe");
+        cache().refresh();
+        QCOMPARE(cache().processName(42), QString("gamma.exe"));
+        QCOMPARE(cache().stats().failed, 0);
+    }
+
+    void pathIsResolvedOnce()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+
+        QCOMPARE(cache().processPath(10), QString("C:\\Apps\\alpha.exe"));
+        QCOMPARE(cache().processPath(10), QString("C:\\Apps\\alpha.exe"));
+        QCOMPARE(table->pathQueries, 1);
+    }
+
+    void pathOfRecycledProcessIdBelongsToNewProcess()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+
+        table->exit(10);
+        table->start(10, 200, "C:\\Apps\\beta.exe");
+        QCOMPARE(cache().processPath(10), QString("C:\\Apps\\beta.exe"));
+    }
+
+    void refreshKeepsResolvedPathOfSameProcess()
+    {
+        FakeProcessTable* table = install();
+        table->start(10, 100, "C:\\Apps\\alpha.exe");
+        cache().refresh();
+        cache().processPath(10);
+
+        cache().refresh();
+        cache().processPath(10);
+        QCOMPARE(table->pathQueries, 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestProcessInfoCache)
+#include "tst_processinfocache.moc"
\ No newline at end of file
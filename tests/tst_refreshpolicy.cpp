@@ -0,0 +1,112 @@
+#include <QTest>
+#include "refreshscheduler.h"
+
+// 自适应刷新策略在模拟时钟下的行为：时间完全由测试给出，不等待真实时间
+class TestRefreshPolicy : public QObject
+{
+    Q_OBJECT
+
+private:
+    // 按策略给出的间隔推进模拟时钟，返回 duration 毫秒内的刷新次数；
+    // driftEveryMs > 0 时每隔这么久有一次对账发现遗漏的变化
+    static int simulate(RefreshPolicy& policy, qint64& now, qint64 duration, qint64 driftEveryMs = 0)
+    {
+        const qint64 end = now + duration;
+        qint64 nextDrift = driftEveryMs > 0 ? now + driftEveryMs : end + 1;
+        int ticks = 0;
+        while (true) {
+            now += policy.interval();
+            if (now > end) {
+                return ticks;
+            }
+            ++ticks;
+            if (now >= nextDrift) {
+                policy.noteActivity(now);
+                nextDrift += driftEveryMs;
+            }
+            policy.next(now);
+        }
+    }
+
+private slots:
+    void backsOffExponentiallyToMaximum()
+    {
+        RefreshPolicy policy(500, 8000, 5000);
+        QCOMPARE(policy.interval(), 500);
+
+        qint64 now = 0;
+        QList<int> intervals;
+        for (int i = 0; i < 6; ++i) {
+            now += policy.interval();
+            intervals.append(policy.next(now));
+        }
+        QCOMPARE(intervals, (QList<int>{ 1000, 2000, 4000, 8000, 8000, 8000 }));
+    }
+
+    void activityHoldsMinimumUntilSettled()
+    {
+        RefreshPolicy policy(500, 60000, 5000);
+        qint64 now = 100000;
+        for (int i = 0; i < 10; ++i) {
+            now += policy.interval();
+            policy.next(now);
+        }
+        QVERIFY(policy.interval() > 500);
+
+        policy.noteActivity(now);
+        QCOMPARE(policy.interval(), 500);
+        QCOMPARE(policy.next(now + 1000), 500);
+        QCOMPARE(policy.next(now + 4999), 500);
+
+        // 安静超过 settle 之后重新退避
+        QCOMPARE(policy.next(now + 5000), 1000);
+        QCOMPARE(policy.next(now + 6000), 2000);
+    }
+
+    void minimumIntervalChangeClampsCurrent()
+    {
+        RefreshPolicy policy(500, 60000, 5000);
+        policy.setMinInterval(2000);
+        QCOMPARE(policy.interval(), 2000);
+        QCOMPARE(policy.next(10000), 4000);
+    }
+
+    void quietDesktopRefreshesRarely()
+    {
+        // 只有对账发现遗漏才算活动：钩子正常报告的变化不喂给策略，一小时只刷新几十次
+        RefreshPolicy policy;
+        qint64 now = 0;
+        const int ticks = simulate(policy, now, 3600 * 1000);
+        QCOMPARE(policy.interval(), RefreshPolicy::DefaultMaxIntervalMs);
+        QVERIFY(ticks < 3600 / 60 + 10);
+    }
+
+    void driftKeepsIntervalShort()
+    {
+        RefreshPolicy quiet;
+        qint64 quietNow = 0;
+        const int quietTicks = simulate(quiet, quietNow, 600 * 1000);
+
+        // 每 3 秒发现一次遗漏，始终处在 settle 窗口内
+        RefreshPolicy drifting;
+        qint64 driftNow = 0;
+        const int driftTicks = simulate(drifting, driftNow, 600 * 1000, 3000);
+        QCOMPARE(drifting.interval(), RefreshPolicy::DefaultMinIntervalMs);
+        QVERIFY(driftTicks > quietTicks * 10);
+    }
+
+    void driftStopsThenBacksOff()
+    {
+        RefreshPolicy policy;
+        qint64 now = 0;
+        simulate(policy, now, 60 * 1000, 2000);
+        QCOMPARE(policy.interval(), RefreshPolicy::DefaultMinIntervalMs);
+
+        // 遗漏停止后经过 settle 开始退避，几分钟内回到最长间隔
+        simulate(policy, now, 5 * 60 * 1000);
+        QCOMPARE(policy.interval(), RefreshPolicy::DefaultMaxIntervalMs);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRefreshPolicy)
+#include "tst_refreshpolicy.moc"
\ No newline at end of file
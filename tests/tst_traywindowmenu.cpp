@@ -0,0 +1,167 @@
+#include <QMenu>
+#include <QStringList>
+#include <QTest>
+#include "fakes.h"
+#include "traywindowmenu.h"
+
+// 托盘菜单的键控更新：模拟平台提供窗口有效性和进程名，不依赖真实窗口。
+// 需要 QApplication，没有桌面时在 offscreen 平台下运行
+class TestTrayWindowMenu : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Fixture {
+        QMenu menu;
+        QAction* anchor = menu.addSeparator();
+        QAction* quit = menu.addAction("Quit");
+        FakeTrayMenuPlatform* platform = new FakeTrayMenuPlatform();
+        TrayWindowMenu windows{ &menu, anchor, std::unique_ptr<TrayMenuPlatform>(platform) };
+
+        void hide(quintptr id, DWORD processId) { hide(id, processId, QString("window %1").arg(id)); }
+
+        void hide(quintptr id, DWORD processId, const QString& title)
+        {
+            TrayWindowMenu::Item item;
+            item.hwnd = fakeWindow(id);
+            item.title = title;
+            item.processId = processId;
+            windows.insert(item);
+        }
+
+        // 菜单中所有动作的文本，分隔符为空字符串
+        QStringList texts() const
+        {
+            QStringList result;
+            for (QAction* action : menu.actions()) {
+                result.append(action->text());
+            }
+            return result;
+        }
+
+        QAction* actionFor(quintptr id) const
+        {
+            for (QAction* action : menu.actions()) {
+                if (!action->menu() && action->data().toULongLong() == id) {
+                    return action;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+private slots:
+    void topLevelHoldsMostRecentWithinCap()
+    {
+        Fixture f;
+        f.windows.setTopLevelCap(3);
+        for (quintptr id = 1; id <= 5; ++id) {
+            f.hide(id, DWORD(id));
+        }
+        QCOMPARE(f.texts(), (QStringList{ "window 5", "window 4", "window 3",
+            "process1.exe (1)", "process2.exe (1)", "", "Quit" }));
+        QCOMPARE(f.windows.windows(), (QList<HWND>{ fakeWindow(5), fakeWindow(4), fakeWindow(3), fakeWindow(2), fakeWindow(1) }));
+    }
+
+    void rehidingMovesOnlyTheBoundaryWindow()
+    {
+        Fixture f;
+        f.windows.setTopLevelCap(2);
+        f.hide(1, 7);
+        f.hide(2, 7);
+        f.hide(3, 7);
+        QAction* third = f.actionFor(3);
+        QCOMPARE(f.texts(), (QStringList{ "window 3", "window 2", "process7.exe (1)", "", "Quit" }));
+
+        // 分组中的窗口重新隐藏：移到顶层，原来最旧的顶层窗口进入分组，其余动作保持不变
+        f.hide(1, 7);
+        QCOMPARE(f.texts(), (QStringList{ "window 1", "window 3", "process7.exe (1)", "", "Quit" }));
+        QCOMPARE(f.actionFor(3), third);
+        QVERIFY(!f.actionFor(2));
+    }
+
+    void removingTopLevelPromotesNewestGrouped()
+    {
+        Fixture f;
+        f.windows.setTopLevelCap(2);
+        f.hide(1, 5);
+        f.hide(2, 6);
+        f.hide(3, 5);
+        QVERIFY(f.windows.remove(fakeWindow(3)));
+        QCOMPARE(f.texts(), (QStringList{ "window 2", "window 1", "", "Quit" }));
+        QVERIFY(!f.windows.remove(fakeWindow(3)));
+        QCOMPARE(f.windows.count(), 2);
+    }
+
+    void capChangeRebalances()
+    {
+        Fixture f;
+        for (quintptr id = 1; id <= 4; ++id) {
+            f.hide(id, 9);
+        }
+        f.windows.setTopLevelCap(1);
+        QCOMPARE(f.texts(), (QStringList{ "window 4", "process9.exe (3)", "", "Quit" }));
+        f.windows.setTopLevelCap(10);
+        QCOMPARE(f.texts(), (QStringList{ "window 4", "window 3", "window 2", "window 1", "", "Quit" }));
+    }
+
+    void setTitleUpdatesActionInPlace()
+    {
+        Fixture f;
+        f.hide(1, 1);
+        f.hide(2, 1, QString());
+        QAction* first = f.actionFor(1);
+        f.windows.setTitle(fakeWindow(1), "renamed");
+        QCOMPARE(f.actionFor(1), first);
+        QCOMPARE(first->text(), QString("renamed"));
+
+        QCOMPARE(f.actionFor(2)->text(), QString("Unknown Window"));
+        f.windows.setUnknownTitle("Untitled");
+        QCOMPARE(f.actionFor(2)->text(), QString("Untitled"));
+    }
+
+    void sweepPrunesDestroyedWindows()
+    {
+        Fixture f;
+        f.hide(1, 1);
+        f.hide(2, 1);
+        QList<HWND> pruned;
+        connect(&f.windows, &TrayWindowMenu::windowsPruned, this, [&pruned](const QList<HWND>& windows) {
+            pruned += windows;
+            });
+
+        f.platform->destroy(fakeWindow(1));
+        QVERIFY(QMetaObject::invokeMethod(&f.windows, "sweep"));
+        QCOMPARE(pruned, (QList<HWND>{ fakeWindow(1) }));
+        QVERIFY(!f.windows.contains(fakeWindow(1)));
+        QCOMPARE(f.texts(), (QStringList{ "window 2", "", "Quit" }));
+    }
+
+    void triggerRestoresOnlyLiveWindows()
+    {
+        Fixture f;
+        f.hide(1, 1);
+        f.hide(2, 1);
+        QList<HWND> restored;
+        int pruned = 0;
+        connect(&f.windows, &TrayWindowMenu::restoreRequested, this, [&restored](HWND hwnd) {
+            restored.append(hwnd);
+            });
+        connect(&f.windows, &TrayWindowMenu::windowsPruned, this, [&pruned](const QList<HWND>& windows) {
+            pruned += windows.size();
+            });
+
+        f.actionFor(2)->trigger();
+        QCOMPARE(restored, (QList<HWND>{ fakeWindow(2) }));
+
+        // 两次定时检查之间被销毁的窗口：触发时清理而不是恢复
+        f.platform->destroy(fakeWindow(1));
+        f.actionFor(1)->trigger();
+        QCOMPARE(restored.size(), 1);
+        QCOMPARE(pruned, 1);
+        QVERIFY(!f.windows.contains(fakeWindow(1)));
+    }
+};
+
+QTEST_MAIN(TestTrayWindowMenu)
+#include "tst_traywindowmenu.moc"
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <QTest>
+#include <QThread>
+#include <atomic>
+#include "fakes.h"
+#include "windowquery.h"
+
+namespace {
+
+constexpr UINT TestMessage = 0x7F;
+
+// 发送时阻塞一段时间后超时的消息传输，用来检查查询进行中替换实现是否安全
+class BlockingMessenger : public WindowMessenger
+{
+public:
+    struct State {
+        std::atomic<bool> alive{ true };
+        std::atomic<bool> entered{ false };
+        std::atomic<bool> usedAfterFree{ false };
+    };
+
+    explicit BlockingMessenger(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+    ~BlockingMessenger() override { m_state->alive = false; }
+
+    SendResult send(HWND, UINT, WPARAM, LPARAM, UINT, DWORD_PTR*) override
+    {
+        m_state->entered = true;
+        QThread::msleep(100);
+        check();
+        return SendResult::Timeout;
+    }
+
+    DWORD processIdOf(HWND) override
+    {
+        check();
+        return 0;
+    }
+
+private:
+    void check()
+    {
+        if (!m_state->alive) {
+            m_state->usedAfterFree = true;
+        }
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace
+
+// 有界延迟的窗口查询：模拟无响应的窗口，检查冷却、跳过和按进程统计
+class TestWindowQuery : public QObject
+{
+    Q_OBJECT
+
+private:
+    // 查询是单例，每个用例换上新的模拟实现（同时清空冷却记录）
+    FakeMessenger* install()
+    {
+        auto* messenger = new FakeMessenger();
+        WindowQuery::instance().setMessenger(std::unique_ptr<WindowMessenger>(messenger));
+        WindowQuery::instance().setHangCooldown(WindowQuery::DefaultHangCooldownMs);
+        return messenger;
+    }
+
+    WindowQuery& query() { return WindowQuery::instance(); }
+
+private slots:
+    void responsiveWindowReturnsResult()
+    {
+        FakeMessenger* messenger = install();
+
+        DWORD_PTR result = 0;
+        QVERIFY(query().sendMessage(fakeWindow(1), TestMessage, 0, 0, &result));
+        QCOMPARE(result, FakeMessenger::ResultValue);
+        QCOMPARE(messenger->sends.load(), 1);
+        QVERIFY(!query().isRecentlyHung(fakeWindow(1)));
+    }
+
+    void hungWindowIsSkippedDuringCooldown()
+    {
+        FakeMessenger* messenger = install();
+        messenger->hang(fakeWindow(1), 0);
+        const WindowQuery::Stats before = query().stats();
+
+        DWORD_PTR result = 123;
+        QVERIFY(!query().sendMessage(fakeWindow(1), TestMessage, 0, 0, &result));
+        QCOMPARE(result, DWORD_PTR(0));
+        QVERIFY(query().isRecentlyHung(fakeWindow(1)));
+
+        // 冷却期内不再发送
+        QVERIFY(!query().sendMessage(fakeWindow(1), TestMessage, 0, 0, nullptr));
+        QCOMPARE(messenger->sends.load(), 1);
+
+        const WindowQuery::Stats after = query().stats();
+        QCOMPARE(after.timeouts, before.timeouts + 1);
+        QCOMPARE(after.skipped, before.skipped + 1);
+        QCOMPARE(after.hungWindows, 1);
+
+        // 其他窗口不受影响
+        QVERIFY(query().sendMessage(fakeWindow(2), TestMessage, 0, 0, nullptr));
+    }
+
+    void cooldownExpires()
+    {
+        FakeMessenger* messenger = install();
+        query().setHangCooldown(30);
+        messenger->hang(fakeWindow(1), 0);
+
+        QVERIFY(!query().sendMessage(fakeWindow(1), TestMessage, 0, 0, nullptr));
+        QTest::qWait(60);
+        QVERIFY(!query().isRecentlyHung(fakeWindow(1)));
+
+        // 冷却结束后重新尝试
+        QVERIFY(!query().sendMessage(fakeWindow(1), TestMessage, 0, 0, nullptr));
+        QCOMPARE(messenger->sends.load(), 2);
+    }
+
+    void hangsAreCountedPerProcess()
+    {
+        auto* processes = new FakeProcessTable();
+        processes->start(500, 1, "C:\\Apps\\frozen.exe");
+        ProcessInfoCache::instance().setSource(std::unique_ptr<ProcessTableSource>(processes));
+        ProcessInfoCache::instance().refresh();
+
+        FakeMessenger* messenger = install();
+        query().setHangCooldown(0);
+        messenger->hang(fakeWindow(1), 500);
+        messenger->hang(fakeWindow(2), 500);
+
+        query().sendMessage(fakeWindow(1), TestMessage, 0, 0, nullptr);
+        query().sendMessage(fakeWindow(2), TestMessage, 0, 0, nullptr);
+        QVERIFY(query().statsString().contains("frozen.exe(2)"));
+    }
+
+    void replacingMessengerDuringQueryIsSafe()
+    {
+        auto state = std::make_shared<BlockingMessenger::State>();
+        query().setMessenger(std::make_unique<BlockingMessenger>(state));
+
+        QThread* sender = QThread::create([this]() {
+            query().sendMessage(fakeWindow(1), TestMessage, 0, 0, nullptr);
+            });
+        sender->start();
+        QTRY_VERIFY(state->entered.load());
+
+        // 查询进行中替换实现：旧实现要等查询（包括超时后的 markHung）结束才释放
+        install();
+        QVERIFY(sender->wait(5000));
+        delete sender;
+
+        QVERIFY(!state->usedAfterFree.load());
+        QVERIFY(!state->alive.load());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestWindowQuery)
+#include "tst_windowquery.moc"
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include <QSignalSpy>
+#include <QTest>
+#include "fakes.h"
+#include "windowregistry.h"
+
+// 用脚本化事件源和合成后端驱动注册表，不依赖真实窗口
+class TestWindowRegistry : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Fixture {
+        SyntheticBackend* backend = new SyntheticBackend();
+        ScriptedEventSource* source = new ScriptedEventSource();
+        WindowRegistry registry{ std::unique_ptr<WindowBackend>(backend), source };
+
+        Fixture() { source->setParent(&registry); }
+    };
+
+private slots:
+    void startReconcilesEverything()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.backend->add(2, "two");
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        QVERIFY(f.registry.start());
+        QVERIFY(f.source->isRunning());
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(f.registry.order(), (QList<HWND>{ fakeWindow(2), fakeWindow(1) }));
+        QCOMPARE(f.registry.find(fakeWindow(1))->title, QString("one"));
+        QCOMPARE(f.registry.revision(), quint64(1));
+    }
+
+    void createdEventAddsWindow()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.registry.setCoalesceInterval(0);
+        f.registry.start();
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        f.backend->add(2, "two");
+        f.source->feed(fakeWindow(2), WindowEventType::Created);
+        QVERIFY(changed.wait(1000));
+        QCOMPARE(f.registry.order().first(), fakeWindow(2));
+        QCOMPARE(f.backend->reconciles, 1);
+    }
+
+    void burstOfEventsIsCoalesced()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.registry.setCoalesceInterval(20);
+        f.registry.start();
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        const int queriesBefore = f.backend->queries.value(fakeWindow(1));
+        for (int i = 0; i < 5; ++i) {
+            f.backend->setTitle(1, QString("title %1").arg(i));
+            f.source->feed(fakeWindow(1), WindowEventType::NameChanged);
+        }
+        QVERIFY(changed.wait(1000));
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(f.backend->queries.value(fakeWindow(1)) - queriesBefore, 1);
+        QCOMPARE(f.registry.find(fakeWindow(1))->title, QString("title 4"));
+    }
+
+    void unchangedWindowDoesNotNotify()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.registry.setCoalesceInterval(0);
+        f.registry.start();
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        f.source->feed(fakeWindow(1), WindowEventType::Foreground);
+        QTest::qWait(50);
+        QCOMPARE(changed.count(), 0);
+    }
+
+    void destroyedEventRemovesKnownWindowOnly()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.backend->add(2, "two");
+        f.registry.setCoalesceInterval(0);
+        f.registry.start();
+
+        // 未知窗口的销毁事件直接丢弃，不查询后端
+        f.source->feed(fakeWindow(99), WindowEventType::Destroyed);
+        QTest::qWait(20);
+        QCOMPARE(f.backend->queries.value(fakeWindow(99)), 0);
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        f.backend->remove(1);
+        f.source->feed(fakeWindow(1), WindowEventType::Destroyed);
+        QVERIFY(changed.wait(1000));
+        QVERIFY(!f.registry.find(fakeWindow(1)));
+        QCOMPARE(f.registry.order(), QList<HWND>{ fakeWindow(2) });
+    }
+
+    void eventsAfterStopAreIgnored()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.registry.setCoalesceInterval(0);
+        f.registry.start();
+        f.registry.stop();
+        QVERIFY(!f.source->isRunning());
+
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        f.backend->add(2, "two");
+        f.source->feed(fakeWindow(2), WindowEventType::Created);
+        QTest::qWait(20);
+        QCOMPARE(changed.count(), 0);
+        QVERIFY(!f.registry.find(fakeWindow(2)));
+    }
+
+    void reconcileReplacesPendingEvents()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.registry.setCoalesceInterval(1000);
+        f.registry.start();
+
+        f.backend->setTitle(1, "renamed");
+        f.source->feed(fakeWindow(1), WindowEventType::NameChanged);
+        f.registry.reconcile();
+        QCOMPARE(f.registry.find(fakeWindow(1))->title, QString("renamed"));
+
+        // 对账已包含待处理的事件，合并定时器不会再触发一次更新
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+        QTest::qWait(50);
+        QCOMPARE(changed.count(), 0);
+    }
+
+    // 只有事件没有报告的变化才算遗漏，调度器据此决定是否保持短间隔
+    void reconcileReportsUnreportedChangesAsDrift()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.backend->add(2, "two");
+        f.registry.start();
+
+        QSignalSpy drift(&f.registry, &WindowRegistry::driftDetected);
+        f.registry.reconcile();
+        QCOMPARE(drift.count(), 0);
+
+        // 没有收到任何事件的新增、改名和消失
+        f.backend->add(3, "three");
+        f.backend->setTitle(1, "renamed");
+        f.backend->remove(2);
+        f.registry.reconcile();
+        QCOMPARE(drift.count(), 1);
+        QCOMPARE(drift.takeFirst().at(0).toInt(), 3);
+    }
+
+    void reportedChangesAreNotDrift()
+    {
+        Fixture f;
+        f.backend->add(1, "one");
+        f.backend->add(2, "two");
+        f.registry.setCoalesceInterval(1000);
+        f.registry.start();
+
+        QSignalSpy drift(&f.registry, &WindowRegistry::driftDetected);
+        QSignalSpy changed(&f.registry, &WindowRegistry::windowsChanged);
+
+        // 事件已经到达但还在合并等待中，对账抢先处理了它们
+        f.backend->add(3, "three");
+        f.source->feed(fakeWindow(3), WindowEventType::Created);
+        f.backend->setTitle(1, "renamed");
+        f.source->feed(fakeWindow(1), WindowEventType::NameChanged);
+        f.backend->remove(2);
+        f.source->feed(fakeWindow(2), WindowEventType::Destroyed);
+        f.registry.reconcile();
+
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(drift.count(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestWindowRegistry)
+#include "tst_windowregistry.moc"
\ No newline at end of file
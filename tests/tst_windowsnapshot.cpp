@@ -0,0 +1,100 @@
+#include <QTest>
+#include <QThread>
+#include <atomic>
+#include "fakes.h"
+#include "windowsnapshot.h"
+
+// 快照生产者：合成后端在后台线程中构建快照，多个读者线程同时读取最新快照
+class TestWindowSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void publishesSnapshotOfBackend()
+    {
+        auto* backend = new SyntheticBackend();
+        backend->add(1, "one", 5);
+        backend->add(2, "two", 6);
+        backend->add(3, "three", 5);
+
+        WindowSnapshotProducer producer(std::unique_ptr<WindowBackend>(backend), nullptr);
+        int published = 0;
+        connect(&producer, &WindowSnapshotProducer::snapshotPublished, this, [&published](quint64) {
+            ++published;
+            });
+        QVERIFY(!producer.latest());
+
+        producer.start();
+        QTRY_COMPARE(published, 1);
+
+        WindowSnapshotPtr snapshot = producer.latest();
+        QVERIFY(snapshot);
+        QCOMPARE(snapshot->size(), 3);
+        QCOMPARE(snapshot->hwnds[0], fakeWindow(3));
+        QCOMPARE(snapshot->title(0), QString("three"));
+        QCOMPARE(snapshot->title(2), QString("one"));
+        QCOMPARE(snapshot->processName(1), QString("process6.exe"));
+        QCOMPARE(snapshot->className(0), QString("SyntheticWindow"));
+        QCOMPARE(snapshot->processNameIds[0], snapshot->processNameIds[2]);
+    }
+
+    void readersSeeCompleteSnapshotsWhilePublishing()
+    {
+        constexpr int Windows = 200;
+        constexpr int Publishes = 100;
+
+        WindowSnapshotProducer producer(std::make_unique<ChurningBackend>(Windows), nullptr);
+        int published = 0;
+        connect(&producer, &WindowSnapshotProducer::snapshotPublished, this, [&published](quint64) {
+            ++published;
+            });
+        producer.start();
+        QTRY_COMPARE(published, 1);
+
+        std::atomic<bool> stop{ false };
+        std::atomic<int> failures{ 0 };
+        std::atomic<int> reads{ 0 };
+        QList<QThread*> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.append(QThread::create([&]() {
+                quint64 lastRevision = 0;
+                while (!stop.load()) {
+                    WindowSnapshotPtr snapshot = producer.latest();
+                    if (!snapshot || snapshot->size() != Windows
+                        || snapshot->titleOffsets.size() != Windows + 1
+                        || snapshot->revision < lastRevision
+                        || !snapshot->title(Windows - 1).startsWith("window 1")) {
+                        ++failures;
+                    }
+                    if (snapshot) {
+                        lastRevision = snapshot->revision;
+                    }
+                    ++reads;
+                }
+                }));
+            readers.last()->start();
+        }
+
+        for (int i = 0; i < Publishes; ++i) {
+            producer.requestReconcile();
+        }
+        QTRY_VERIFY_WITH_TIMEOUT(published >= Publishes + 1, 10000);
+
+        stop = true;
+        for (QThread* reader : readers) {
+            QVERIFY(reader->wait(5000));
+            delete reader;
+        }
+        QVERIFY(reads.load() > 0);
+        QCOMPARE(failures.load(), 0);
+
+        // 读者释放快照后缓冲区回到回收队列，分配次数不随发布次数增长
+        const QString stats = producer.statsString();
+        QCOMPARE(statValue(stats, "built"), qint64(Publishes + 1));
+        QVERIFY(statValue(stats, "reused") > 0);
+        QVERIFY(statValue(stats, "buffers") < Publishes / 2);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestWindowSnapshot)
+#include "tst_windowsnapshot.moc"
\ No newline at end of file
@@ -0,0 +1,201 @@
+// langc：把 language/*.lang 编译成二进制语言目录（.langc）
+// 用法：langc <input.lang> <output.langc>
+// 解析规则与 Translator 的文本加载一致：去掉首尾空白，跳过空行和 #、; 开头的注释，
+// [节] 为上下文，键=值，值两侧的引号可选，重复的键以最后一次为准。
+
+#include "languagecatalog.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& text)
+{
+    const char* whitespace = " \t\r\n\v\f";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+// UTF-8 转 UTF-16，非法序列替换为 U+FFFD
+std::u16string toUtf16(const std::string& text)
+{
+    std::u16string result;
+    result.reserve(text.size());
+
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        uint32_t codePoint = 0xFFFD;
+        size_t length = 1;
+
+        if (c < 0x80) {
+            codePoint = c;
+        }
+        else if ((c & 0xE0) == 0xC0) {
+            length = 2;
+        }
+        else if ((c & 0xF0) == 0xE0) {
+            length = 3;
+        }
+        else if ((c & 0xF8) == 0xF0) {
+            length = 4;
+        }
+
+        if (length > 1) {
+            if (i + length > text.size()) {
+                length = 1;
+            }
+            else {
+                codePoint = c & (0x7F >> length);
+                for (size_t k = 1; k < length; ++k) {
+                    unsigned char next = static_cast<unsigned char>(text[i + k]);
+                    if ((next & 0xC0) != 0x80) {
+                        codePoint = 0xFFFD;
+                        length = k;
+                        break;
+                    }
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+            }
+        }
+
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            result.push_back(static_cast<char16_t>(0xD800 + (codePoint >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)));
+        }
+        else {
+            result.push_back(static_cast<char16_t>(codePoint));
+        }
+        i += length;
+    }
+    return result;
+}
+
+struct Entry {
+    std::string name;         // "节|键"，用于检查哈希冲突
+    std::u16string value;
+};
+
+bool parse(const std::string& path, std::map<uint64_t, Entry>& entries)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "langc: cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string content = buffer.str();
+    if (content.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        content.erase(0, 3);
+    }
+
+    std::istringstream lines(content);
+    std::string section;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+
+        if (line.front() == '[' && line.back() == ']') {
+            section = line.substr(1, line.size() - 2);
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+
+        uint64_t hash = LanguageCatalog::hashKey(section.c_str(), key.c_str());
+        std::string name = section + '|' + key;
+        auto it = entries.find(hash);
+        if (it != entries.end() && it->second.name != name) {
+            std::fprintf(stderr, "%s:%d: hash collision between \"%s\" and \"%s\"\n",
+                path.c_str(), lineNumber, name.c_str(), it->second.name.c_str());
+            return false;
+        }
+        entries[hash] = Entry{ name, toUtf16(value) };
+    }
+    return true;
+}
+
+bool write(const std::string& path, const std::map<uint64_t, Entry>& entries)
+{
+    // 槽位数为 2 的幂且不少于条目数的两倍，与运行时的负载因子一致
+    uint32_t slotCount = 16;
+    while (slotCount < entries.size() * 2) {
+        slotCount *= 2;
+    }
+
+    std::vector<LanguageCatalog::Slot> slots(slotCount, LanguageCatalog::Slot{ 0, 0, 0 });
+    std::u16string strings;
+    const uint32_t mask = slotCount - 1;
+    for (const auto& entry : entries) {
+        uint32_t i = static_cast<uint32_t>(entry.first) & mask;
+        while (slots[i].key != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i].key = entry.first;
+        slots[i].offset = static_cast<uint32_t>(strings.size());
+        slots[i].length = static_cast<uint32_t>(entry.second.value.size());
+        strings += entry.second.value;
+    }
+
+    LanguageCatalog::Header header = {};
+    header.magic = LanguageCatalog::Magic;
+    header.version = LanguageCatalog::Version;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.slotCount = slotCount;
+    header.stringsOffset = static_cast<uint32_t>(sizeof(header) + slots.size() * sizeof(LanguageCatalog::Slot));
+    header.stringsSize = static_cast<uint32_t>(strings.size() * sizeof(char16_t));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "langc: cannot write %s\n", path.c_str());
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(LanguageCatalog::Slot));
+    out.write(reinterpret_cast<const char*>(strings.data()), header.stringsSize);
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: langc <input.lang> <output%s>\n", LanguageCatalog::FileSuffix);
+        return 2;
+    }
+
+    std::map<uint64_t, Entry> entries;
+    if (!parse(argv[1], entries) || !write(argv[2], entries)) {
+        std::remove(argv[2]);
+        return 1;
+    }
+
+    std::printf("langc: %s -> %s (%zu entries)\n", argv[1], argv[2], entries.size());
+    return 0;
+}
\ No newline at end of file